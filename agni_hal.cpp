@@ -1,4 +1,5 @@
 #include "agni_hal.h"
+#include "common.h"
 #include <stdio.h>
 
 // Global NOC interrupt handler
@@ -16,12 +17,89 @@ void agni_hal_invoke_noc_irq(void) {
     }
 }
 
+// ============================================================================
+// NOC DESCRIPTOR RING
+// ============================================================================
+static bool g_ring_ready = false;
+static uint64_t g_ring_tail = 0;    // Descriptors published
+static uint64_t g_ring_done = 0;    // Last NOC_DONE_SEQ read
+
+void agni_hal_noc_ring_init(void) {
+    agni_hal_reg_write64(NOC_RING_BASE_REG, NOC_RING_ADDR);
+    agni_hal_reg_write64(NOC_RING_SIZE_REG, NOC_RING_ENTRIES);     // Restarts the ring at 0
+    g_ring_tail = 0;
+    g_ring_done = 0;
+    g_ring_ready = true;
+}
+
+uint64_t agni_hal_noc_completed_seq(void) {
+    g_ring_done = agni_hal_reg_read64(NOC_DONE_SEQ);
+    return g_ring_done;
+}
+
+uint32_t agni_hal_noc_ring_space(uint32_t needed) {
+    if (!g_ring_ready) agni_hal_noc_ring_init();
+    uint32_t space = NOC_RING_ENTRIES - (uint32_t)(g_ring_tail - g_ring_done);
+    if (space < needed) {
+        space = NOC_RING_ENTRIES - (uint32_t)(g_ring_tail - agni_hal_noc_completed_seq());
+    }
+    return space;
+}
+
+uint64_t agni_hal_noc_submit(const NocCopyDescriptor* chain, uint32_t count) {
+    if (!chain || count == 0 || count > NOC_RING_ENTRIES) return 0;
+    if (agni_hal_noc_ring_space(count) < count) return 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t slot = NOC_RING_ADDR + ((g_ring_tail + i) % NOC_RING_ENTRIES) * sizeof(NocCopyDescriptor);
+        volatile NocCopyDescriptor* desc =
+            (volatile NocCopyDescriptor*)agni_hal_ptr(slot, sizeof(NocCopyDescriptor));
+        if (!desc) return 0;
+        desc->source_addr = chain[i].source_addr;
+        desc->dest_addr = chain[i].dest_addr;
+        desc->size_bytes = chain[i].size_bytes;
+        desc->flags = (chain[i].flags & ~NOC_DESC_CHAIN) | (i + 1 < count ? NOC_DESC_CHAIN : 0u);
+    }
+
+    // Descriptors must be visible before the doorbell
+    agni_hal_flush_cache_line(NOC_RING_ADDR);
+    g_ring_tail += count;
+    agni_hal_reg_write64(NOC_RING_TAIL, g_ring_tail);
+    return g_ring_tail;
+}
+
+bool agni_hal_noc_seq_done(uint64_t seq) {
+    return g_ring_done >= seq || agni_hal_noc_completed_seq() >= seq;
+}
+
+int agni_hal_noc_wait_seq(uint64_t seq, uint32_t timeout_ms) {
+#ifdef AGNI_HAL_SIM
+    if (!agni_hal_noc_seq_done(seq)) agni_sim_noc_wait_seq(seq, timeout_ms);
+#else
+    uint32_t elapsed = 0;
+    while (!agni_hal_noc_seq_done(seq) && elapsed < timeout_ms) {
+        elapsed++;
+        // Sleep 1ms
+        for (volatile int i = 0; i < 1000000; i++);
+    }
+#endif
+    return agni_hal_noc_seq_done(seq) ? 0 : -1;
+}
+
 // Initialize AGNI hardware
 void agni_hal_init(void) {
     // Initialize Foreman CPU
     // Initialize Wrench systolic array
     // Initialize Key RVV engines
     // Enable NOC
+#ifdef AGNI_HAL_SIM
+    if (agni_sim_init() != AGNI_OK) {
+        printf("[HAL] Simulator initialization failed\n");
+        return;
+    }
+    printf("[HAL] Host build: using the simulator backend\n");
+#endif
+    agni_hal_noc_ring_init();
     agni_hal_noc_irq_enable();
     printf("[HAL] AGNI hardware initialized\n");
 }
@@ -29,5 +107,10 @@ void agni_hal_init(void) {
 // Shutdown AGNI hardware
 void agni_hal_shutdown(void) {
     agni_hal_noc_irq_disable();
+#ifdef AGNI_HAL_SIM
+    agni_sim_drain();
+    agni_sim_print_report();
+    agni_sim_shutdown();
+#endif
     printf("[HAL] AGNI hardware shutdown\n");
-}
\ No newline at end of file
+}
@@ -6,6 +6,18 @@
 #include <stdbool.h>
 #include <string.h>
 
+////////////////////////////////////////////////////////////////////////////////
+// BACKEND SELECTION
+// RISC-V builds (or AGNI_HAL_DEVICE) drive the real MMIO map. Every other
+// build runs against the host simulator in agni_hal_sim.cpp, which backs
+// the memory regions with host memory and models the engines' timing.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(AGNI_HAL_DEVICE) && !defined(__riscv)
+#define AGNI_HAL_SIM 1
+#include "agni_hal_sim.h"
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // SECTION 1: MEMORY MAP (TRM v3.0, Sec 6.0) - HARD-LOCKED
 ////////////////////////////////////////////////////////////////////////////////
@@ -28,15 +40,30 @@
 #define NOC_SEND_CMD           (NOC_BASE + 0x0000UL)  // (W) NocCopyDescriptor*
 #define NOC_STATUS             (NOC_BASE + 0x0008UL)  // (R) 0x1=BUSY, 0x0=DONE
 #define NOC_IRQ_ENABLE         (NOC_BASE + 0x000CUL)  // (W/R) IRQ enable
-#define NOC_IRQ_STATUS         (NOC_BASE + 0x0010UL)  // (R) IRQ pending
+#define NOC_IRQ_STATUS         (NOC_BASE + 0x0010UL)  // (R) IRQ pending, cleared by the read
+
+// Descriptor ring: the NOC consumes descriptors from ring_base up to the
+// tail the Foreman publishes, and counts completed descriptors in
+// NOC_DONE_SEQ. A chain (scatter/gather) completes, raises its IRQ and
+// advances NOC_DONE_SEQ as one unit, at its last descriptor.
+#define NOC_RING_BASE_REG      (NOC_BASE + 0x0018UL)  // (W/R) Ring address in FOREMAN_RAM
+#define NOC_RING_SIZE_REG      (NOC_BASE + 0x0020UL)  // (W/R) Entries, a power of two
+#define NOC_RING_TAIL          (NOC_BASE + 0x0028UL)  // (W) Descriptors published (doorbell)
+#define NOC_DONE_SEQ           (NOC_BASE + 0x0030UL)  // (R) Descriptors completed
+
+#define NOC_DESC_CHAIN         0x1u   // flags: the next descriptor belongs to the same chain
 
 typedef struct {
     uint64_t source_addr;
     uint64_t dest_addr;
     uint32_t size_bytes;
-    uint32_t _reserved;
+    uint32_t flags;
 } NocCopyDescriptor;
 
+// The ring occupies the top of FOREMAN_RAM
+#define NOC_RING_ENTRIES       64
+#define NOC_RING_ADDR          (FOREMAN_RAM_BASE + FOREMAN_RAM_SIZE - NOC_RING_ENTRIES * sizeof(NocCopyDescriptor))
+
 ////////////////////////////////////////////////////////////////////////////////
 // SECTION 3: WRENCH (Gemmini) RoCC OPCODES - TRM v3.0 Sec 3.0
 // funct7 values for custom RISC-V RoCC instructions
@@ -84,39 +111,152 @@ typedef struct {
 #define FOREMAN_FREQ_HZ         1200000000UL  // 1.2 GHz (AGNI unique marker)
 #define FOREMAN_CPU_ID          0x00000042UL  // "CVA6S+" CPU signature
 
+// Sleep until an interrupt is pending. Call with interrupts masked
+// (agni_hal_irq_save) from the caller's last check on: an IRQ landing in
+// between then stays pending, WFI returns at once, and the handler runs on
+// agni_hal_irq_restore. Unmasked, the handler could run in that window and
+// the core sleep past the event. Returns false when no interrupt can come
+// (simulator only: the IRQ is disabled or nothing is in flight).
+static inline bool agni_hal_wait_for_interrupt(void) {
+#ifdef AGNI_HAL_SIM
+    return agni_sim_wfi();
+#else
+    asm volatile("wfi");
+    return true;
+#endif
+}
+
+// Mask the Foreman's interrupts around state an IRQ handler also touches,
+// and restore the previous state. An IRQ raised while masked stays
+// pending and is taken on restore. Both are compiler barriers.
+typedef uint64_t AgniIrqFlags;
+
+#define MSTATUS_MIE             0x8UL         // Machine interrupt enable
+
+static inline AgniIrqFlags agni_hal_irq_save(void) {
+#ifdef AGNI_HAL_SIM
+    AgniIrqFlags flags = agni_sim_irq_save() ? MSTATUS_MIE : 0;
+    asm volatile("" ::: "memory");
+    return flags;
+#else
+    AgniIrqFlags flags;
+    asm volatile("csrrci %0, mstatus, %1" : "=r"(flags) : "i"(MSTATUS_MIE) : "memory");
+    return flags & MSTATUS_MIE;
+#endif
+}
+
+static inline void agni_hal_irq_restore(AgniIrqFlags flags) {
+#ifdef AGNI_HAL_SIM
+    asm volatile("" ::: "memory");
+    agni_sim_irq_restore(flags != 0);
+#else
+    asm volatile("csrs mstatus, %0" : : "r"(flags) : "memory");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SECTION 6: REGISTER AND MEMORY ACCESS
+// Every MMIO access and every Foreman view of device memory goes through
+// these, so the simulator can stand in for the hardware.
+////////////////////////////////////////////////////////////////////////////////
+
+static inline void* agni_hal_ptr(uint64_t addr, uint64_t bytes) {
+#ifdef AGNI_HAL_SIM
+    return agni_sim_host_ptr(addr, bytes);
+#else
+    (void)bytes;
+    return (void*)(uintptr_t)addr;
+#endif
+}
+
+static inline uint32_t agni_hal_reg_read32(uint64_t addr) {
+#ifdef AGNI_HAL_SIM
+    return (uint32_t)agni_sim_reg_read(addr);
+#else
+    return *(volatile uint32_t*)(uintptr_t)addr;
+#endif
+}
+
+static inline void agni_hal_reg_write32(uint64_t addr, uint32_t value) {
+#ifdef AGNI_HAL_SIM
+    agni_sim_reg_write(addr, value);
+#else
+    *(volatile uint32_t*)(uintptr_t)addr = value;
+#endif
+}
+
+static inline uint64_t agni_hal_reg_read64(uint64_t addr) {
+#ifdef AGNI_HAL_SIM
+    return agni_sim_reg_read(addr);
+#else
+    return *(volatile uint64_t*)(uintptr_t)addr;
+#endif
+}
+
+static inline void agni_hal_reg_write64(uint64_t addr, uint64_t value) {
+#ifdef AGNI_HAL_SIM
+    agni_sim_reg_write(addr, value);
+#else
+    *(volatile uint64_t*)(uintptr_t)addr = value;
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
-// SECTION 6: NOC DMA OPERATIONS (Async, Non-Blocking)
+// SECTION 7: NOC DMA OPERATIONS (Async, Non-Blocking)
 // V6 (Dual-Issue) Software DMA Fix - TRM v3.0 Sec 5.0
 ////////////////////////////////////////////////////////////////////////////////
 
-// Async NOC copy (fire-and-forget) - Thread 1 of dual-issue pair
-static inline void agni_hal_noc_copy_async(
+// Descriptor ring driver (agni_hal.cpp). Sequence numbers count
+// descriptors: a chain's number is the ring position after its last
+// descriptor, so chain n is done once NOC_DONE_SEQ >= n. Single
+// Foreman thread only.
+void agni_hal_noc_ring_init(void);
+
+// Publishes count descriptors as one chain (the CHAIN flags are set here)
+// and returns its sequence number, or 0 when the ring has fewer than
+// count free entries
+uint64_t agni_hal_noc_submit(const NocCopyDescriptor* chain, uint32_t count);
+
+// Free ring entries; reads NOC_DONE_SEQ only when the cached count is short
+uint32_t agni_hal_noc_ring_space(uint32_t needed);
+uint64_t agni_hal_noc_completed_seq(void);
+bool agni_hal_noc_seq_done(uint64_t seq);
+int agni_hal_noc_wait_seq(uint64_t seq, uint32_t timeout_ms);
+
+// Async NOC copy (fire-and-forget) - Thread 1 of dual-issue pair.
+// A chain of one on the ring, so copies no longer overwrite each other's
+// descriptor; waits for a free entry if the ring is full. Returns the
+// sequence number.
+static inline uint64_t agni_hal_noc_copy_async(
     uint64_t src_addr,
     uint64_t dst_addr,
     uint32_t size_bytes
 ) {
-    volatile NocCopyDescriptor* desc =
-        (volatile NocCopyDescriptor*)(FOREMAN_RAM_BASE);
-
-    desc->source_addr = src_addr;
-    desc->dest_addr = dst_addr;
-    desc->size_bytes = size_bytes;
-    desc->_reserved = 0;
-
-    // Write to NOC_SEND_CMD (non-blocking, fire-and-forget)
-    volatile uint64_t* noc_cmd = (volatile uint64_t*)NOC_SEND_CMD;
-    *noc_cmd = (uint64_t)(uintptr_t)desc;
+    NocCopyDescriptor desc;
+    desc.source_addr = src_addr;
+    desc.dest_addr = dst_addr;
+    desc.size_bytes = size_bytes;
+    desc.flags = 0;
+
+    // Publish to NOC_RING_TAIL (non-blocking, fire-and-forget)
+    uint64_t seq;
+    while ((seq = agni_hal_noc_submit(&desc, 1)) == 0) {
+        agni_hal_noc_wait_seq(agni_hal_noc_completed_seq() + 1, 1);
+    }
     // V6 Fix: CPU continues immediately (Thread 2 of dual-issue)
+    return seq;
 }
 
 // Poll NOC transfer status (non-blocking)
 static inline bool agni_hal_noc_is_busy(void) {
-    volatile uint32_t* status = (volatile uint32_t*)NOC_STATUS;
-    return (*status == 0x1);
+    return (agni_hal_reg_read32(NOC_STATUS) == 0x1);
 }
 
 // Wait for NOC completion (blocking)
 static inline int agni_hal_noc_wait(uint32_t timeout_ms) {
+#ifdef AGNI_HAL_SIM
+    return agni_sim_noc_wait(timeout_ms);
+#else
     uint32_t elapsed = 0;
     while (agni_hal_noc_is_busy() && elapsed < timeout_ms) {
         elapsed++;
@@ -124,31 +264,40 @@ static inline int agni_hal_noc_wait(uint32_t timeout_ms) {
         for (volatile int i = 0; i < 1000000; i++);
     }
     return agni_hal_noc_is_busy() ? -1 : 0;
+#endif
 }
 
 // Enable NOC IRQ (when transfer completes)
 static inline void agni_hal_noc_irq_enable(void) {
-    volatile uint32_t* irq_en = (volatile uint32_t*)NOC_IRQ_ENABLE;
-    *irq_en = 0x1;
+    agni_hal_reg_write32(NOC_IRQ_ENABLE, 0x1);
 }
 
 // Disable NOC IRQ
 static inline void agni_hal_noc_irq_disable(void) {
-    volatile uint32_t* irq_en = (volatile uint32_t*)NOC_IRQ_ENABLE;
-    *irq_en = 0x0;
+    agni_hal_reg_write32(NOC_IRQ_ENABLE, 0x0);
 }
 
 // Check NOC IRQ pending status
 static inline bool agni_hal_noc_irq_pending(void) {
-    volatile uint32_t* irq_stat = (volatile uint32_t*)NOC_IRQ_STATUS;
-    return (*irq_stat != 0x0);
+    return (agni_hal_reg_read32(NOC_IRQ_STATUS) != 0x0);
 }
 
+// NOC IRQ handler, called once per completed transfer while the IRQ is
+// enabled (agni_hal.cpp)
+void agni_hal_register_noc_irq_handler(void (*handler)(void));
+void agni_hal_invoke_noc_irq(void);
+
 ////////////////////////////////////////////////////////////////////////////////
-// SECTION 7: WRENCH (Gemmini) OPERATIONS
+// SECTION 8: WRENCH (Gemmini) OPERATIONS
 // Systolic array control via RoCC interface
 ////////////////////////////////////////////////////////////////////////////////
 
+#ifdef AGNI_HAL_SIM
+#define agni_wrench_config(rows, cols)   agni_sim_wrench_config((rows), (cols))
+#define agni_wrench_load_a(src_addr)     agni_sim_wrench_load_a((src_addr))
+#define agni_wrench_load_b(src_addr)     agni_sim_wrench_load_b((src_addr))
+#define agni_wrench_execute(output_addr) agni_sim_wrench_execute((output_addr))
+#else
 // Configure Wrench for matrix multiply (MxM) - NEUTRALIZED FOR HOST BUILD
 #define agni_wrench_config(rows, cols) do {} while(0)
 
@@ -160,9 +309,10 @@ static inline bool agni_hal_noc_irq_pending(void) {
 
 // Execute Wrench MAC (output address in rs1) - NEUTRALIZED FOR HOST BUILD
 #define agni_wrench_execute(output_addr) do {} while(0)
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
-// SECTION 8: MEMORY UTILITIES
+// SECTION 9: MEMORY UTILITIES
 ////////////////////////////////////////////////////////////////////////////////
 
 static inline void agni_hal_memcpy_l2(
@@ -183,11 +333,16 @@ static inline void agni_hal_memset_l2(
 
 // Flush cache line (write-through guarantee)
 static inline void agni_hal_flush_cache_line(uint64_t addr) {
+    (void)addr;
+#ifdef AGNI_HAL_SIM
+    __sync_synchronize();
+#else
     asm volatile("fence rw, rw");  // Memory fence
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// SECTION 9: BUZZING BEES CONTEXT & ENTRY POINTS
+// SECTION 10: BUZZING BEES CONTEXT & ENTRY POINTS
 // Placeholder APIs that Layer 1 (Bees) will call
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -234,6 +389,33 @@ static inline void agni_hal_bee_submit_key(
 ) {
     if (!ctx) return;
     // Key jobs use RVV 1.0 instructions (compiled by MLIR)
+#ifdef AGNI_HAL_SIM
+    agni_sim_key_submit(input_addr, output_addr, 0);
+#else
+    (void)input_addr;
+    (void)output_addr;
+#endif
+}
+
+// Key jobs completed since the last reset, in submission order, and a
+// wait for the first count of them. The device build does not run Key
+// jobs yet, so none is ever outstanding there.
+static inline uint64_t agni_hal_key_completed(void) {
+#ifdef AGNI_HAL_SIM
+    return agni_sim_key_completed();
+#else
+    return UINT64_MAX;
+#endif
+}
+
+static inline int agni_hal_key_wait(uint64_t count, uint32_t timeout_ms) {
+#ifdef AGNI_HAL_SIM
+    return agni_sim_key_wait(count, timeout_ms);
+#else
+    (void)count;
+    (void)timeout_ms;
+    return 0;
+#endif
 }
 
 // Wait for Bee job (blocking)
@@ -241,6 +423,7 @@ static inline int agni_hal_bee_wait(
     BeeContext* ctx,
     uint32_t timeout_ms
 ) {
+    (void)ctx;
     return agni_hal_noc_wait(timeout_ms);
 }
 
@@ -252,4 +435,23 @@ static inline void agni_hal_bee_register_done_callback(
     if (ctx) ctx->noc_done_callback = callback;
 }
 
+// Task accounting: the simulator reports cycles per task, from begin to
+// the completion of the last engine operation issued before end. No-ops
+// on the device.
+static inline void agni_hal_task_begin(uint32_t job_id) {
+#ifdef AGNI_HAL_SIM
+    agni_sim_task_begin(job_id);
+#else
+    (void)job_id;
+#endif
+}
+
+static inline void agni_hal_task_end(uint32_t job_id) {
+#ifdef AGNI_HAL_SIM
+    agni_sim_task_end(job_id);
+#else
+    (void)job_id;
+#endif
+}
+
 #endif // AGNI_HAL_H
\ No newline at end of file
@@ -0,0 +1,652 @@
+#include "agni_hal.h"
+#include "common.h"
+#include "config.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// MEMORY REGIONS
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    const char* name;
+    uint64_t base;
+    uint64_t size;
+    uint8_t* host;
+} SimRegion;
+
+static SimRegion g_regions[] = {
+    { "FOREMAN_RAM", FOREMAN_RAM_BASE, FOREMAN_RAM_SIZE, NULL },
+    { "WRENCH_L2",   WRENCH_L2_BASE,   WRENCH_L2_SIZE,   NULL },
+    { "KEY_L2",      KEY_L2_BASE,      KEY_L2_SIZE,      NULL },
+    { "GLOBAL_DRAM", GLOBAL_DRAM_BASE, GLOBAL_DRAM_SIZE, NULL },
+};
+static const size_t SIM_NUM_REGIONS = sizeof(g_regions) / sizeof(g_regions[0]);
+
+// Zero-filled and reserved without backing, so the 16GB DRAM only costs
+// the pages actually touched
+static uint8_t* map_region(uint64_t size) {
+    void* p = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return (p == MAP_FAILED) ? NULL : (uint8_t*)p;
+}
+
+static const SimRegion* find_region(uint64_t addr, uint64_t bytes) {
+    for (size_t r = 0; r < SIM_NUM_REGIONS; r++) {
+        const SimRegion& region = g_regions[r];
+        if (addr >= region.base && bytes <= region.size && addr - region.base <= region.size - bytes) {
+            return &region;
+        }
+    }
+    return NULL;
+}
+
+static bool in_dram(uint64_t addr) {
+    return addr >= GLOBAL_DRAM_BASE && addr - GLOBAL_DRAM_BASE < GLOBAL_DRAM_SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SIMULATOR STATE
+////////////////////////////////////////////////////////////////////////////////
+
+// A range some engine is writing, readable from ready on
+typedef struct {
+    uint64_t addr;
+    uint64_t bytes;
+    uint64_t ready;
+} PendingWrite;
+
+// A transfer or chain finishing at time; seq is its ring sequence number,
+// 0 for NOC_SEND_CMD
+typedef struct {
+    uint64_t time;
+    uint64_t seq;
+} NocCompletion;
+
+typedef struct {
+    bool initialized;
+    AgniSimConfig config;
+    AgniSimStats stats;
+    uint64_t now;
+
+    uint64_t noc_free;              // Engines are in order: each is busy until
+    uint64_t wrench_free;           // its last operation completes
+    uint64_t key_free;
+    std::deque<NocCompletion> noc_completions;  // Not yet passed by the clock
+    std::vector<PendingWrite> writes;
+
+    uint64_t ring_base;
+    uint64_t ring_size;
+    uint64_t ring_head;             // Descriptors consumed
+    uint64_t done_seq;              // NOC_DONE_SEQ
+
+    uint32_t noc_irq_enable;
+    uint32_t noc_irq_pending;
+    bool in_irq;
+    bool irq_masked;                // Foreman interrupts off (agni_hal_irq_save)
+    bool irq_deferred;              // NOC IRQ raised while masked
+
+    uint32_t wrench_rows;
+    uint32_t wrench_cols;
+    uint64_t wrench_a;
+    uint64_t wrench_b;
+
+    bool task_open;
+    uint64_t task_start;
+    uint64_t task_horizon;
+
+    std::deque<uint64_t> key_completions;   // Not yet passed by the clock
+    uint64_t key_done;
+
+    bool trace_on;
+    std::vector<AgniSimTraceEvent> trace;
+} SimState;
+
+static SimState g_sim;
+
+AgniSimConfig agni_sim_default_config(void) {
+    AgniSimConfig config;
+    config.mmio_cycles = 20;
+    config.noc_latency_cycles = 100;
+    config.noc_bytes_per_cycle = 16.0;
+    config.dram_latency_cycles = 120;
+    config.wrench_dim = 8;
+    config.wrench_load_bytes_per_cycle = 32.0;
+    config.key_bytes_per_cycle = 128.0;
+    config.key_startup_cycles = 40;
+    config.key_job_bytes = 4096;
+    config.foreman_active_mw = 250;
+    config.foreman_wfi_mw = 25;
+    return config;
+}
+
+int agni_sim_init(void) {
+    if (g_sim.initialized) return AGNI_OK;
+    for (size_t r = 0; r < SIM_NUM_REGIONS; r++) {
+        g_regions[r].host = map_region(g_regions[r].size);
+        if (!g_regions[r].host) {
+            LOG_ERROR("HAL sim: cannot map %s (%llu bytes)", g_regions[r].name,
+                      (unsigned long long)g_regions[r].size);
+            agni_sim_shutdown();
+            return AGNI_ERROR_ALLOCATION;
+        }
+    }
+    g_sim.config = agni_sim_default_config();
+    g_sim.initialized = true;
+    agni_sim_reset();
+    return AGNI_OK;
+}
+
+void agni_sim_shutdown(void) {
+    for (size_t r = 0; r < SIM_NUM_REGIONS; r++) {
+        if (g_regions[r].host) munmap(g_regions[r].host, (size_t)g_regions[r].size);
+        g_regions[r].host = NULL;
+    }
+    g_sim.initialized = false;
+}
+
+static bool ensure_init(void) {
+    return g_sim.initialized || agni_sim_init() == AGNI_OK;
+}
+
+void agni_sim_configure(const AgniSimConfig* config) {
+    if (!config || !ensure_init()) return;
+    g_sim.config = *config;
+    if (g_sim.config.wrench_dim == 0) g_sim.config.wrench_dim = 1;
+}
+
+void agni_sim_reset(void) {
+    if (!ensure_init()) return;
+    memset(&g_sim.stats, 0, sizeof(g_sim.stats));
+    g_sim.now = 0;
+    g_sim.noc_free = g_sim.wrench_free = g_sim.key_free = 0;
+    g_sim.noc_completions.clear();
+    g_sim.writes.clear();
+    g_sim.done_seq = g_sim.ring_head;
+    g_sim.noc_irq_enable = g_sim.noc_irq_pending = 0;
+    g_sim.in_irq = g_sim.irq_masked = g_sim.irq_deferred = false;
+    g_sim.wrench_rows = g_sim.wrench_cols = g_sim.config.wrench_dim;
+    g_sim.wrench_a = g_sim.wrench_b = 0;
+    g_sim.task_open = false;
+    g_sim.key_completions.clear();
+    g_sim.key_done = 0;
+    g_sim.trace.clear();
+}
+
+void* agni_sim_host_ptr(uint64_t addr, uint64_t bytes) {
+    if (!ensure_init()) return NULL;
+    const SimRegion* region = find_region(addr, bytes);
+    return region ? region->host + (addr - region->base) : NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CLOCK
+////////////////////////////////////////////////////////////////////////////////
+
+static void take_noc_irq(void) {
+    g_sim.stats.irqs++;
+    g_sim.in_irq = true;
+    agni_hal_invoke_noc_irq();
+    g_sim.in_irq = false;
+}
+
+// Moves the clock to t, raising the NOC IRQ for each completion passed.
+// Inside the handler the clock still moves, but further IRQs wait for it
+// to return. With the Foreman's interrupts masked they stay pending and
+// are taken, once, on restore.
+static void advance_to(uint64_t t) {
+    while (!g_sim.in_irq && !g_sim.noc_completions.empty() && g_sim.noc_completions.front().time <= t) {
+        NocCompletion done = g_sim.noc_completions.front();
+        g_sim.noc_completions.pop_front();
+        g_sim.now = std::max(g_sim.now, done.time);
+        if (done.seq) g_sim.done_seq = done.seq;
+        if (g_sim.noc_irq_enable) {
+            g_sim.noc_irq_pending = 1;
+            if (g_sim.irq_masked) {
+                g_sim.irq_deferred = true;
+            } else {
+                take_noc_irq();
+            }
+        }
+    }
+    g_sim.now = std::max(g_sim.now, t);
+}
+
+void agni_sim_advance(uint64_t cycles) {
+    if (!ensure_init()) return;
+    advance_to(g_sim.now + cycles);
+}
+
+uint64_t agni_sim_now(void) {
+    return g_sim.now;
+}
+
+void agni_sim_drain(void) {
+    if (!ensure_init()) return;
+    advance_to(std::max(std::max(g_sim.noc_free, g_sim.wrench_free), g_sim.key_free));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ENGINE TIMING
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t transfer_cycles(uint64_t bytes, double bytes_per_cycle) {
+    return (uint64_t)ceil((double)bytes / (bytes_per_cycle > 0.0 ? bytes_per_cycle : 1.0));
+}
+
+// Earliest cycle [addr, addr + bytes) holds the data of every write
+// issued so far
+static uint64_t ready_at(uint64_t addr, uint64_t bytes) {
+    uint64_t ready = 0;
+    for (size_t i = 0; i < g_sim.writes.size(); i++) {
+        const PendingWrite& w = g_sim.writes[i];
+        if (addr < w.addr + w.bytes && w.addr < addr + bytes) ready = std::max(ready, w.ready);
+    }
+    return ready;
+}
+
+static void record_write(uint64_t addr, uint64_t bytes, uint64_t ready) {
+    size_t kept = 0;
+    for (size_t i = 0; i < g_sim.writes.size(); i++) {
+        if (g_sim.writes[i].ready > g_sim.now) g_sim.writes[kept++] = g_sim.writes[i];
+    }
+    g_sim.writes.resize(kept);
+    PendingWrite w = { addr, bytes, ready };
+    g_sim.writes.push_back(w);
+}
+
+// Queues an operation of duration cycles on an engine; returns its end
+static uint64_t schedule(AgniSimEngine engine, uint64_t earliest, uint64_t cycles) {
+    uint64_t* engine_free = &g_sim.noc_free;
+    uint64_t* busy = &g_sim.stats.noc_busy_cycles;
+    if (engine == AGNI_SIM_WRENCH) {
+        engine_free = &g_sim.wrench_free;
+        busy = &g_sim.stats.wrench_busy_cycles;
+    } else if (engine == AGNI_SIM_KEY) {
+        engine_free = &g_sim.key_free;
+        busy = &g_sim.stats.key_busy_cycles;
+    }
+    uint64_t start = std::max(std::max(g_sim.now, *engine_free), earliest);
+    *engine_free = start + cycles;
+    *busy += cycles;
+    if (g_sim.task_open) g_sim.task_horizon = std::max(g_sim.task_horizon, *engine_free);
+    if (g_sim.trace_on) {
+        AgniSimTraceEvent event = { engine, start, *engine_free };
+        g_sim.trace.push_back(event);
+    }
+    return *engine_free;
+}
+
+static void drop(const char* what, uint64_t addr, uint64_t bytes) {
+    g_sim.stats.errors++;
+    LOG_ERROR("HAL sim: %s at 0x%llx (%llu bytes) is outside the memory map", what,
+              (unsigned long long)addr, (unsigned long long)bytes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NOC
+////////////////////////////////////////////////////////////////////////////////
+
+// Copies one descriptor and returns when its last byte lands; a dropped
+// descriptor completes at once. The latency runs from issue (or from the
+// source being ready) and overlaps whatever the link is still moving.
+static uint64_t noc_transfer(const NocCopyDescriptor* desc) {
+    uint64_t bytes = desc->size_bytes;
+    uint8_t* src = (uint8_t*)agni_sim_host_ptr(desc->source_addr, bytes);
+    uint8_t* dst = (uint8_t*)agni_sim_host_ptr(desc->dest_addr, bytes);
+    if (!src || !dst) {
+        drop("NOC copy", src ? desc->dest_addr : desc->source_addr, bytes);
+        return g_sim.now;
+    }
+    memmove(dst, src, (size_t)bytes);
+
+    const AgniSimConfig& cfg = g_sim.config;
+    uint64_t latency = cfg.noc_latency_cycles;
+    if (in_dram(desc->source_addr) || in_dram(desc->dest_addr)) latency += cfg.dram_latency_cycles;
+    uint64_t data_cycles = transfer_cycles(bytes, cfg.noc_bytes_per_cycle);
+    uint64_t start = std::max(std::max(g_sim.now, ready_at(desc->source_addr, bytes)) + latency, g_sim.noc_free);
+    uint64_t done = schedule(AGNI_SIM_NOC, start, data_cycles);
+    record_write(desc->dest_addr, bytes, done);
+    g_sim.stats.noc_transfers++;
+    g_sim.stats.noc_bytes += bytes;
+    return done;
+}
+
+static void noc_send(uint64_t desc_addr) {
+    const NocCopyDescriptor* desc =
+        (const NocCopyDescriptor*)agni_sim_host_ptr(desc_addr, sizeof(NocCopyDescriptor));
+    if (!desc) {
+        drop("NOC descriptor", desc_addr, sizeof(NocCopyDescriptor));
+        return;
+    }
+    NocCompletion done = { noc_transfer(desc), 0 };
+    g_sim.noc_completions.push_back(done);
+}
+
+// Consumes descriptors up to tail; each chain completes at its last one
+static void noc_ring_doorbell(uint64_t tail) {
+    if (g_sim.ring_size == 0 || tail < g_sim.ring_head || tail - g_sim.done_seq > g_sim.ring_size) {
+        drop("NOC ring tail", tail, 0);
+        return;
+    }
+    uint64_t chain_done = g_sim.now;
+    for (; g_sim.ring_head < tail; g_sim.ring_head++) {
+        uint64_t slot = g_sim.ring_base + (g_sim.ring_head % g_sim.ring_size) * sizeof(NocCopyDescriptor);
+        const NocCopyDescriptor* desc =
+            (const NocCopyDescriptor*)agni_sim_host_ptr(slot, sizeof(NocCopyDescriptor));
+        bool last = true;
+        if (desc) {
+            chain_done = std::max(chain_done, noc_transfer(desc));
+            last = !(desc->flags & NOC_DESC_CHAIN);
+        } else {
+            drop("NOC ring descriptor", slot, sizeof(NocCopyDescriptor));
+        }
+        // A chain still open at the tail is closed there
+        if (last || g_sim.ring_head + 1 == tail) {
+            NocCompletion done = { chain_done, g_sim.ring_head + 1 };
+            g_sim.noc_completions.push_back(done);
+            chain_done = g_sim.now;
+        }
+    }
+}
+
+uint64_t agni_sim_reg_read(uint64_t addr) {
+    if (!ensure_init()) return 0;
+    agni_sim_advance(g_sim.config.mmio_cycles);
+    switch (addr) {
+        case NOC_STATUS:
+            return (g_sim.now < g_sim.noc_free) ? 0x1 : 0x0;
+        case NOC_IRQ_ENABLE:
+            return g_sim.noc_irq_enable;
+        case NOC_IRQ_STATUS: {
+            uint32_t pending = g_sim.noc_irq_pending;
+            g_sim.noc_irq_pending = 0;
+            return pending;
+        }
+        case NOC_RING_BASE_REG:
+            return g_sim.ring_base;
+        case NOC_RING_SIZE_REG:
+            return g_sim.ring_size;
+        case NOC_DONE_SEQ:
+            return g_sim.done_seq;
+        default:
+            drop("register read", addr, 4);
+            return 0;
+    }
+}
+
+void agni_sim_reg_write(uint64_t addr, uint64_t value) {
+    if (!ensure_init()) return;
+    agni_sim_advance(g_sim.config.mmio_cycles);
+    switch (addr) {
+        case NOC_SEND_CMD:
+            noc_send(value);
+            break;
+        case NOC_IRQ_ENABLE:
+            g_sim.noc_irq_enable = (uint32_t)(value & 0x1);
+            break;
+        case NOC_RING_BASE_REG:
+            g_sim.ring_base = value;
+            break;
+        case NOC_RING_SIZE_REG:
+            if (value & (value - 1)) {
+                drop("NOC ring size", value, 0);
+                break;
+            }
+            g_sim.ring_size = value;
+            g_sim.ring_head = g_sim.done_seq = 0;
+            break;
+        case NOC_RING_TAIL:
+            noc_ring_doorbell(value);
+            break;
+        default:
+            drop("register write", addr, 8);
+            break;
+    }
+}
+
+int agni_sim_noc_wait(uint32_t timeout_ms) {
+    if (!ensure_init()) return -1;
+    agni_sim_advance(g_sim.config.mmio_cycles);
+    uint64_t limit = g_sim.now + (uint64_t)timeout_ms * (FOREMAN_FREQ_HZ / 1000);
+    if (g_sim.now < g_sim.noc_free) advance_to(std::min(g_sim.noc_free, limit));
+    return (g_sim.now < g_sim.noc_free) ? -1 : 0;
+}
+
+int agni_sim_noc_wait_seq(uint64_t seq, uint32_t timeout_ms) {
+    if (!ensure_init()) return -1;
+    uint64_t target = g_sim.now + (uint64_t)timeout_ms * (FOREMAN_FREQ_HZ / 1000);
+    for (size_t i = 0; i < g_sim.noc_completions.size(); i++) {
+        if (g_sim.noc_completions[i].seq >= seq) {
+            target = std::min(target, g_sim.noc_completions[i].time);
+            break;
+        }
+    }
+    if (g_sim.done_seq < seq) advance_to(target);
+    return (g_sim.done_seq >= seq) ? 0 : -1;
+}
+
+// Sleeps until the next NOC completion raises the IRQ. Called masked, it
+// returns at once on an IRQ already pending, and the completion it waits
+// for leaves its IRQ pending for agni_sim_irq_restore. With the IRQ
+// disabled or nothing in flight no interrupt would ever come, so it
+// returns false without moving the clock.
+bool agni_sim_wfi(void) {
+    if (!ensure_init()) return false;
+    if (g_sim.irq_deferred) return true;
+    if (!g_sim.noc_irq_enable || g_sim.noc_completions.empty() || g_sim.in_irq) return false;
+    uint64_t wake = std::max(g_sim.now, g_sim.noc_completions.front().time);
+    g_sim.stats.foreman_idle_cycles += wake - g_sim.now;
+    g_sim.stats.wfi_sleeps++;
+    advance_to(wake);
+    return true;
+}
+
+// Returns whether interrupts were enabled. Masking costs no cycles: it is
+// a CSR write on the Foreman, not MMIO.
+bool agni_sim_irq_save(void) {
+    bool enabled = !g_sim.irq_masked;
+    g_sim.irq_masked = true;
+    return enabled;
+}
+
+void agni_sim_irq_restore(bool enabled) {
+    if (!enabled) return;
+    g_sim.irq_masked = false;
+    if (g_sim.irq_deferred && !g_sim.in_irq) {
+        g_sim.irq_deferred = false;
+        if (g_sim.noc_irq_enable) take_noc_irq();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// WRENCH (8x8 systolic array)
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t wrench_load_cycles(uint64_t addr, uint64_t bytes) {
+    uint64_t cycles = transfer_cycles(bytes, g_sim.config.wrench_load_bytes_per_cycle);
+    return in_dram(addr) ? cycles + g_sim.config.dram_latency_cycles : cycles;
+}
+
+void agni_sim_wrench_config(uint32_t rows, uint32_t cols) {
+    if (!ensure_init()) return;
+    agni_sim_advance(1);
+    g_sim.wrench_rows = rows;
+    g_sim.wrench_cols = cols;
+}
+
+static void wrench_load(uint64_t src_addr, uint64_t bytes, uint64_t* latch) {
+    if (!ensure_init()) return;
+    agni_sim_advance(1);
+    *latch = src_addr;
+    schedule(AGNI_SIM_WRENCH, ready_at(src_addr, bytes), wrench_load_cycles(src_addr, bytes));
+}
+
+void agni_sim_wrench_load_a(uint64_t src_addr) {
+    wrench_load(src_addr, (uint64_t)g_sim.wrench_rows * g_sim.wrench_cols * sizeof(float), &g_sim.wrench_a);
+}
+
+void agni_sim_wrench_load_b(uint64_t src_addr) {
+    wrench_load(src_addr, (uint64_t)g_sim.wrench_cols * g_sim.wrench_cols * sizeof(float), &g_sim.wrench_b);
+}
+
+// Each dim x dim x dim block streams through the array in dim cycles;
+// filling and draining the array costs 2 * dim once per execute
+void agni_sim_wrench_execute(uint64_t output_addr) {
+    if (!ensure_init()) return;
+    agni_sim_advance(1);
+    const size_t M = g_sim.wrench_rows, N = g_sim.wrench_cols, K = g_sim.wrench_cols;
+    const uint64_t a_bytes = (uint64_t)M * K * sizeof(float);
+    const uint64_t b_bytes = (uint64_t)K * N * sizeof(float);
+    const uint64_t c_bytes = (uint64_t)M * N * sizeof(float);
+    const float* A = (const float*)agni_sim_host_ptr(g_sim.wrench_a, a_bytes);
+    const float* B = (const float*)agni_sim_host_ptr(g_sim.wrench_b, b_bytes);
+    float* C = (float*)agni_sim_host_ptr(output_addr, c_bytes);
+    if (!A || !B || !C) {
+        if (!A) drop("Wrench operand A", g_sim.wrench_a, a_bytes);
+        else if (!B) drop("Wrench operand B", g_sim.wrench_b, b_bytes);
+        else drop("Wrench output", output_addr, c_bytes);
+        return;
+    }
+    std::vector<float> out(M * N, 0.0f);     // A or B may overlap C
+    for (size_t i = 0; i < M; i++) {
+        for (size_t k = 0; k < K; k++) {
+            float a = A[i * K + k];
+            for (size_t j = 0; j < N; j++) out[i * N + j] += a * B[k * N + j];
+        }
+    }
+    memcpy(C, out.data(), out.size() * sizeof(float));
+
+    const uint64_t dim = g_sim.config.wrench_dim;
+    uint64_t blocks = ((M + dim - 1) / dim) * ((N + dim - 1) / dim) * ((K + dim - 1) / dim);
+    uint64_t cycles = blocks * dim + 2 * dim + wrench_load_cycles(output_addr, c_bytes);
+    uint64_t done = schedule(AGNI_SIM_WRENCH, 0, cycles);
+    record_write(output_addr, c_bytes, done);
+    g_sim.stats.wrench_ops++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// KEY (RVV 1.0, 1024-bit)
+////////////////////////////////////////////////////////////////////////////////
+
+void agni_sim_key_submit(uint64_t input_addr, uint64_t output_addr, uint32_t bytes) {
+    if (!ensure_init()) return;
+    agni_sim_advance(1);
+    const AgniSimConfig& cfg = g_sim.config;
+    if (bytes == 0) bytes = cfg.key_job_bytes;
+    uint64_t cycles = cfg.key_startup_cycles + transfer_cycles(bytes, cfg.key_bytes_per_cycle);
+    if (in_dram(input_addr)) cycles += cfg.dram_latency_cycles;
+    uint64_t done = schedule(AGNI_SIM_KEY, ready_at(input_addr, bytes), cycles);
+    record_write(output_addr, bytes, done);
+    g_sim.key_completions.push_back(done);
+    g_sim.stats.key_jobs++;
+}
+
+// The Key runs jobs in order, so completions pass in submission order
+static void key_retire(void) {
+    while (!g_sim.key_completions.empty() && g_sim.key_completions.front() <= g_sim.now) {
+        g_sim.key_completions.pop_front();
+        g_sim.key_done++;
+    }
+}
+
+uint64_t agni_sim_key_completed(void) {
+    if (!ensure_init()) return 0;
+    agni_sim_advance(g_sim.config.mmio_cycles);
+    key_retire();
+    return g_sim.key_done;
+}
+
+int agni_sim_key_wait(uint64_t count, uint32_t timeout_ms) {
+    if (!ensure_init()) return -1;
+    key_retire();
+    if (count > g_sim.key_done) {
+        uint64_t target = g_sim.now + (uint64_t)timeout_ms * (FOREMAN_FREQ_HZ / 1000);
+        uint64_t ahead = count - g_sim.key_done - 1;
+        if (ahead < g_sim.key_completions.size()) target = std::min(target, g_sim.key_completions[ahead]);
+        advance_to(target);
+        key_retire();
+    }
+    return (g_sim.key_done >= count) ? 0 : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TASKS AND REPORTING
+////////////////////////////////////////////////////////////////////////////////
+
+void agni_sim_task_begin(uint32_t job_id) {
+    (void)job_id;
+    if (!ensure_init()) return;
+    g_sim.task_open = true;
+    g_sim.task_start = g_sim.task_horizon = g_sim.now;
+}
+
+void agni_sim_task_end(uint32_t job_id) {
+    (void)job_id;
+    if (!g_sim.task_open) return;
+    g_sim.task_open = false;
+    uint64_t cycles = std::max(g_sim.task_horizon, g_sim.now) - g_sim.task_start;
+    AgniSimStats& s = g_sim.stats;
+    s.task_cycles_min = s.tasks ? std::min(s.task_cycles_min, cycles) : cycles;
+    s.task_cycles_max = std::max(s.task_cycles_max, cycles);
+    s.task_cycles_total += cycles;
+    s.tasks++;
+}
+
+void agni_sim_trace_enable(bool on) {
+    g_sim.trace_on = on;
+}
+
+size_t agni_sim_trace(const AgniSimTraceEvent** events) {
+    if (events) *events = g_sim.trace.data();
+    return g_sim.trace.size();
+}
+
+void agni_sim_get_stats(AgniSimStats* stats) {
+    if (!stats) return;
+    *stats = g_sim.stats;
+    stats->cycles = g_sim.now;
+}
+
+double agni_sim_foreman_idle_fraction(const AgniSimStats* stats) {
+    return stats->cycles ? (double)stats->foreman_idle_cycles / (double)stats->cycles : 0.0;
+}
+
+// A spinning loop re-reads NOC_STATUS every mmio_cycles
+uint64_t agni_sim_polls_avoided(const AgniSimStats* stats) {
+    return stats->foreman_idle_cycles / MAX(g_sim.config.mmio_cycles, (uint32_t)1);
+}
+
+double agni_sim_foreman_power_w(const AgniSimStats* stats) {
+    double idle = agni_sim_foreman_idle_fraction(stats);
+    return ((1.0 - idle) * g_sim.config.foreman_active_mw + idle * g_sim.config.foreman_wfi_mw) / 1000.0;
+}
+
+void agni_sim_print_report(void) {
+    AgniSimStats s;
+    agni_sim_get_stats(&s);
+    double cycles = (double)MAX(s.cycles, (uint64_t)1);
+    double us_per_cycle = 1e6 / (double)FOREMAN_FREQ_HZ;
+    printf("[SIM] %llu cycles (%.1f us at %.1f GHz)\n", (unsigned long long)s.cycles,
+           (double)s.cycles * us_per_cycle, (double)FOREMAN_FREQ_HZ / 1e9);
+    if (s.tasks) {
+        double avg = (double)s.task_cycles_total / (double)s.tasks;
+        printf("[SIM] %llu tasks: %.0f cycles/task (%.2f us), min %llu, max %llu\n",
+               (unsigned long long)s.tasks, avg, avg * us_per_cycle,
+               (unsigned long long)s.task_cycles_min, (unsigned long long)s.task_cycles_max);
+    }
+    printf("[SIM] NOC %llu transfers, %llu bytes, busy %.1f%% | Wrench %llu ops, busy %.1f%% | "
+           "Key %llu jobs, busy %.1f%% | %llu IRQs\n",
+           (unsigned long long)s.noc_transfers, (unsigned long long)s.noc_bytes,
+           100.0 * (double)s.noc_busy_cycles / cycles, (unsigned long long)s.wrench_ops,
+           100.0 * (double)s.wrench_busy_cycles / cycles, (unsigned long long)s.key_jobs,
+           100.0 * (double)s.key_busy_cycles / cycles, (unsigned long long)s.irqs);
+    double power = agni_sim_foreman_power_w(&s);
+    printf("[SIM] Foreman idle %.1f%% (%llu WFIs, ~%llu polls avoided), %.3f W = %.1f%% of the %d W target\n",
+           100.0 * agni_sim_foreman_idle_fraction(&s), (unsigned long long)s.wfi_sleeps,
+           (unsigned long long)agni_sim_polls_avoided(&s), power, 100.0 * power / TARGET_POWER_W,
+           TARGET_POWER_W);
+    if (s.errors) printf("[SIM] %llu operations dropped for bad addresses\n", (unsigned long long)s.errors);
+}
@@ -0,0 +1,151 @@
+#ifndef AGNI_HAL_SIM_H
+#define AGNI_HAL_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// HOST SIMULATOR BACKEND FOR agni_hal.h
+// Selected for every non-RISC-V build (see AGNI_HAL_SIM in agni_hal.h).
+// FOREMAN_RAM, WRENCH_L2, KEY_L2 and GLOBAL_DRAM are host memory at their
+// device addresses; the NOC registers, the Wrench RoCC instructions and Key
+// jobs are modelled.
+//
+// Functionally every operation completes when it is issued, in program
+// order; the NOC reads ring descriptors when the tail is published.
+// Timing is tracked separately on one clock in Foreman cycles
+// (FOREMAN_FREQ_HZ): each engine (NOC, Wrench, Key) runs its operations in
+// order, and an operation starts once its engine is free and every earlier
+// operation writing to its source range has finished. The NOC fetches
+// descriptors ahead, so its latency overlaps the previous transfer and
+// back-to-back ring entries stream at full bandwidth. The Foreman pays
+// mmio_cycles per register access and moves ahead to an engine's
+// completion only when it waits for it. NOC_STATUS, the IRQ and
+// agni_hal_noc_wait() follow that clock, so a polling loop sees BUSY until
+// the modelled transfer has finished.
+//
+// Single-threaded, like the Foreman. The NOC IRQ handler
+// (agni_hal_register_noc_irq_handler) runs on the caller's thread when the
+// clock passes a completion; IRQs raised inside the handler are delivered
+// after it returns. The clock is virtual, so WFI does not block a host
+// thread: it moves the clock to the next completion and books the gap as
+// Foreman idle time.
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint32_t mmio_cycles;                 // Foreman cost of one register access
+    uint32_t noc_latency_cycles;          // Descriptor fetch to first byte
+    double   noc_bytes_per_cycle;
+    uint32_t dram_latency_cycles;         // Added to engine reads from GLOBAL_DRAM
+    uint32_t wrench_dim;                  // Side of the systolic array (8)
+    double   wrench_load_bytes_per_cycle; // Operand loads and result stores
+    double   key_bytes_per_cycle;         // 1024-bit vector unit
+    uint32_t key_startup_cycles;
+    uint32_t key_job_bytes;               // Streamed by agni_hal_bee_submit_key
+    uint32_t foreman_active_mw;           // Power proxy: Foreman running or polling
+    uint32_t foreman_wfi_mw;              // and clock-gated in WFI
+} AgniSimConfig;
+
+typedef struct {
+    uint64_t cycles;                      // Foreman clock
+    uint64_t noc_transfers;
+    uint64_t noc_bytes;
+    uint64_t noc_busy_cycles;             // Moving data, latency excluded
+    uint64_t wrench_ops;                  // Executes; loads count as busy time
+    uint64_t wrench_busy_cycles;
+    uint64_t key_jobs;
+    uint64_t key_busy_cycles;
+    uint64_t irqs;
+    uint64_t foreman_idle_cycles;         // Spent in WFI
+    uint64_t wfi_sleeps;
+    uint64_t tasks;                       // agni_hal_task_begin/end pairs
+    uint64_t task_cycles_total;
+    uint64_t task_cycles_min;
+    uint64_t task_cycles_max;
+    uint64_t errors;                      // Operations dropped for bad addresses
+} AgniSimStats;
+
+typedef enum {
+    AGNI_SIM_NOC,
+    AGNI_SIM_WRENCH,
+    AGNI_SIM_KEY
+} AgniSimEngine;
+
+// One engine operation on the timeline: a NOC descriptor, a Wrench load or
+// execute, a Key job
+typedef struct {
+    AgniSimEngine engine;
+    uint64_t start;
+    uint64_t end;
+} AgniSimTraceEvent;
+
+// Maps the memory regions on first use; agni_hal_init() calls it.
+// GLOBAL_DRAM is reserved lazily, so untouched pages cost nothing.
+// Returns AGNI_OK or AGNI_ERROR_ALLOCATION.
+int agni_sim_init(void);
+void agni_sim_shutdown(void);
+
+// Defaults: 16 B/cycle NOC with 100 cycles latency, 120 cycles DRAM
+// latency, 8x8 Wrench loading 32 B/cycle, 128 B/cycle Key, a Foreman
+// drawing 250 mW active and 25 mW in WFI.
+AgniSimConfig agni_sim_default_config(void);
+void agni_sim_configure(const AgniSimConfig* config);
+
+// Clock, engines, IRQ state and stats back to zero; memory and the ring
+// registers are kept, with everything published counted as completed
+void agni_sim_reset(void);
+
+// Host view of [addr, addr + bytes); NULL unless inside one region
+void* agni_sim_host_ptr(uint64_t addr, uint64_t bytes);
+
+// Foreman time: compute between HAL calls, the current cycle, and waiting
+// until every engine is idle
+void agni_sim_advance(uint64_t cycles);
+uint64_t agni_sim_now(void);
+void agni_sim_drain(void);
+
+void agni_sim_get_stats(AgniSimStats* stats);
+
+// Records every engine operation while on, in issue order; reset clears
+// the record. The pointer stays valid until the next operation or reset.
+void agni_sim_trace_enable(bool on);
+size_t agni_sim_trace(const AgniSimTraceEvent** events);
+
+// Foreman power proxy over the run so far: idle share of the clock, the
+// NOC_STATUS polls a spinning loop would have made while idle, and mean
+// Foreman power in watts, to set against TARGET_POWER_W
+double agni_sim_foreman_idle_fraction(const AgniSimStats* stats);
+uint64_t agni_sim_polls_avoided(const AgniSimStats* stats);
+double agni_sim_foreman_power_w(const AgniSimStats* stats);
+void agni_sim_print_report(void);
+
+// Backend of the agni_hal.h accessors, not for direct use
+uint64_t agni_sim_reg_read(uint64_t addr);
+void agni_sim_reg_write(uint64_t addr, uint64_t value);
+int agni_sim_noc_wait(uint32_t timeout_ms);
+int agni_sim_noc_wait_seq(uint64_t seq, uint32_t timeout_ms);
+bool agni_sim_wfi(void);
+bool agni_sim_irq_save(void);
+void agni_sim_irq_restore(bool enabled);
+
+// Wrench: C = A * B in row-major f32, A rows x cols, B cols x cols,
+// C rows x cols (the Foreman issues square 8x8 tiles)
+void agni_sim_wrench_config(uint32_t rows, uint32_t cols);
+void agni_sim_wrench_load_a(uint64_t src_addr);
+void agni_sim_wrench_load_b(uint64_t src_addr);
+void agni_sim_wrench_execute(uint64_t output_addr);
+
+// Key jobs are MLIR-generated RVV code the simulator cannot run: only
+// their time is modelled. bytes == 0 uses key_job_bytes. Jobs complete in
+// submission order; completed and wait count them.
+void agni_sim_key_submit(uint64_t input_addr, uint64_t output_addr, uint32_t bytes);
+uint64_t agni_sim_key_completed(void);
+int agni_sim_key_wait(uint64_t count, uint32_t timeout_ms);
+
+// A task's cycles run from begin to the completion of the last operation
+// issued before end
+void agni_sim_task_begin(uint32_t job_id);
+void agni_sim_task_end(uint32_t job_id);
+
+#endif // AGNI_HAL_SIM_H
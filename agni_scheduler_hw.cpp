@@ -1,82 +1,263 @@
+#include "agni_scheduler_hw.h"
+#include "agni_task_ring.h"
 #include "agni_hal.h"
+#include "common.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 
-// Task queue for scheduler
-typedef struct {
-    uint32_t job_id;
-    uint64_t wrench_a_addr;
-    uint64_t wrench_b_addr;
-    uint64_t wrench_c_addr;
-} Task;
+#define SCHED_QUEUE_SIZE   256
 
-#define MAX_TASKS 100
-static Task task_queue[MAX_TASKS];
-static uint32_t queue_head = 0;
-static uint32_t queue_tail = 0;
+// Multi-producer: host threads and IRQ handlers may submit while the
+// Foreman loop consumes. Constant-initialized, so submitting never runs
+// an init guard and works before agni_scheduler_init.
+static AgniTaskSlot task_slots[SCHED_QUEUE_SIZE];
+static AgniTaskRing task_queue = AGNI_TASK_RING_INITIALIZER(task_slots, SCHED_QUEUE_SIZE, true);
 
 // Submit task to queue
-void agni_scheduler_submit_task(const Task* task) {
-    if ((queue_tail + 1) % MAX_TASKS == queue_head) {
-        return;  // Queue full
-    }
-    memcpy(&task_queue[queue_tail], task, sizeof(Task));
-    queue_tail = (queue_tail + 1) % MAX_TASKS;
+int agni_scheduler_submit_task(const Task* task) {
+    return agni_task_ring_push(&task_queue, task);
+}
+
+int agni_scheduler_submit_batch(const Task* tasks, uint32_t count) {
+    return agni_task_ring_push_batch(&task_queue, tasks, count);
 }
 
 // Get next task
 bool agni_scheduler_get_next_task(Task* task) {
-    if (queue_head == queue_tail) {
-        return false;  // Queue empty
+    return agni_task_ring_pop(&task_queue, task);
+}
+
+// Copies in flight, oldest first; each task uses one ring entry, so the
+// ring bounds how many there can be. The NOC IRQ handler retires from
+// the head while the main context issues at the tail; everything else the
+// handler touches is only changed by the main context with interrupts
+// masked.
+#define SCHED_COPY_BYTES   4096
+#define SCHED_KEY_INPUT    KEY_L2_BASE
+#define SCHED_KEY_OUTPUT   (KEY_L2_BASE + SCHED_COPY_BYTES)
+
+typedef struct {
+    uint64_t seq;
+    uint32_t job_id;
+    uint32_t slot;
+    uint64_t key_input;
+    uint64_t key_output;
+} InFlightCopy;
+
+static InFlightCopy inflight[NOC_RING_ENTRIES];
+static volatile uint32_t inflight_head = 0;  // Next to retire
+static volatile uint32_t inflight_tail = 0;  // Next to issue
+static BeeContext key_ctx;
+static AgniSchedulerStats sched_stats;
+static uint64_t key_jobs_issued = 0;
+
+// Pipelined mode: tile i uses stage slot i % pipe_buffers in the Wrench
+// output, Key input and Key output partitions
+static uint32_t pipe_buffers = 0;
+static uint64_t pipe_issued = 0;
+static uint64_t slot_copy_seq[AGNI_PIPELINE_MAX_BUFFERS];   // Last copy out of each Wrench slot
+static uint64_t slot_key_job[AGNI_PIPELINE_MAX_BUFFERS];    // Key job reading each Key input slot
+static uint64_t key_stall_job = 0;  // Key job the last issue waits on (it raises no IRQ), or 0
+
+static uint64_t wrench_slot(uint32_t slot) {
+    return WRENCH_L2_BASE + (uint64_t)slot * (WRENCH_L2_SIZE / pipe_buffers);
+}
+
+static uint64_t key_input_slot(uint32_t slot) {
+    return KEY_L2_BASE + (uint64_t)slot * (KEY_L2_SIZE / 2 / pipe_buffers);
+}
+
+static uint64_t key_output_slot(uint32_t slot) {
+    return KEY_L2_BASE + KEY_L2_SIZE / 2 + (uint64_t)slot * (KEY_L2_SIZE / 2 / pipe_buffers);
+}
+
+static bool queue_empty(void) {
+    return agni_task_ring_empty(&task_queue);
+}
+
+// Queues the Key job of every copy at or below done_seq. Runs in the NOC
+// IRQ handler, or through retire_copies_masked.
+static void retire_copies(uint64_t done_seq) {
+    while (inflight_head != inflight_tail && inflight[inflight_head % NOC_RING_ENTRIES].seq <= done_seq) {
+        const InFlightCopy& copy = inflight[inflight_head % NOC_RING_ENTRIES];
+        agni_hal_bee_submit_key(&key_ctx, copy.key_input, copy.key_output);
+        key_jobs_issued++;
+        if (pipe_buffers) slot_key_job[copy.slot] = key_jobs_issued;
+        inflight_head++;
+        sched_stats.retired++;
     }
-    memcpy(task, &task_queue[queue_head], sizeof(Task));
-    queue_head = (queue_head + 1) % MAX_TASKS;
-    return true;
 }
 
-// Main scheduler loop (runs on Foreman CPU)
+// Main context: the handler must not retire the same copies under us
+static void retire_copies_masked(uint64_t done_seq) {
+    AgniIrqFlags flags = agni_hal_irq_save();
+    retire_copies(done_seq);
+    agni_hal_irq_restore(flags);
+}
+
 // Implements V6 (Dual-Issue) Software DMA Fix (TRM v3.0 Sec 5.0)
-void agni_scheduler_run(void) {
+static bool issue_next_task(void) {
     Task current_task;
+    key_stall_job = 0;
 
-    while (1) {
-        // Thread 1: Check if NOC is busy
-        if (agni_hal_noc_is_busy()) {
-            continue;  // Wait for NOC to complete
+    // Thread 1: Check the NOC ring has room; earlier copies stay in flight
+    if (inflight_tail - inflight_head == NOC_RING_ENTRIES || agni_hal_noc_ring_space(1) == 0) {
+        return false;  // Wait for a descriptor to retire
+    }
+    if (queue_empty()) {
+        return false;
+    }
+
+    // Pipelined: the Wrench may overwrite its slot once the copy of tile
+    // i - buffers has left it, and the NOC may overwrite the Key input once
+    // that tile's Key job has read it
+    uint32_t slot = pipe_buffers ? (uint32_t)(pipe_issued % pipe_buffers) : 0;
+    if (pipe_buffers && pipe_issued >= pipe_buffers) {
+        if (!agni_hal_noc_seq_done(slot_copy_seq[slot])) {
+            return false;  // The IRQ or the next poll wakes us
+        }
+        retire_copies_masked(slot_copy_seq[slot]);
+        if (agni_hal_key_completed() < slot_key_job[slot]) {
+            key_stall_job = slot_key_job[slot];
+            return false;  // The Key raises no IRQ: the caller waits on it
         }
+    }
 
-        // Thread 2: Get next task from queue (dual-issue with NOC check)
-        // V6 FIX: Both operations happen simultaneously in dual-issue pipeline
-        if (!agni_scheduler_get_next_task(&current_task)) {
-            continue;  // No task, yield
+    // Thread 2: Get next task from queue (dual-issue with NOC check)
+    // V6 FIX: Both operations happen simultaneously in dual-issue pipeline
+    if (!agni_scheduler_get_next_task(&current_task)) {
+        return false;
+    }
+    agni_hal_task_begin(current_task.job_id);
+    uint64_t wrench_c_addr = pipe_buffers ? wrench_slot(slot) : current_task.wrench_c_addr;
+
+    // Execute Wrench job (fire-and-forget)
+    agni_wrench_config(8, 8);
+    agni_wrench_load_a(current_task.wrench_a_addr);
+    agni_wrench_load_b(current_task.wrench_b_addr);
+    agni_wrench_execute(wrench_c_addr);
+
+    // The handler may retire the entry once inflight_tail covers it, so
+    // fill it in first
+    AgniIrqFlags flags = agni_hal_irq_save();
+    InFlightCopy& copy = inflight[inflight_tail % NOC_RING_ENTRIES];
+    copy.job_id = current_task.job_id;
+    copy.slot = slot;
+    copy.key_input = pipe_buffers ? key_input_slot(slot) : SCHED_KEY_INPUT;
+    copy.key_output = pipe_buffers ? key_output_slot(slot) : SCHED_KEY_OUTPUT;
+
+    // V6 FIX: Immediately issue NOC copy (non-blocking, async)
+    // Thread 1: NOC_RING_TAIL write
+    copy.seq = agni_hal_noc_copy_async(
+        wrench_c_addr,               // Wrench output
+        copy.key_input,              // Key input
+        SCHED_COPY_BYTES             // 4KB transfer
+    );
+    if (pipe_buffers) slot_copy_seq[slot] = copy.seq;
+    inflight_tail++;
+    agni_hal_irq_restore(flags);
+    pipe_issued++;
+    agni_hal_task_end(current_task.job_id);
+    sched_stats.tasks++;
+
+    // Thread 2: Foreman does NOT stall; the copy's completion queues the
+    // Key job (NOC IRQ, or the next poll)
+    return true;
+}
+
+void agni_scheduler_set_pipeline(uint32_t buffers) {
+    pipe_buffers = MIN(buffers, (uint32_t)AGNI_PIPELINE_MAX_BUFFERS);
+    pipe_issued = 0;
+    memset(slot_copy_seq, 0, sizeof(slot_copy_seq));
+    memset(slot_key_job, 0, sizeof(slot_key_job));
+    key_jobs_issued = agni_hal_key_completed();
+}
+
+// Registers the completion handler and enables the NOC IRQ
+void agni_scheduler_init(void) {
+    agni_hal_bee_init(&key_ctx);
+    agni_hal_register_noc_irq_handler(agni_noc_irq_handler);
+    agni_hal_noc_irq_enable();
+}
+
+// One pass of the polling loop
+bool agni_scheduler_step(void) {
+    if (issue_next_task()) {
+        return true;
+    }
+    if (inflight_head == inflight_tail) {
+        return !queue_empty();  // Ring held by other copies, or done
+    }
+
+    // Nothing to issue: spin on NOC_DONE_SEQ
+    sched_stats.polls++;
+    retire_copies_masked(agni_hal_noc_completed_seq());
+    return true;
+}
+
+// Completion-driven loop: the Foreman only runs when there is a task to
+// issue or a copy to retire. The last check and the WFI run masked, so a
+// completion in between keeps its IRQ pending and ends the WFI; the
+// handler runs on restore.
+void agni_scheduler_run_until_idle(void) {
+    for (;;) {
+        while (issue_next_task()) {
+        }
+        AgniIrqFlags flags = agni_hal_irq_save();
+        if (issue_next_task()) {
+            agni_hal_irq_restore(flags);
+            continue;
+        }
+        if (inflight_head == inflight_tail && queue_empty()) {
+            agni_hal_irq_restore(flags);
+            return;
+        }
+        if (key_stall_job) {
+            // No IRQ would end a WFI: block on the Key job unmasked, so
+            // NOC completions are still handled meanwhile
+            agni_hal_irq_restore(flags);
+            agni_hal_key_wait(key_stall_job, 1);
+            continue;
         }
+        bool slept = agni_hal_wait_for_interrupt();
+        agni_hal_irq_restore(flags);
+        if (slept) {
+            sched_stats.sleeps++;
+        } else {
+            // No IRQ can wake us (it is disabled): fall back to one poll
+            sched_stats.polls++;
+            retire_copies_masked(agni_hal_noc_completed_seq());
+        }
+    }
+}
 
-        // Execute Wrench job (fire-and-forget)
-        agni_wrench_config(8, 8);
-        agni_wrench_load_a(current_task.wrench_a_addr);
-        agni_wrench_load_b(current_task.wrench_b_addr);
-        agni_wrench_execute(current_task.wrench_c_addr);
-
-        // V6 FIX: Immediately issue NOC copy (non-blocking, async)
-        // Thread 1: NOC_SEND_CMD write
-        agni_hal_noc_copy_async(
-            current_task.wrench_c_addr,  // Wrench output
-            KEY_L2_BASE,                  // Key input
-            4096                          // 4KB transfer
-        );
-
-        // Thread 2: Foreman does NOT stall
-        // Dual-issue pipeline allows both NOC_SEND_CMD and next instruction
-        // Loop immediately continues (no 40ms stall)
-
-        // Later (40ms): NOC IRQ fires
-        // Interrupt handler will queue next Mamba (Key) job
+// Main scheduler loop (runs on Foreman CPU); new tasks and completions
+// both arrive as interrupts
+void agni_scheduler_run(void) {
+    agni_scheduler_init();
+    while (1) {
+        agni_scheduler_run_until_idle();
+        AgniIrqFlags flags = agni_hal_irq_save();
+        if (queue_empty()) {
+            agni_hal_wait_for_interrupt();
+        }
+        agni_hal_irq_restore(flags);
     }
 }
 
-// NOC interrupt handler (called when transfer completes)
+// NOC interrupt handler (called when transfer completes): acknowledge,
+// then queue the Key job of every copy that has landed
 void agni_noc_irq_handler(void) {
-    // Queue next Key job for execution
-    // This is called after NOC transfer finishes
-}
\ No newline at end of file
+    sched_stats.irqs++;
+    agni_hal_noc_irq_pending();
+    retire_copies(agni_hal_noc_completed_seq());
+}
+
+void agni_scheduler_get_stats(AgniSchedulerStats* stats) {
+    if (stats) *stats = sched_stats;
+}
+
+void agni_scheduler_reset_stats(void) {
+    memset(&sched_stats, 0, sizeof(sched_stats));
+}
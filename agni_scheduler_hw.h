@@ -0,0 +1,75 @@
+#ifndef AGNI_SCHEDULER_HW_H
+#define AGNI_SCHEDULER_HW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// FOREMAN TASK SCHEDULER
+// Each task runs one Wrench job and copies its output to KEY_L2 over the
+// NOC; copies queue on the NOC descriptor ring, so the next task starts
+// while earlier ones are still in flight. A copy is retired when its
+// sequence number completes, which queues the task's Key job. The NOC IRQ
+// retires copies in the event loop; agni_scheduler_step() polls instead.
+// On the host the HAL simulator runs the engines, so either can drain a
+// queue and report cycles per task.
+////////////////////////////////////////////////////////////////////////////////
+
+// Task queue for scheduler
+typedef struct {
+    uint32_t job_id;
+    uint64_t wrench_a_addr;
+    uint64_t wrench_b_addr;
+    uint64_t wrench_c_addr;
+} Task;
+
+typedef struct {
+    uint64_t tasks;                 // Issued to the Wrench and the NOC
+    uint64_t retired;               // Copies retired, one Key job each
+    uint64_t irqs;                  // agni_noc_irq_handler runs
+    uint64_t polls;                 // NOC_DONE_SEQ reads with nothing to issue
+    uint64_t sleeps;                // WFIs in the event loop
+} AgniSchedulerStats;
+
+// Lock-free, from any number of threads or IRQ handlers (agni_task_ring.h).
+// Return AGNI_OK, or AGNI_ERROR_QUEUE_FULL with nothing queued once the
+// 256 entries are taken; a batch is queued whole or not at all.
+int agni_scheduler_submit_task(const Task* task);
+int agni_scheduler_submit_batch(const Task* tasks, uint32_t count);
+
+// Foreman loop only
+bool agni_scheduler_get_next_task(Task* task);
+
+// Software-pipelined mode: the L2s are split into buffers stage slots
+// (2 for ping-pong), and tile i's Wrench output, Key input and Key output
+// use slot i % buffers, replacing task.wrench_c_addr. The Wrench computes
+// tile i + 1 while the NOC moves tile i and the Key consumes tile i - 1;
+// a slot is reused only once the copy or Key job reading it has finished.
+// 0 goes back to the task's addresses and one shared Key input. Call while
+// idle, after any simulator reset.
+#define AGNI_PIPELINE_MAX_BUFFERS 16
+void agni_scheduler_set_pipeline(uint32_t buffers);
+
+// Registers agni_noc_irq_handler and enables the NOC IRQ
+void agni_scheduler_init(void);
+
+// One pass of the polling loop: issues the next task, or reads
+// NOC_DONE_SEQ and retires finished copies. False once the queue is empty
+// and every copy has retired.
+bool agni_scheduler_step(void);
+
+// Event loop: issues tasks while the ring has room and sleeps in WFI
+// until the NOC IRQ retires a copy. Returns once the queue is empty and
+// every copy has retired.
+void agni_scheduler_run_until_idle(void);
+
+// Main scheduler loop (runs on Foreman CPU), never returns
+void agni_scheduler_run(void);
+
+// NOC interrupt handler (called when transfer completes)
+void agni_noc_irq_handler(void);
+
+void agni_scheduler_get_stats(AgniSchedulerStats* stats);
+void agni_scheduler_reset_stats(void);
+
+#endif // AGNI_SCHEDULER_HW_H
@@ -0,0 +1,101 @@
+#include "agni_task_ring.h"
+#include "common.h"
+
+int agni_task_ring_init(AgniTaskRing* ring, AgniTaskSlot* slots, uint32_t capacity, bool multi_producer) {
+    if (!ring || !slots) return AGNI_ERROR_NULL_POINTER;
+    if (capacity == 0 || (capacity & (capacity - 1))) {
+        return AGNI_ERROR_INVALID_INPUT;
+    }
+    ring->mask = capacity - 1;
+    ring->multi_producer = multi_producer;
+    ring->slots = slots;
+    for (uint32_t i = 0; i < capacity; i++) ring->slots[i].seq.store(0, std::memory_order_relaxed);
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_release);
+    return AGNI_OK;
+}
+
+// Sequence number of the slot at ring position pos
+static inline uint64_t load_seq(const AgniTaskRing* ring, uint64_t pos) {
+    return ring->slots[pos & ring->mask].seq.load(std::memory_order_acquire) + (pos & ring->mask);
+}
+
+static inline void store_seq(AgniTaskRing* ring, uint64_t pos, uint64_t seq) {
+    ring->slots[pos & ring->mask].seq.store(seq - (pos & ring->mask), std::memory_order_release);
+}
+
+// Claims count consecutive positions. The consumer releases slots in
+// order, so if the last one is free for this lap, so are the others.
+static bool claim(AgniTaskRing* ring, uint32_t count, uint64_t* pos) {
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t last = tail + count - 1;
+        int64_t diff = (int64_t)(load_seq(ring, last) - last);
+        if (diff < 0) {
+            return false;  // Still holds a task from the previous lap
+        }
+        if (diff > 0) {
+            tail = ring->tail.load(std::memory_order_relaxed);  // Another producer got there first
+            continue;
+        }
+        if (!ring->multi_producer) {
+            ring->tail.store(tail + count, std::memory_order_relaxed);
+            break;
+        }
+        if (ring->tail.compare_exchange_weak(tail, tail + count, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    *pos = tail;
+    return true;
+}
+
+int agni_task_ring_push_batch(AgniTaskRing* ring, const Task* tasks, uint32_t count) {
+    if (!ring || !tasks) return AGNI_ERROR_NULL_POINTER;
+    if (count == 0) return AGNI_OK;
+    if (count > ring->mask + 1) return AGNI_ERROR_INVALID_INPUT;
+
+    uint64_t pos;
+    if (!claim(ring, count, &pos)) return AGNI_ERROR_QUEUE_FULL;
+    for (uint32_t i = 0; i < count; i++) {
+        ring->slots[(pos + i) & ring->mask].task = tasks[i];
+        store_seq(ring, pos + i, pos + i + 1);
+    }
+    return AGNI_OK;
+}
+
+int agni_task_ring_push(AgniTaskRing* ring, const Task* task) {
+    return agni_task_ring_push_batch(ring, task, 1);
+}
+
+uint32_t agni_task_ring_pop_batch(AgniTaskRing* ring, Task* tasks, uint32_t max) {
+    if (!ring || !tasks) return 0;
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t n = 0;
+    for (; n < max; n++) {
+        if (load_seq(ring, head + n) != head + n + 1) break;
+        tasks[n] = ring->slots[(head + n) & ring->mask].task;
+        store_seq(ring, head + n, head + n + ring->mask + 1);
+    }
+    ring->head.store(head + n, std::memory_order_relaxed);
+    return n;
+}
+
+bool agni_task_ring_pop(AgniTaskRing* ring, Task* task) {
+    return agni_task_ring_pop_batch(ring, task, 1) == 1;
+}
+
+bool agni_task_ring_empty(const AgniTaskRing* ring) {
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    return load_seq(ring, head) != head + 1;
+}
+
+uint32_t agni_task_ring_size(const AgniTaskRing* ring) {
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    return (tail > head) ? (uint32_t)MIN(tail - head, ring->mask + 1) : 0;
+}
+
+uint32_t agni_task_ring_capacity(const AgniTaskRing* ring) {
+    return (uint32_t)(ring->mask + 1);
+}
@@ -0,0 +1,67 @@
+#ifndef AGNI_TASK_RING_H
+#define AGNI_TASK_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <atomic>
+
+#include "agni_scheduler_hw.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCK-FREE TASK RING
+// Bounded ring of Tasks with one consumer (the Foreman loop) and one or
+// many producers (host threads, IRQ handlers). Every slot carries a
+// sequence number: for ring position p it reads p while the slot is free
+// and p + 1 once a task is published; the consumer hands it back as
+// p + capacity; slots store it less their index, so a zeroed slot array
+// is an empty ring. Producers claim positions with a CAS on tail (a plain
+// store in single-producer mode), so a producer preempted between claim
+// and publish only holds the consumer back at that slot. tail, head and
+// the read-only fields each sit on their own cache line. The caller owns
+// the slot array, sized to the ring's capacity.
+////////////////////////////////////////////////////////////////////////////////
+
+#define AGNI_CACHE_LINE_BYTES   64
+
+typedef struct {
+    std::atomic<uint64_t> seq;
+    Task task;
+} AgniTaskSlot;
+
+typedef struct {
+    alignas(AGNI_CACHE_LINE_BYTES) std::atomic<uint64_t> tail;    // Next position to claim
+    alignas(AGNI_CACHE_LINE_BYTES) std::atomic<uint64_t> head;    // Next position to consume
+    alignas(AGNI_CACHE_LINE_BYTES) uint64_t mask;
+    bool multi_producer;
+    AgniTaskSlot* slots;                                            // capacity entries
+} AgniTaskRing;
+
+// Constant initializer for a ring at namespace scope over a zeroed slot
+// array (static storage); capacity must be a power of two. Needs no
+// agni_task_ring_init and no guarded first use.
+#define AGNI_TASK_RING_INITIALIZER(slots, capacity, multi_producer) \
+    { {0}, {0}, (uint64_t)(capacity) - 1, (multi_producer), (slots) }
+
+// slots must hold capacity entries and outlive the ring. Returns AGNI_OK,
+// or AGNI_ERROR_INVALID_INPUT unless capacity is a power of two. Not
+// thread-safe.
+int agni_task_ring_init(AgniTaskRing* ring, AgniTaskSlot* slots, uint32_t capacity, bool multi_producer);
+
+// Producers. A batch is queued whole and in order, or not at all: both
+// return AGNI_ERROR_QUEUE_FULL when there is no room.
+int agni_task_ring_push(AgniTaskRing* ring, const Task* task);
+int agni_task_ring_push_batch(AgniTaskRing* ring, const Task* tasks, uint32_t count);
+
+// Consumer only. pop_batch takes up to max tasks and returns how many.
+bool agni_task_ring_pop(AgniTaskRing* ring, Task* task);
+uint32_t agni_task_ring_pop_batch(AgniTaskRing* ring, Task* tasks, uint32_t max);
+
+// Consumer only: no published task at the head
+bool agni_task_ring_empty(const AgniTaskRing* ring);
+
+// Claimed but not yet consumed, including tasks still being published;
+// a snapshot from any thread
+uint32_t agni_task_ring_size(const AgniTaskRing* ring);
+uint32_t agni_task_ring_capacity(const AgniTaskRing* ring);
+
+#endif // AGNI_TASK_RING_H
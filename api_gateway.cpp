@@ -1,13 +1,224 @@
 #include "api_gateway.h"
+#include "http_server.h"
+#include "json_codec.h"
 #include "common.h"
-#include <sstream>
 #include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ============================================================================
+// RESPONSE HELPERS
+// ============================================================================
+static void set_error(APIResponse& resp, int status_code, const char* message) {
+    resp.status_code = status_code;
+    resp.body.clear();
+    JsonWriter(resp.body).begin_object().key("error").string_value(message).end_object();
+}
+
+static std::string status_json(uint32_t job_id, JobStatus status) {
+    std::string body;
+    JsonWriter(body).begin_object()
+        .key("job_id").uint_value(job_id)
+        .key("status").int_value((int)status)
+        .end_object();
+    return body;
+}
+
+// ============================================================================
+// UPLOAD SINK
+// ============================================================================
+// Writes an upload body to API_UPLOAD_DIR/agni_upload_<id>_<random>.bin
+// as it arrives. mkostemps creates the file exclusively under a name no
+// other user can predict, so a planted file or symlink is never written
+// through. The file is removed again unless the upload completes.
+static const int UPLOAD_SUFFIX_LEN = 4;    // ".bin"
+
+class UploadFileSink : public RequestBodySink {
+public:
+    explicit UploadFileSink(uint32_t id) : finished(false) {
+        snprintf(path, sizeof(path), "%s/agni_upload_%u_XXXXXX.bin", API_UPLOAD_DIR, id);
+        fd = mkostemps(path, UPLOAD_SUFFIX_LEN, O_CLOEXEC);
+        created = (fd >= 0);
+        if (fd < 0) LOG_ERROR("Cannot create upload file %s: %s", path, strerror(errno));
+    }
+
+    ~UploadFileSink() {
+        if (fd >= 0) close(fd);
+        if (created && !finished) unlink(path);
+    }
+
+    bool write(const char* data, size_t len) {
+        if (fd < 0) return false;
+        while (len > 0) {
+            ssize_t n = ::write(fd, data, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR("Upload write failed: %s", strerror(errno));
+                return false;
+            }
+            data += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    APIResponse finish(const APIRequest&, uint64_t body_bytes) {
+        APIResponse resp;
+        resp.headers["Content-Type"] = "application/json";
+        if (fd < 0 || close(fd) != 0) {
+            fd = -1;
+            set_error(resp, 500, "Failed to store upload");
+            return resp;
+        }
+        fd = -1;
+        finished = true;
+
+        // "file_<id>_<random>", naming the file it was stored in
+        const char* name = strrchr(path, '/') + sizeof("/agni_upload_") - 1;
+        char file_id[64];
+        int n = snprintf(file_id, sizeof(file_id), "file_%.*s", (int)(strlen(name) - UPLOAD_SUFFIX_LEN), name);
+        JsonWriter json(resp.body);
+        json.begin_object()
+            .key("file_upload_id").string_value(file_id, (size_t)n)
+            .key("size_mb").double_value(body_bytes / (1024.0 * 1024.0))
+            .key("status").string_value("UPLOADED")
+            .end_object();
+        LOG_INFO("File uploaded: %llu bytes", (unsigned long long)body_bytes);
+        return resp;
+    }
+
+private:
+    int fd;
+    bool created;
+    bool finished;
+    char path[256];
+};
+
+// ============================================================================
+// QUERY AND BODY PARSING
+// ============================================================================
+// Top-level fields of a /v59/axiom body. Nested values are skipped.
+class AxiomRequestFields : public JsonHandler {
+public:
+    bool is_object;
+    bool has_prompt;
+    std::string prompt;
+
+    AxiomRequestFields() : is_object(false), has_prompt(false), depth(0), at_prompt(false) {}
+
+    bool on_begin_object() { return enter(true); }
+    bool on_begin_array() { return enter(false); }
+    bool on_end_object() { depth--; return true; }
+    bool on_end_array() { depth--; return true; }
+
+    bool on_key(const char* s, size_t len) {
+        at_prompt = (depth == 1 && len == 6 && memcmp(s, "prompt", 6) == 0);
+        return true;
+    }
+
+    bool on_string(const char* s, size_t len) {
+        if (take_value()) {
+            prompt.assign(s, len);
+            has_prompt = true;
+        }
+        return true;
+    }
+
+    bool on_number(double) { take_value(); return true; }
+    bool on_bool(bool) { take_value(); return true; }
+    bool on_null() { take_value(); return true; }
+
+private:
+    int depth;
+    bool at_prompt;     // The next value belongs to the top-level "prompt" key
+
+    bool enter(bool object) {
+        take_value();
+        if (depth == 0) is_object = object;
+        depth++;
+        return true;
+    }
+
+    bool take_value() {
+        bool was = at_prompt && depth == 1;
+        at_prompt = false;
+        return was;
+    }
+};
+
+// Value of ?wait_ms=N, capped at API_STATUS_MAX_WAIT_MS; 0 when absent
+static uint32_t parse_wait_ms(const std::string& query) {
+    std::string padded = "&" + query;
+    size_t pos = padded.find("&wait_ms=");
+    if (pos == std::string::npos) return 0;
+    unsigned long ms = strtoul(padded.c_str() + pos + 9, nullptr, 10);
+    return (uint32_t)MIN(ms, (unsigned long)API_STATUS_MAX_WAIT_MS);
+}
+
+// ============================================================================
+// SERVER-SENT EVENTS
+// ============================================================================
+// True when the client asked for /v59/axiom output as an event stream
+static bool wants_event_stream(const APIRequest& req) {
+    std::map<std::string, std::string>::const_iterator accept = req.headers.find("accept");
+    if (accept != req.headers.end() && accept->second.find("text/event-stream") != std::string::npos) {
+        return true;
+    }
+    std::string query = "&" + req.query + "&";
+    return query.find("&stream=1&") != std::string::npos ||
+           query.find("&stream=true&") != std::string::npos;
+}
+
+// One SSE event; every line of data gets its own "data:" field
+static std::string sse_event(const char* event, const std::string& data) {
+    std::string out = "event: ";
+    out += event;
+    out += "\n";
+    size_t begin = 0;
+    while (true) {
+        size_t end = data.find('\n', begin);
+        out += "data: ";
+        out.append(data, begin, (end == std::string::npos ? data.size() : end) - begin);
+        out += "\n";
+        if (end == std::string::npos) break;
+        begin = end + 1;
+    }
+    out += "\n";
+    return out;
+}
+
+// Forward a job's events to the client: a "token" event per token, a
+// "status" event per transition, and "done" before the stream ends.
+static void stream_job(Scheduler* scheduler, uint32_t job_id, const ResponseChannelRef& channel) {
+    std::string queued;
+    JsonWriter(queued).begin_object().key("job_uuid").uint_value(job_id).end_object();
+    channel->send(sse_event("queued", queued));
+
+    bool known = scheduler->subscribe_job(job_id,
+        [channel](const Job& job, JobEventType type, const std::string& text) {
+            if (type == JOB_EVENT_TOKEN) {
+                channel->send(sse_event("token", text));
+                return channel->is_open();
+            }
+            std::string status = status_json(job.job_id, job.status);
+            channel->send(sse_event("status", status));
+            if (job.status == STATUS_COMPLETE || job.status == STATUS_ERROR) {
+                channel->finish_with(sse_event("done", status));
+            }
+            return channel->is_open();      // Client gone: stop listening
+        });
+    if (!known) {
+        channel->send(sse_event("error", "{\"error\": \"Job not found\"}"));
+        channel->finish();
+    }
+}
 
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 APIGateway::APIGateway(Scheduler* sched)
-    : scheduler(sched), server_running(false) {
+    : scheduler(sched), server_running(false), upload_counter(0) {
     LOG_INFO("API Gateway initialized");
 }
 
@@ -30,8 +241,7 @@ APIResponse APIGateway::handle_request(const APIRequest& req) {
 
     // BUG FIX: Add null pointer check
     if (!scheduler) {
-        resp.status_code = 500;
-        resp.body = "{\"error\": \"Scheduler not initialized\"}";
+        set_error(resp, 500, "Scheduler not initialized");
         return resp;
     }
 
@@ -47,8 +257,7 @@ APIResponse APIGateway::handle_request(const APIRequest& req) {
     }
 
     // 404 Not Found
-    resp.status_code = 404;
-    resp.body = "{\"error\": \"Endpoint not found\"}";
+    set_error(resp, 404, "Endpoint not found");
     return resp;
 }
 
@@ -61,24 +270,46 @@ APIResponse APIGateway::handle_axiom(const APIRequest& req) {
 
     // BUG FIX: Proper error handling for null scheduler
     if (!scheduler) {
-        resp.status_code = 500;
-        resp.body = "{\"error\": \"Scheduler unavailable\"}";
+        set_error(resp, 500, "Scheduler unavailable");
         return resp;
     }
 
-    // Parse prompt from request body (simplified JSON parsing)
+    // Parse {"prompt": "..."} from the request body
     std::string job_id_str = "WEAPON_AXIOM_001";
-    std::string prompt = req.body;
+    AxiomRequestFields fields;
+    JsonReader reader;
+    if (reader.parse(req.body, fields) != JSON_OK || !fields.is_object) {
+        set_error(resp, 400, "Request body must be a JSON object");
+        return resp;
+    }
+    if (!fields.has_prompt) {
+        set_error(resp, 400, "Missing string field: prompt");
+        return resp;
+    }
 
     // Submit job to scheduler
-    uint32_t job_id = scheduler->submit_job(job_id_str, prompt, 0);
+    uint32_t job_id = scheduler->submit_job(job_id_str, std::move(fields.prompt), 0);
+
+    // Streaming mode: push tokens as they are produced, no polling
+    if (wants_event_stream(req)) {
+        Scheduler* sched = scheduler;
+        resp.headers["Content-Type"] = "text/event-stream";
+        resp.headers["Cache-Control"] = "no-cache";
+        resp.stream = [sched, job_id](const ResponseChannelRef& channel) {
+            stream_job(sched, job_id, channel);
+        };
+        LOG_INFO("Axiom job submitted (streaming): %u", job_id);
+        return resp;
+    }
 
     // Build JSON response
-    std::stringstream ss;
-    ss << "{\"job_uuid\": " << job_id << ", \"status\": \"QUEUED\", "
-       << "\"endpoint\": \"/v59/status/" << job_id << "\"}";
-
-    resp.body = ss.str();
+    char endpoint[32];
+    int n = snprintf(endpoint, sizeof(endpoint), "/v59/status/%u", job_id);
+    JsonWriter(resp.body).begin_object()
+        .key("job_uuid").uint_value(job_id)
+        .key("status").string_value("QUEUED")
+        .key("endpoint").string_value(endpoint, (size_t)n)
+        .end_object();
     LOG_INFO("Axiom job submitted: %u", job_id);
 
     return resp;
@@ -93,24 +324,21 @@ APIResponse APIGateway::handle_upload(const APIRequest& req) {
 
     // BUG FIX: Validate request size
     if (req.body.size() > API_MAX_UPLOAD_SIZE) {
-        resp.status_code = 413;  // Payload Too Large
-        resp.body = "{\"error\": \"File size exceeds limit\"}";
+        set_error(resp, 413, "File size exceeds limit");  // Payload Too Large
         return resp;
     }
 
-    // Generate upload ID
-    static uint32_t upload_counter = 0;
-    upload_counter++;
-
-    std::stringstream ss;
-    ss << "{\"file_upload_id\": \"file_" << upload_counter << "\", "
-       << "\"size_mb\": " << (req.body.size() / (1024.0 * 1024.0)) << ", "
-       << "\"status\": \"UPLOADED\"}";
-
-    resp.body = ss.str();
-    LOG_INFO("File uploaded: %zu bytes", req.body.size());
+    // Buffered path (direct calls); the HTTP server streams instead
+    std::unique_ptr<RequestBodySink> sink(open_upload_sink());
+    if (!sink->write(req.body.data(), req.body.size())) {
+        set_error(resp, 500, "Failed to store upload");
+        return resp;
+    }
+    return sink->finish(req, req.body.size());
+}
 
-    return resp;
+RequestBodySink* APIGateway::open_upload_sink() {
+    return new UploadFileSink(++upload_counter);
 }
 
 // ============================================================================
@@ -122,8 +350,7 @@ APIResponse APIGateway::handle_status(const APIRequest& req) {
 
     // BUG FIX: Proper null checks
     if (!scheduler) {
-        resp.status_code = 500;
-        resp.body = "{\"error\": \"Scheduler unavailable\"}";
+        set_error(resp, 500, "Scheduler unavailable");
         return resp;
     }
 
@@ -132,8 +359,7 @@ APIResponse APIGateway::handle_status(const APIRequest& req) {
     std::string prefix = "/v59/status/";
 
     if (endpoint.find(prefix) != 0) {
-        resp.status_code = 400;
-        resp.body = "{\"error\": \"Invalid status endpoint format\"}";
+        set_error(resp, 400, "Invalid status endpoint format");
         return resp;
     }
 
@@ -142,18 +368,37 @@ APIResponse APIGateway::handle_status(const APIRequest& req) {
         std::string job_id_str = endpoint.substr(prefix.length());
         job_id = std::stoul(job_id_str);
     } catch (...) {
-        resp.status_code = 400;
-        resp.body = "{\"error\": \"Invalid job_id\"}";
+        set_error(resp, 400, "Invalid job_id");
         return resp;
     }
 
     // Poll scheduler
     JobStatus status = scheduler->poll_job(job_id);
+    uint32_t wait_ms = parse_wait_ms(req.query);
+
+    // Long-poll: answer when the job leaves `status` or wait_ms expires.
+    // The job's listener completes the response; nothing blocks meanwhile.
+    if (wait_ms > 0 && status != STATUS_COMPLETE && status != STATUS_ERROR) {
+        Scheduler* sched = scheduler;
+        resp.stream_buffered = true;
+        resp.stream_timeout_ms = wait_ms;
+        resp.stream = [sched, job_id, status](const ResponseChannelRef& channel) {
+            bool known = sched->subscribe_job(job_id,
+                [channel, status](const Job& job, JobEventType type, const std::string&) {
+                    if (type == JOB_EVENT_STATUS && job.status != status) {
+                        channel->finish_with(status_json(job.job_id, job.status));
+                    }
+                    return channel->is_open();
+                });
+            if (!known) channel->finish_with(status_json(job_id, STATUS_ERROR));
+        };
+        resp.on_stream_timeout = [sched, job_id](const ResponseChannelRef& channel) {
+            channel->finish_with(status_json(job_id, sched->poll_job(job_id)));
+        };
+        return resp;
+    }
 
-    std::stringstream ss;
-    ss << "{\"job_id\": " << job_id << ", \"status\": " << (int)status << "}";
-    resp.body = ss.str();
-
+    resp.body = status_json(job_id, status);
     return resp;
 }
 
@@ -167,16 +412,18 @@ APIResponse APIGateway::handle_health(const APIRequest& req) {
     // BUG FIX: Add scheduler health check
     if (!scheduler) {
         resp.status_code = 503;
-        resp.body = "{\"status\": \"unhealthy\", \"error\": \"Scheduler unavailable\"}";
+        JsonWriter(resp.body).begin_object()
+            .key("status").string_value("unhealthy")
+            .key("error").string_value("Scheduler unavailable")
+            .end_object();
         return resp;
     }
 
-    std::stringstream ss;
-    ss << "{\"status\": \"healthy\", "
-       << "\"queue_size\": " << scheduler->get_queue_size() << ", "
-       << "\"uptime_s\": 0}";
-
-    resp.body = ss.str();
+    JsonWriter(resp.body).begin_object()
+        .key("status").string_value("healthy")
+        .key("queue_size").uint_value(scheduler->get_queue_size())
+        .key("uptime_s").uint_value(0)
+        .end_object();
     return resp;
 }
 
@@ -184,11 +431,40 @@ APIResponse APIGateway::handle_health(const APIRequest& req) {
 // SERVER LIFECYCLE
 // ============================================================================
 void APIGateway::start_server(int port) {
+    if (server_running) return;
+
+    HttpServerConfig config;
+    config.port = port;
+    http_server.reset(new HttpServer(config,
+        [this](const APIRequest& req) {
+            return handle_request(req);
+        },
+        // Uploads bypass body buffering and stream to disk
+        [this](const APIRequest& head) -> RequestBodySink* {
+            if (scheduler && head.method == "POST" && head.endpoint == "/v59/upload") {
+                return open_upload_sink();
+            }
+            return nullptr;
+        }));
+    if (!http_server->start()) {
+        http_server.reset();
+        LOG_ERROR("API Gateway failed to start on port %d", port);
+        return;
+    }
+
     server_running = true;
-    LOG_INFO("API Gateway listening on port %d", port);
+    LOG_INFO("API Gateway listening on port %d", http_server->get_port());
 }
 
 void APIGateway::stop_server() {
+    if (http_server) {
+        http_server->stop();
+        http_server.reset();
+    }
     server_running = false;
     LOG_INFO("API Gateway stopped");
+}
+
+int APIGateway::get_server_port() const {
+    return http_server ? http_server->get_port() : 0;
 }
\ No newline at end of file
@@ -3,18 +3,52 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <functional>
 #include "scheduler.h"
 
+class HttpServer;
+class RequestBodySink;
+
 // ============================================================================
 // HTTP REQUEST STRUCTURE
 // ============================================================================
 struct APIRequest {
     std::string method;
-    std::string endpoint;
+    std::string endpoint;       // Path only
     std::string body;
-    std::map<std::string, std::string> headers;
+    std::map<std::string, std::string> headers;   // Lowercase names when parsed by HttpServer
+    std::string query;          // Text after '?', without the '?'
 };
 
+// ============================================================================
+// RESPONSE CHANNEL
+// Carries a response body that is produced after the handler returned.
+// Usable from any thread, one thread at a time; calls after finish() or
+// after the client went away are ignored.
+// ============================================================================
+class ResponseChannel {
+public:
+    virtual ~ResponseChannel() {}
+
+    // Append data to the body; sent to the client right away
+    virtual void send(const std::string& data) = 0;
+
+    // Append `data` and complete the body in one step. Only the first
+    // completing call has any effect, so racing producers (a long-poll's
+    // notification and its timeout) need no coordination.
+    virtual void finish_with(const std::string& data) = 0;
+
+    // Body complete
+    void finish() { finish_with(std::string()); }
+
+    // False once finished or the connection is closed
+    virtual bool is_open() const = 0;
+};
+
+typedef std::shared_ptr<ResponseChannel> ResponseChannelRef;
+
 // ============================================================================
 // HTTP RESPONSE STRUCTURE
 // ============================================================================
@@ -23,8 +57,22 @@ struct APIResponse {
     std::string body;
     std::map<std::string, std::string> headers;
 
+    // Streamed body. When set, `body` is ignored: the server sends the head
+    // with chunked transfer coding, then hands this callback the channel
+    // the body is written to.
+    std::function<void(const ResponseChannelRef&)> stream;
+
+    // With `stream`: hold the head and send the collected body with a
+    // Content-Length once the channel finishes (long-poll answers)
+    bool stream_buffered;
+
+    // With `stream`: if the channel is still open after this many ms,
+    // on_stream_timeout runs on the I/O thread and should finish it
+    uint32_t stream_timeout_ms;
+    std::function<void(const ResponseChannelRef&)> on_stream_timeout;
+
     // Constructor
-    APIResponse() : status_code(200) {}
+    APIResponse() : status_code(200), stream_buffered(false), stream_timeout_ms(0) {}
 };
 
 // ============================================================================
@@ -39,19 +87,27 @@ public:
     // Handle incoming HTTP request
     APIResponse handle_request(const APIRequest& req);
 
-    // Server lifecycle
+    // Server lifecycle. Port 0 binds an ephemeral port.
     void start_server(int port);
     void stop_server();
 
+    // Port the HTTP server is bound to, or 0 when not running
+    int get_server_port() const;
+
 private:
     Scheduler* scheduler;
     bool server_running;
+    std::unique_ptr<HttpServer> http_server;
+    std::atomic<uint32_t> upload_counter;
 
     // Endpoint handlers
     APIResponse handle_axiom(const APIRequest& req);
     APIResponse handle_upload(const APIRequest& req);
     APIResponse handle_status(const APIRequest& req);
     APIResponse handle_health(const APIRequest& req);
+
+    // Streaming sink that writes an upload body straight to a file
+    RequestBodySink* open_upload_sink();
 };
 
 #endif // AGNI_API_GATEWAY_H
\ No newline at end of file
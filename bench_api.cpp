@@ -0,0 +1,373 @@
+// ============================================================================
+// API GATEWAY BENCHMARK
+// Loopback load generator against the epoll HTTP server: closed-loop
+// keep-alive clients, optional pipelining, requests/sec and latency
+// percentiles; peak-RSS growth for a large streamed upload; and
+// time-to-first-token and status traffic for streamed /v59/axiom against
+// submit-then-poll and long-polling /v59/status.
+// ============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api_gateway.h"
+#include "http_server.h"
+#include "scheduler.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const int BENCH_DURATION_MS = 2000;
+static const int CLIENT_THREADS    = 2;
+
+struct ClientConn {
+    int fd;
+    std::string in;
+    std::deque<Clock::time_point> in_flight;
+};
+
+static int connect_loopback(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+static void send_requests(ClientConn& c, const std::string& request, int count) {
+    std::string batch;
+    for (int i = 0; i < count; ++i) batch += request;
+    ssize_t n = write(c.fd, batch.data(), batch.size());
+    (void)n;  // Small requests on a fresh socket buffer; short writes not expected
+    Clock::time_point now = Clock::now();
+    for (int i = 0; i < count; ++i) c.in_flight.push_back(now);
+}
+
+// Consume complete responses from c.in; returns how many were parsed
+static int consume_responses(ClientConn& c, std::vector<double>& latencies_us) {
+    int parsed = 0;
+    size_t offset = 0;
+    while (true) {
+        size_t head_end = c.in.find("\r\n\r\n", offset);
+        if (head_end == std::string::npos) break;
+        size_t cl = c.in.find("Content-Length: ", offset);
+        if (cl == std::string::npos || cl > head_end) break;
+        size_t body_len = (size_t)atol(c.in.c_str() + cl + 16);
+        if (c.in.size() < head_end + 4 + body_len) break;
+
+        offset = head_end + 4 + body_len;
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(
+            Clock::now() - c.in_flight.front()).count());
+        c.in_flight.pop_front();
+        parsed++;
+    }
+    c.in.erase(0, offset);
+    return parsed;
+}
+
+static void client_thread(int port, int connections, int depth, const std::string& request,
+                          Clock::time_point deadline, std::vector<double>* latencies_us) {
+    int epfd = epoll_create1(0);
+    std::vector<ClientConn> conns(connections);
+    for (int i = 0; i < connections; ++i) {
+        conns[i].fd = connect_loopback(port);
+        if (conns[i].fd < 0) {
+            fprintf(stderr, "connect failed: %s\n", strerror(errno));
+            exit(1);
+        }
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = &conns[i];
+        epoll_ctl(epfd, EPOLL_CTL_ADD, conns[i].fd, &ev);
+    }
+    for (int i = 0; i < connections; ++i) send_requests(conns[i], request, depth);
+
+    struct epoll_event events[256];
+    char buffer[16384];
+    while (Clock::now() < deadline) {
+        int n = epoll_wait(epfd, events, 256, 10);
+        for (int i = 0; i < n; ++i) {
+            ClientConn& c = *(ClientConn*)events[i].data.ptr;
+            ssize_t r = read(c.fd, buffer, sizeof(buffer));
+            if (r <= 0) continue;
+            c.in.append(buffer, (size_t)r);
+            int done = consume_responses(c, *latencies_us);
+            if (done > 0 && Clock::now() < deadline) send_requests(c, request, done);
+        }
+    }
+
+    for (int i = 0; i < connections; ++i) close(conns[i].fd);
+    close(epfd);
+}
+
+static double percentile(std::vector<double>& v, double pct) {
+    if (v.empty()) return 0.0;
+    size_t idx = (size_t)(pct / 100.0 * (double)(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+static void run_load(HttpServer& server, int connections, int depth, const char* label) {
+    const std::string request = "GET /v59/health HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    Clock::time_point t0 = Clock::now();
+    Clock::time_point deadline = t0 + std::chrono::milliseconds(BENCH_DURATION_MS);
+
+    std::vector<std::vector<double> > latencies(CLIENT_THREADS);
+    std::vector<std::thread> clients;
+    for (int t = 0; t < CLIENT_THREADS; ++t) {
+        clients.push_back(std::thread(client_thread, server.get_port(), connections / CLIENT_THREADS,
+                                      depth, request, deadline, &latencies[t]));
+    }
+    for (size_t t = 0; t < clients.size(); ++t) clients[t].join();
+
+    std::vector<double> all;
+    for (size_t t = 0; t < latencies.size(); ++t) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    double p50 = percentile(all, 50.0);
+    double p99 = percentile(all, 99.0);
+    printf("  %-24s %6d conns  depth %2d  %10.0f req/s  p50 %8.1f us  p99 %8.1f us\n",
+           label, connections, depth, all.size() / secs, p50, p99);
+}
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Stream a large chunked upload and report how far peak RSS moved. Runs
+// first, before the load tests raise the peak.
+static void run_upload(APIGateway& gateway) {
+    static const size_t UPLOAD_BYTES = 48 * 1024 * 1024;
+    static const size_t CHUNK = 256 * 1024;
+
+    gateway.start_server(0);
+    int fd = connect_loopback(gateway.get_server_port());
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    long rss_before = peak_rss_kb();
+    Clock::time_point t0 = Clock::now();
+
+    std::string head = "POST /v59/upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    ssize_t n = write(fd, head.data(), head.size());
+    std::string chunk(CHUNK, 'x');
+    char size_line[32];
+    snprintf(size_line, sizeof(size_line), "%zx\r\n", CHUNK);
+    chunk.insert(0, size_line);
+    chunk += "\r\n";
+    for (size_t sent = 0; sent < UPLOAD_BYTES; sent += CHUNK) {
+        for (size_t off = 0; off < chunk.size(); off += (size_t)n) {
+            n = write(fd, chunk.data() + off, chunk.size() - off);
+            if (n <= 0) exit(1);
+        }
+    }
+    n = write(fd, "0\r\n\r\n", 5);
+
+    std::string response;
+    char buffer[4096];
+    while (response.find("UPLOADED") == std::string::npos && (n = read(fd, buffer, sizeof(buffer))) > 0) {
+        response.append(buffer, (size_t)n);
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    close(fd);
+    gateway.stop_server();
+
+    size_t id = response.find(": \"file_");
+    size_t id_end = (id != std::string::npos) ? response.find('"', id + 8) : std::string::npos;
+    if (id_end != std::string::npos) {
+        std::string path = std::string(API_UPLOAD_DIR) + "/agni_upload_" +
+                           response.substr(id + 8, id_end - id - 8) + ".bin";
+        remove(path.c_str());
+    }
+    printf("  chunked upload %zu MB: %.0f MB/s, peak RSS +%ld KB\n",
+           UPLOAD_BYTES >> 20, (UPLOAD_BYTES >> 20) / secs, peak_rss_kb() - rss_before);
+}
+
+// Blocking read of one Content-Length response; returns its body
+static std::string read_response(int fd, std::string& in) {
+    char buffer[4096];
+    while (true) {
+        size_t head_end = in.find("\r\n\r\n");
+        if (head_end != std::string::npos) {
+            size_t cl = in.find("Content-Length: ");
+            size_t body_len = (cl < head_end) ? (size_t)atol(in.c_str() + cl + 16) : 0;
+            if (in.size() >= head_end + 4 + body_len) {
+                std::string body = in.substr(head_end + 4, body_len);
+                in.erase(0, head_end + 4 + body_len);
+                return body;
+            }
+        }
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) exit(1);
+        in.append(buffer, (size_t)n);
+    }
+}
+
+struct TokenTiming {
+    std::vector<double> first_ms;       // Submit to first visible output
+    std::vector<double> done_ms;        // Submit to final result
+    uint64_t requests;
+    TokenTiming() : requests(0) {}
+};
+
+static const int FTT_CLIENTS = 8;
+static const int FTT_JOBS_PER_CLIENT = 10;
+static const int FTT_POLL_INTERVAL_US = 1000;
+
+static void stream_client(int port, TokenTiming* timing) {
+    int fd = connect_loopback(port);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    const std::string request = "POST /v59/axiom?stream=1 HTTP/1.1\r\nContent-Length: 15\r\n\r\n{\"prompt\": \"x\"}";
+    char buffer[4096];
+
+    for (int j = 0; j < FTT_JOBS_PER_CLIENT; ++j) {
+        Clock::time_point t0 = Clock::now();
+        ssize_t n = write(fd, request.data(), request.size());
+        std::string in;
+        bool seen_token = false;
+        while (in.find("\r\n0\r\n\r\n") == std::string::npos) {
+            n = read(fd, buffer, sizeof(buffer));
+            if (n <= 0) exit(1);
+            in.append(buffer, (size_t)n);
+            if (!seen_token && in.find("event: token") != std::string::npos) {
+                seen_token = true;
+                timing->first_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+            }
+        }
+        timing->done_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        timing->requests++;
+    }
+    close(fd);
+}
+
+enum ResultMode { RESULT_POLL, RESULT_LONG_POLL, RESULT_STREAM };
+
+// long_poll: each status request waits server-side for the next change
+static void poll_client(int port, TokenTiming* timing, bool long_poll) {
+    int fd = connect_loopback(port);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    const std::string request = "POST /v59/axiom HTTP/1.1\r\nContent-Length: 15\r\n\r\n{\"prompt\": \"x\"}";
+    std::string in;
+    ssize_t n = 0;
+
+    for (int j = 0; j < FTT_JOBS_PER_CLIENT; ++j) {
+        Clock::time_point t0 = Clock::now();
+        n = write(fd, request.data(), request.size());
+        std::string body = read_response(fd, in);
+        timing->requests++;
+        std::string status_request = "GET /v59/status/" +
+            std::to_string(atoi(body.c_str() + body.find(": ") + 2)) +
+            (long_poll ? "?wait_ms=5000" : "") + " HTTP/1.1\r\n\r\n";
+
+        // The result only becomes visible once the job is complete
+        while (true) {
+            n = write(fd, status_request.data(), status_request.size());
+            body = read_response(fd, in);
+            timing->requests++;
+            if (body.find("\"status\": 2") != std::string::npos) break;
+            if (!long_poll) std::this_thread::sleep_for(std::chrono::microseconds(FTT_POLL_INTERVAL_US));
+        }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        timing->first_ms.push_back(ms);
+        timing->done_ms.push_back(ms);
+    }
+    (void)n;    // Requests are small; short writes not expected
+    close(fd);
+}
+
+static void run_first_token(ResultMode mode) {
+    SchedulerConfig config;
+    config.simulated_work_us = 30000;
+    Scheduler scheduler(config);
+    scheduler.start();
+    APIGateway gateway(&scheduler);
+    gateway.start_server(0);
+
+    std::vector<TokenTiming> timings(FTT_CLIENTS);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < FTT_CLIENTS; ++c) {
+        if (mode == RESULT_STREAM) {
+            clients.push_back(std::thread(stream_client, gateway.get_server_port(), &timings[c]));
+        } else {
+            clients.push_back(std::thread(poll_client, gateway.get_server_port(), &timings[c],
+                                          mode == RESULT_LONG_POLL));
+        }
+    }
+    for (size_t c = 0; c < clients.size(); ++c) clients[c].join();
+    gateway.stop_server();
+    scheduler.stop();
+
+    TokenTiming all;
+    for (size_t c = 0; c < timings.size(); ++c) {
+        all.first_ms.insert(all.first_ms.end(), timings[c].first_ms.begin(), timings[c].first_ms.end());
+        all.done_ms.insert(all.done_ms.end(), timings[c].done_ms.begin(), timings[c].done_ms.end());
+        all.requests += timings[c].requests;
+    }
+    size_t jobs = all.done_ms.size();
+    const char* label = mode == RESULT_STREAM    ? "axiom stream (SSE)"
+                      : mode == RESULT_LONG_POLL ? "axiom + status long-poll"
+                                                 : "axiom + status polling";
+    printf("  %-24s first token p50 %6.1f ms  p99 %6.1f ms  result p50 %6.1f ms  %5.1f requests/job\n",
+           label,
+           percentile(all.first_ms, 50.0), percentile(all.first_ms, 99.0),
+           percentile(all.done_ms, 50.0), (double)all.requests / (double)jobs);
+}
+
+int main() {
+    Scheduler scheduler;
+    APIGateway gateway(&scheduler);
+
+    HttpServerConfig config;
+    config.port = 0;
+    config.max_connections = 4096;
+    HttpServer server(config, [&gateway](const APIRequest& req) {
+        return gateway.handle_request(req);
+    });
+    if (!server.start()) return 1;
+
+    printf("====================================================================\n");
+    printf("API GATEWAY BENCHMARK: GET /v59/health, %zu I/O threads, %d client threads\n",
+           config.io_threads, CLIENT_THREADS);
+    printf("====================================================================\n");
+    run_upload(gateway);
+    run_first_token(RESULT_POLL);
+    run_first_token(RESULT_LONG_POLL);
+    run_first_token(RESULT_STREAM);
+    run_load(server, 1000, 1, "keep-alive");
+    run_load(server, 100, 8, "keep-alive + pipelining");
+
+    HttpServerStats stats = server.get_stats();
+    printf("  server: %llu connections accepted, %llu rejected, %llu requests served\n",
+           (unsigned long long)stats.connections_accepted,
+           (unsigned long long)stats.connections_rejected,
+           (unsigned long long)stats.requests_served);
+    server.stop();
+    return 0;
+}
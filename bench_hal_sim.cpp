@@ -0,0 +1,256 @@
+// ============================================================================
+// HAL SIMULATOR BENCHMARK
+// Drains a queue of Foreman tasks (8x8 Wrench job, then a 4KB NOC copy of
+// its output to KEY_L2) through agni_scheduler_step() on the host
+// simulator, and reports simulated cycles per task (run length over
+// tasks) and task latency for a range of NOC bandwidths. A second table scatters each output to KEY_L2 as a
+// 4-descriptor chain and shows the NOC utilization reached with 1 to 16
+// chains in flight on the descriptor ring. A third drains the same queue
+// with the polling loop and with the IRQ-driven event loop and compares
+// Foreman idle time and power against TARGET_POWER_W. The last runs the
+// Wrench -> NOC -> Key pipeline over 1, 2 and 4 stage buffers, with a
+// timeline of the ping-pong run.
+// ============================================================================
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "agni_hal.h"
+#include "config.h"
+#include "agni_scheduler_hw.h"
+
+static const uint32_t BENCH_TASKS = 256;
+static const uint64_t BENCH_TILE_BYTES = 8 * 8 * sizeof(float);
+static const uint64_t BENCH_C_STRIDE = 4096;      // Each task copies 4KB from its output
+static const double BENCH_NOC_BYTES_PER_CYCLE[] = { 8.0, 16.0, 32.0, 64.0 };
+static const uint32_t BENCH_CHAIN_PARTS = 4;
+static const uint32_t BENCH_DEPTHS[] = { 1, 2, 4, 8, 16 };
+static const uint32_t BENCH_PIPE_BUFFERS[] = { 1, 2, 4 };
+static const uint32_t BENCH_TIMELINE_TILES = 8;
+static const uint32_t BENCH_TIMELINE_WIDTH = 96;
+static const uint32_t BENCH_WRENCH_OPS_PER_TILE = 3;  // load A, load B, execute
+
+static void submit_tasks() {
+    for (uint32_t t = 0; t < BENCH_TASKS; ++t) {
+        Task task;
+        task.job_id = t;
+        task.wrench_a_addr = GLOBAL_DRAM_BASE + (uint64_t)t * 2 * BENCH_TILE_BYTES;
+        task.wrench_b_addr = task.wrench_a_addr + BENCH_TILE_BYTES;
+        task.wrench_c_addr = WRENCH_L2_BASE + (uint64_t)(t % 64) * BENCH_C_STRIDE;
+        agni_scheduler_submit_task(&task);
+    }
+}
+
+static void wrench_tile(uint32_t t) {
+    agni_wrench_config(8, 8);
+    agni_wrench_load_a(GLOBAL_DRAM_BASE + (uint64_t)t * 2 * BENCH_TILE_BYTES);
+    agni_wrench_load_b(GLOBAL_DRAM_BASE + (uint64_t)t * 2 * BENCH_TILE_BYTES + BENCH_TILE_BYTES);
+    agni_wrench_execute(WRENCH_L2_BASE + (uint64_t)(t % 64) * BENCH_C_STRIDE);
+}
+
+// Task t waits for chain t - depth before issuing its own
+static void run_ring_depth(uint32_t depth) {
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+    std::vector<uint64_t> seqs(BENCH_TASKS, 0);
+    const uint64_t part = BENCH_C_STRIDE / BENCH_CHAIN_PARTS;
+    for (uint32_t t = 0; t < BENCH_TASKS; ++t) {
+        if (t >= depth) agni_hal_noc_wait_seq(seqs[t - depth], 1000);
+        agni_hal_task_begin(t);
+        wrench_tile(t);
+        NocCopyDescriptor chain[BENCH_CHAIN_PARTS];
+        for (uint32_t p = 0; p < BENCH_CHAIN_PARTS; ++p) {
+            chain[p].source_addr = WRENCH_L2_BASE + (uint64_t)(t % 64) * BENCH_C_STRIDE + p * part;
+            chain[p].dest_addr = KEY_L2_BASE + ((uint64_t)(t % 64) * BENCH_CHAIN_PARTS + p) * part;
+            chain[p].size_bytes = (uint32_t)part;
+            chain[p].flags = 0;
+        }
+        while ((seqs[t] = agni_hal_noc_submit(chain, BENCH_CHAIN_PARTS)) == 0) {
+            agni_hal_noc_wait_seq(agni_hal_noc_completed_seq() + 1, 1);
+        }
+        agni_hal_task_end(t);
+    }
+    agni_sim_drain();
+
+    AgniSimStats s;
+    agni_sim_get_stats(&s);
+    printf("  %10u %14.0f %14.0f %8.1f%%\n", depth, (double)s.cycles / (double)BENCH_TASKS,
+           (double)s.task_cycles_total / (double)s.tasks, 100.0 * (double)s.noc_busy_cycles / (double)s.cycles);
+}
+
+static void run_event_loop(bool use_irq) {
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+    agni_scheduler_reset_stats();
+
+    submit_tasks();
+    if (use_irq) {
+        agni_scheduler_init();
+        agni_scheduler_run_until_idle();
+        agni_hal_noc_irq_disable();
+    } else {
+        while (agni_scheduler_step()) {
+        }
+    }
+    agni_sim_drain();
+
+    AgniSimStats s;
+    agni_sim_get_stats(&s);
+    AgniSchedulerStats sched;
+    agni_scheduler_get_stats(&sched);
+    double power = agni_sim_foreman_power_w(&s);
+    printf("  %-10s %12.0f %7.1f%% %10llu %8llu %10llu %8.3f W %6.1f%%\n", use_irq ? "irq + wfi" : "polling",
+           (double)s.cycles / (double)BENCH_TASKS, 100.0 * agni_sim_foreman_idle_fraction(&s),
+           (unsigned long long)sched.polls, (unsigned long long)sched.sleeps,
+           (unsigned long long)agni_sim_polls_avoided(&s), power, 100.0 * power / TARGET_POWER_W);
+}
+
+// Tile of the n-th trace event on its engine
+static uint32_t trace_tile(const AgniSimTraceEvent& e, uint32_t nth) {
+    return e.engine == AGNI_SIM_WRENCH ? nth / BENCH_WRENCH_OPS_PER_TILE : nth;
+}
+
+static void print_timeline(const AgniSimTraceEvent* events, size_t count) {
+    static const char* lanes[] = { "NOC", "Wrench", "Key" };
+    uint64_t end = 0;
+    uint32_t nth[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < count; ++i) {
+        if (trace_tile(events[i], nth[events[i].engine]++) < BENCH_TIMELINE_TILES) end = std::max(end, events[i].end);
+    }
+    uint64_t scale = (end + BENCH_TIMELINE_WIDTH - 1) / BENCH_TIMELINE_WIDTH;
+    printf("  First %u tiles, %llu cycles per column; digits are tile numbers\n", BENCH_TIMELINE_TILES,
+           (unsigned long long)scale);
+    const AgniSimEngine order[] = { AGNI_SIM_WRENCH, AGNI_SIM_NOC, AGNI_SIM_KEY };
+    for (int l = 0; l < 3; ++l) {
+        char row[BENCH_TIMELINE_WIDTH + 1];
+        memset(row, '.', BENCH_TIMELINE_WIDTH);
+        row[BENCH_TIMELINE_WIDTH] = '\0';
+        uint32_t n = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (events[i].engine != order[l]) continue;
+            uint32_t tile = trace_tile(events[i], n++);
+            if (tile >= BENCH_TIMELINE_TILES) break;
+            for (uint64_t c = events[i].start / scale; c <= (events[i].end - 1) / scale && c < BENCH_TIMELINE_WIDTH; ++c) {
+                row[c] = (char)('0' + tile % 10);
+            }
+        }
+        printf("  %-7s %s\n", lanes[order[l]], row);
+    }
+}
+
+// Steady state from the Key completions of the last three quarters, and
+// the share of the run with two or more engines busy; or the timeline
+static void run_pipeline(uint32_t buffers, bool timeline) {
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+    agni_sim_trace_enable(true);
+    agni_scheduler_set_pipeline(buffers);
+
+    submit_tasks();
+    agni_scheduler_init();
+    agni_scheduler_run_until_idle();
+    agni_hal_noc_irq_disable();
+    agni_sim_drain();
+    agni_sim_trace_enable(false);
+    agni_scheduler_set_pipeline(0);
+
+    const AgniSimTraceEvent* events;
+    size_t count = agni_sim_trace(&events);
+    std::vector<uint64_t> key_end;
+    std::vector<uint8_t> busy(agni_sim_now() + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (events[i].engine == AGNI_SIM_KEY) key_end.push_back(events[i].end);
+        for (uint64_t c = events[i].start; c < events[i].end; ++c) busy[c] |= (uint8_t)(1u << events[i].engine);
+    }
+    uint64_t overlap = 0;
+    for (size_t c = 0; c < busy.size(); ++c) {
+        if (busy[c] & (busy[c] - 1)) overlap++;
+    }
+    size_t first = key_end.size() / 4;
+    double steady = (double)(key_end.back() - key_end[first]) / (double)(key_end.size() - 1 - first);
+
+    if (timeline) {
+        print_timeline(events, count);
+        return;
+    }
+    AgniSimStats s;
+    agni_sim_get_stats(&s);
+    double cycles = (double)s.cycles;
+    printf("  %8u %12.0f %10.0f %8.1f%% %8.1f%% %8.1f%% %9.1f%%\n", buffers, steady,
+           (double)FOREMAN_FREQ_HZ / steady / 1e3, 100.0 * (double)s.wrench_busy_cycles / cycles,
+           100.0 * (double)s.noc_busy_cycles / cycles, 100.0 * (double)s.key_busy_cycles / cycles,
+           100.0 * (double)overlap / cycles);
+}
+
+int main() {
+    if (agni_sim_init() != 0) return 1;
+    float* dram = (float*)agni_sim_host_ptr(GLOBAL_DRAM_BASE, BENCH_TASKS * 2 * BENCH_TILE_BYTES);
+    for (uint64_t i = 0; i < BENCH_TASKS * 2 * BENCH_TILE_BYTES / sizeof(float); ++i) {
+        dram[i] = (float)(i % 13) * 0.25f;
+    }
+
+    printf("====================================================================\n");
+    printf("HAL SIMULATOR BENCHMARK: %u tasks, 8x8 Wrench + 4KB NOC copy each\n", BENCH_TASKS);
+    printf("====================================================================\n");
+    printf("  %10s %14s %10s %12s %14s %8s %8s\n", "NOC B/cyc", "cycles/task", "us/task", "tasks/ms",
+           "task latency", "NOC %", "Wrench %");
+
+    for (size_t b = 0; b < sizeof(BENCH_NOC_BYTES_PER_CYCLE) / sizeof(BENCH_NOC_BYTES_PER_CYCLE[0]); ++b) {
+        AgniSimConfig config = agni_sim_default_config();
+        config.noc_bytes_per_cycle = BENCH_NOC_BYTES_PER_CYCLE[b];
+        agni_sim_configure(&config);
+        agni_sim_reset();
+
+        submit_tasks();
+        while (agni_scheduler_step()) {
+        }
+        agni_sim_drain();
+
+        AgniSimStats s;
+        agni_sim_get_stats(&s);
+        // Tasks issue up to a ring ahead, so latency is mostly queueing
+        double per_task = (double)s.cycles / (double)BENCH_TASKS;
+        double latency = (double)s.task_cycles_total / (double)(s.tasks ? s.tasks : 1);
+        printf("  %10.0f %14.0f %10.3f %12.0f %14.0f %7.1f%% %7.1f%%\n", config.noc_bytes_per_cycle, per_task,
+               per_task * 1e6 / (double)FOREMAN_FREQ_HZ, (double)FOREMAN_FREQ_HZ / per_task / 1e3, latency,
+               100.0 * (double)s.noc_busy_cycles / (double)s.cycles,
+               100.0 * (double)s.wrench_busy_cycles / (double)s.cycles);
+    }
+    printf("  (cycles at %.1f GHz; up to %d copies in flight on the ring)\n",
+           (double)FOREMAN_FREQ_HZ / 1e9, NOC_RING_ENTRIES);
+
+    printf("--------------------------------------------------------------------\n");
+    printf("NOC UTILIZATION: %u-descriptor chains, %.0f B/cycle, by chains in flight\n",
+           BENCH_CHAIN_PARTS, agni_sim_default_config().noc_bytes_per_cycle);
+    printf("--------------------------------------------------------------------\n");
+    printf("  %10s %14s %14s %9s\n", "in flight", "cycles/task", "task latency", "NOC busy");
+    for (size_t d = 0; d < sizeof(BENCH_DEPTHS) / sizeof(BENCH_DEPTHS[0]); ++d) {
+        run_ring_depth(BENCH_DEPTHS[d]);
+    }
+
+    printf("--------------------------------------------------------------------\n");
+    printf("FOREMAN EVENT LOOP: %u tasks, power proxy against the %d W target\n", BENCH_TASKS,
+           TARGET_POWER_W);
+    printf("--------------------------------------------------------------------\n");
+    printf("  %-10s %12s %8s %10s %8s %10s %10s %7s\n", "loop", "cycles/task", "idle", "polls",
+           "WFIs", "avoided", "Foreman", "budget");
+    run_event_loop(false);
+    run_event_loop(true);
+
+    printf("--------------------------------------------------------------------\n");
+    printf("WRENCH -> NOC -> KEY PIPELINE: %u tiles over stage buffers\n", BENCH_TASKS);
+    printf("--------------------------------------------------------------------\n");
+    printf("  %8s %12s %10s %9s %9s %9s %10s\n", "buffers", "cycles/tile", "tiles/ms", "Wrench", "NOC",
+           "Key", "2+ busy");
+    for (size_t b = 0; b < sizeof(BENCH_PIPE_BUFFERS) / sizeof(BENCH_PIPE_BUFFERS[0]); ++b) {
+        run_pipeline(BENCH_PIPE_BUFFERS[b], false);
+    }
+    run_pipeline(2, true);
+
+    agni_sim_shutdown();
+    return 0;
+}
@@ -0,0 +1,154 @@
+// ============================================================================
+// JSON CODEC BENCHMARK
+// Request-to-response serialization cost of the gateway endpoints: the
+// former stringstream builders (prompt taken as the raw body) against
+// JsonReader prompt extraction plus JsonWriter output. Reports ns and heap
+// allocations per request.
+// ============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "json_codec.h"
+
+static const int BENCH_ITERATIONS = 200000;
+
+// Global allocation counters
+static std::atomic<uint64_t> g_alloc_count(0);
+
+void* operator new(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+static const char AXIOM_BODY[] =
+    "{\"prompt\": \"Summarise the attached report in three bullet points. Keep each bullet "
+    "under twenty words, quote \\\"key figures\\\" verbatim and end with a one-line verdict.\\n\", "
+    "\"max_tokens\": 256, \"temperature\": 0.7}";
+
+// ============================================================================
+// BEFORE: stringstream builders, raw body as prompt
+// ============================================================================
+static std::string legacy_axiom(const std::string& body, uint32_t job_id, std::string& prompt) {
+    prompt = body;
+    std::stringstream ss;
+    ss << "{\"job_uuid\": " << job_id << ", \"status\": \"QUEUED\", "
+       << "\"endpoint\": \"/v59/status/" << job_id << "\"}";
+    return ss.str();
+}
+
+static std::string legacy_status(uint32_t job_id, int status) {
+    std::stringstream ss;
+    ss << "{\"job_id\": " << job_id << ", \"status\": " << status << "}";
+    return ss.str();
+}
+
+static std::string legacy_health(size_t queue_size) {
+    std::stringstream ss;
+    ss << "{\"status\": \"healthy\", "
+       << "\"queue_size\": " << queue_size << ", "
+       << "\"uptime_s\": 0}";
+    return ss.str();
+}
+
+// ============================================================================
+// AFTER: JsonReader + JsonWriter
+// ============================================================================
+class PromptField : public JsonHandler {
+public:
+    std::string& prompt;
+    int depth;
+    bool at_prompt;
+
+    explicit PromptField(std::string& out) : prompt(out), depth(0), at_prompt(false) {}
+    bool on_begin_object() { depth++; at_prompt = false; return true; }
+    bool on_end_object() { depth--; return true; }
+    bool on_key(const char* s, size_t len) {
+        at_prompt = (depth == 1 && len == 6 && memcmp(s, "prompt", 6) == 0);
+        return true;
+    }
+    bool on_string(const char* s, size_t len) {
+        if (at_prompt) prompt.assign(s, len);
+        at_prompt = false;
+        return true;
+    }
+};
+
+static std::string codec_axiom(const std::string& body, uint32_t job_id, std::string& prompt) {
+    JsonReader reader;
+    PromptField fields(prompt);
+    if (reader.parse(body, fields) != JSON_OK) abort();
+
+    char endpoint[32];
+    int n = snprintf(endpoint, sizeof(endpoint), "/v59/status/%u", job_id);
+    std::string out;
+    JsonWriter(out).begin_object()
+        .key("job_uuid").uint_value(job_id)
+        .key("status").string_value("QUEUED")
+        .key("endpoint").string_value(endpoint, (size_t)n)
+        .end_object();
+    return out;
+}
+
+static std::string codec_status(uint32_t job_id, int status) {
+    std::string out;
+    JsonWriter(out).begin_object().key("job_id").uint_value(job_id).key("status").int_value(status).end_object();
+    return out;
+}
+
+static std::string codec_health(size_t queue_size) {
+    std::string out;
+    JsonWriter(out).begin_object()
+        .key("status").string_value("healthy")
+        .key("queue_size").uint_value(queue_size)
+        .key("uptime_s").uint_value(0)
+        .end_object();
+    return out;
+}
+
+// ============================================================================
+// DRIVER
+// ============================================================================
+template <typename F>
+static void measure(const char* endpoint, const char* label, F build) {
+    size_t sink = 0;
+    for (int i = 0; i < 1000; ++i) sink += build(i).size();   // Warm-up
+
+    uint64_t allocs_before = g_alloc_count.load();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) sink += build(i).size();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    uint64_t allocs = g_alloc_count.load() - allocs_before;
+
+    printf("  %-8s %-28s %8.1f ns/req %6.2f allocs/req  (%zu)\n", endpoint, label,
+           ns / BENCH_ITERATIONS, (double)allocs / BENCH_ITERATIONS, sink % 10);
+}
+
+int main() {
+    const std::string body = AXIOM_BODY;
+    std::string prompt;
+    prompt.reserve(256);
+
+    printf("====================================================================\n");
+    printf("JSON CODEC BENCHMARK: %d requests per case, %zu byte axiom body\n",
+           BENCH_ITERATIONS, body.size());
+    printf("====================================================================\n");
+    measure("axiom", "stringstream, raw body", [&](int i) { return legacy_axiom(body, (uint32_t)i, prompt); });
+    measure("axiom", "JsonReader + JsonWriter", [&](int i) { return codec_axiom(body, (uint32_t)i, prompt); });
+    measure("status", "stringstream", [](int i) { return legacy_status((uint32_t)i, i & 3); });
+    measure("status", "JsonWriter", [](int i) { return codec_status((uint32_t)i, i & 3); });
+    measure("health", "stringstream", [](int i) { return legacy_health((size_t)i); });
+    measure("health", "JsonWriter", [](int i) { return codec_health((size_t)i); });
+    return 0;
+}
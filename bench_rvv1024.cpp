@@ -0,0 +1,180 @@
+// ============================================================================
+// VEC1024 HOST BACKEND BENCHMARK
+// vec1024_* throughput next to the simd_* calls it is built on, so the cost
+// of strip padding and of the device-order dot reduction is visible, plus
+// vec1024_matmul GFLOP/s on the Mamba projection shapes against a naive
+// triple loop, and the f32/bf16/int8 variants at the best SIMD level.
+// ============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "config.h"
+#include "rvv_1024.h"
+#include "vector_utils.h"
+
+static const double BENCH_TARGET_ELEMENTS = 1e8;   // Elements processed per case
+
+static const size_t BENCH_LENGTHS[] = {
+    4 * 1024 + 3,       // L1/L2, with a partial last strip
+    256 * 1024,         // L3
+    4 * 1024 * 1024     // DRAM
+};
+
+struct MatmulShape {
+    const char* name;
+    size_t m, n, k;
+};
+
+// Mamba projections at MAMBA_HIDDEN_SIZE for a 512-token prefill, and the
+// vocabulary projection for a 16-token batch
+static const MatmulShape MATMUL_SHAPES[] = {
+    { "512x768 * 768x768",    512, MAMBA_HIDDEN_SIZE, MAMBA_HIDDEN_SIZE },
+    { "768x768 * 768x768",    768, 768, 768 },
+    { "512x768 * 768x3072",   512, 4 * MAMBA_HIDDEN_SIZE, MAMBA_HIDDEN_SIZE },
+    { "16x768 * 768x50257",   16, MAMBA_VOCAB_SIZE, MAMBA_HIDDEN_SIZE },
+};
+
+static const size_t NAIVE_ROWS = 8;
+
+static void naive_matmul(double* C, const double* A, const double* B, size_t M, size_t N, size_t K) {
+    for (size_t i = 0; i < M; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            double acc = 0.0;
+            for (size_t k = 0; k < K; ++k) acc += A[i * K + k] * B[k * N + j];
+            C[i * N + j] = acc;
+        }
+    }
+}
+
+static volatile double g_sink;
+
+template <typename F>
+static double ns_per_element(size_t len, F op) {
+    size_t reps = (size_t)(BENCH_TARGET_ELEMENTS / (double)len);
+    if (reps < 3) reps = 3;
+    op();   // Warm-up
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < reps; ++r) op();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    return ns / ((double)reps * (double)len);
+}
+
+// GFLOP/s of op over about 2 GFLOP of repetitions, after a warm-up call
+template <typename F>
+static double gflops(double flops_per_call, F op) {
+    op();
+    int reps = (int)(2e9 / flops_per_call) + 1;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) op();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return flops_per_call * reps / sec * 1e-9;
+}
+
+int main() {
+    printf("====================================================================\n");
+    printf("VEC1024 HOST BACKEND BENCHMARK: %d-lane strips, SIMD level %s\n",
+           VEC1024_LANES, simd_level_name(simd_get_level()));
+    printf("====================================================================\n");
+    printf("  %-8s %9s %12s %12s\n", "op", "length", "vec1024", "simd_*");
+
+    for (size_t n = 0; n < sizeof(BENCH_LENGTHS) / sizeof(BENCH_LENGTHS[0]); ++n) {
+        size_t len = BENCH_LENGTHS[n];
+        Vec1024_f64* x = vec1024_create(len);
+        Vec1024_f64* y = vec1024_create(len);
+        Vec1024_f64* z = vec1024_create(len);
+        if (!x || !y || !z) return 1;
+        for (size_t i = 0; i < len; ++i) {
+            x->data[i] = sin((double)i * 0.01);
+            y->data[i] = cos((double)i * 0.02);
+        }
+
+        double add_v = ns_per_element(len, [&]() { vec1024_add(z, x, y); });
+        double add_s = ns_per_element(len, [&]() { simd_add_f64(z->data, x->data, y->data, len); });
+        printf("  %-8s %9zu %9.3f ns %9.3f ns\n", "add", len, add_v, add_s);
+
+        double dot = 0.0;
+        double dot_v = ns_per_element(len, [&]() { vec1024_dot(&dot, x, y); g_sink = dot; });
+        double dot_s = ns_per_element(len, [&]() { g_sink = simd_dot_f64(x->data, y->data, len); });
+        printf("  %-8s %9zu %9.3f ns %9.3f ns\n", "dot", len, dot_v, dot_s);
+
+        double gelu_v = ns_per_element(len, [&]() { vec1024_gelu(z); });
+        double gelu_s = ns_per_element(len, [&]() { simd_gelu_f64(z->data, z->data, len); });
+        printf("  %-8s %9zu %9.3f ns %9.3f ns\n", "gelu", len, gelu_v, gelu_s);
+
+        double soft_v = ns_per_element(len, [&]() { vec1024_softmax(z); });
+        printf("  %-8s %9zu %9.3f ns %12s\n", "softmax", len, soft_v, "(same)");
+
+        vec1024_free(x);
+        vec1024_free(y);
+        vec1024_free(z);
+    }
+
+    printf("--------------------------------------------------------------------\n");
+    printf("MATMUL GFLOP/s  (naive: i-j-k triple loop on the first %zu rows)\n", NAIVE_ROWS);
+    printf("  %-28s %8s", "shape (M x K * K x N)", "naive");
+    for (int lvl = SIMD_LEVEL_AVX2; lvl <= (int)simd_detect_level(); ++lvl) {
+        printf(" %8s", simd_level_name((SimdLevel)lvl));
+    }
+    printf("\n");
+    for (size_t n = 0; n < sizeof(MATMUL_SHAPES) / sizeof(MATMUL_SHAPES[0]); ++n) {
+        const MatmulShape& shape = MATMUL_SHAPES[n];
+        size_t M = shape.m, N = shape.n, K = shape.k;
+        std::vector<double> A(M * K), B(K * N), C(M * N);
+        for (size_t i = 0; i < A.size(); ++i) A[i] = sin((double)i);
+        for (size_t i = 0; i < B.size(); ++i) B[i] = cos((double)i);
+
+        size_t rows = M < NAIVE_ROWS ? M : NAIVE_ROWS;
+        auto t0 = std::chrono::steady_clock::now();
+        naive_matmul(C.data(), A.data(), B.data(), rows, N, K);
+        double naive_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("  %-28s %8.2f", shape.name, 2.0 * rows * N * K / naive_sec * 1e-9);
+
+        for (int lvl = SIMD_LEVEL_AVX2; lvl <= (int)simd_detect_level(); ++lvl) {
+            simd_set_level((SimdLevel)lvl);
+            vec1024_matmul(C.data(), A.data(), B.data(), M, N, K);     // Warm-up
+            int reps = (int)(2e9 / (2.0 * M * N * K)) + 1;
+            t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r) vec1024_matmul(C.data(), A.data(), B.data(), M, N, K);
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            printf(" %8.2f", 2.0 * M * N * K * reps / sec * 1e-9);
+        }
+        simd_set_level(simd_detect_level());
+        printf("\n");
+        g_sink = C[M * N / 2];
+    }
+
+    printf("--------------------------------------------------------------------\n");
+    printf("MATMUL BY TYPE GFLOP/s at %s  (int8: W stored N x K)\n", simd_level_name(simd_get_level()));
+    printf("  %-28s %8s %8s %8s %8s\n", "shape (M x K * K x N)", "f64", "f32", "bf16", "int8");
+    for (size_t n = 0; n < sizeof(MATMUL_SHAPES) / sizeof(MATMUL_SHAPES[0]); ++n) {
+        const MatmulShape& shape = MATMUL_SHAPES[n];
+        size_t M = shape.m, N = shape.n, K = shape.k;
+        std::vector<double> A(M * K), B(K * N), C(M * N);
+        std::vector<float> Af(M * K), Bf(K * N), Cf(M * N), Wt(N * K), a_scales(M), w_scales(N);
+        for (size_t i = 0; i < A.size(); ++i) Af[i] = (float)(A[i] = sin((double)i));
+        for (size_t i = 0; i < B.size(); ++i) Bf[i] = (float)(B[i] = cos((double)i));
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t j = 0; j < N; ++j) Wt[j * K + k] = Bf[k * N + j];
+        }
+        std::vector<bf16> Ab(M * K), Bb(K * N);
+        simd_f32_to_bf16(Ab.data(), Af.data(), Ab.size());
+        simd_f32_to_bf16(Bb.data(), Bf.data(), Bb.size());
+        std::vector<int8_t> Aq(M * K), Wq(N * K);
+        simd_quantize_i8(Aq.data(), a_scales.data(), Af.data(), M, K);
+        simd_quantize_i8(Wq.data(), w_scales.data(), Wt.data(), N, K);
+
+        double flops = 2.0 * M * N * K;
+        printf("  %-28s %8.2f", shape.name,
+               gflops(flops, [&]() { vec1024_matmul(C.data(), A.data(), B.data(), M, N, K); }));
+        printf(" %8.2f", gflops(flops, [&]() { vec1024_matmul_f32(Cf.data(), Af.data(), Bf.data(), M, N, K); }));
+        printf(" %8.2f", gflops(flops, [&]() { vec1024_matmul_bf16(Cf.data(), Ab.data(), Bb.data(), M, N, K); }));
+        printf(" %8.2f\n", gflops(flops, [&]() {
+            vec1024_matmul_i8(Cf.data(), Aq.data(), a_scales.data(), Wq.data(), w_scales.data(), M, N, K);
+        }));
+        g_sink = C[M * N / 2] + Cf[M * N / 2];
+    }
+    return 0;
+}
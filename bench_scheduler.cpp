@@ -0,0 +1,227 @@
+// ============================================================================
+// SCHEDULER BENCHMARK
+// Queue wait time (dispatch - submit) per priority class under mixed load
+// ============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "scheduler.h"
+
+static const int BENCH_JOBS          = 4000;
+static const int BENCH_BURST         = 8;      // Jobs submitted per tick
+static const int BENCH_TICK_US       = 1000;
+static const int BENCH_WORK_US       = 500;
+
+// Global allocation counters for the allocation benchmark
+static std::atomic<uint64_t> g_alloc_count(0);
+static std::atomic<uint64_t> g_alloc_bytes(0);
+
+void* operator new(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+// Mixed load: mostly bulk batch work with a thin stream of interactive requests
+static int pick_priority(unsigned int* seed) {
+    int r = rand_r(seed) % 100;
+    if (r < 50) return 0;
+    if (r < 70) return 1;
+    if (r < 90) return 2;
+    return 3;
+}
+
+static double percentile(std::vector<double>& samples, double pct) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t idx = (size_t)(pct / 100.0 * (double)(samples.size() - 1));
+    return samples[idx];
+}
+
+static void run_mixed_load(SchedulingPolicy policy, const char* label) {
+    SchedulerConfig config;
+    config.policy = policy;
+    config.simulated_work_us = BENCH_WORK_US;
+    Scheduler scheduler(config);
+    scheduler.start();
+
+    unsigned int seed = 42;
+    std::vector<uint32_t> ids;
+    ids.reserve(BENCH_JOBS);
+    size_t peak_depth[SCHED_NUM_PRIORITIES] = {0};
+
+    for (int submitted = 0; submitted < BENCH_JOBS; submitted += BENCH_BURST) {
+        for (int b = 0; b < BENCH_BURST; ++b) {
+            ids.push_back(scheduler.submit_job("WEAPON_AXIOM_001", "bench", pick_priority(&seed)));
+        }
+        SchedulerMetrics m = scheduler.get_metrics();
+        for (int p = 0; p < SCHED_NUM_PRIORITIES; ++p) {
+            peak_depth[p] = std::max(peak_depth[p], m.queue_depth[p]);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(BENCH_TICK_US));
+    }
+
+    while (scheduler.poll_job(ids.back()) != STATUS_COMPLETE || scheduler.get_queue_size() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(4 * BENCH_WORK_US));
+    scheduler.stop();
+
+    std::vector<double> waits[SCHED_NUM_PRIORITIES];
+    for (size_t i = 0; i < ids.size(); ++i) {
+        JobRef job = scheduler.get_job_ref(ids[i]);
+        if (!job || job->status != STATUS_COMPLETE) continue;
+        double wait_ms = std::chrono::duration<double, std::milli>(
+            job->start_time - job->submit_time).count();
+        waits[job->priority].push_back(wait_ms);
+    }
+
+    SchedulerMetrics metrics = scheduler.get_metrics();
+    printf("%s (aged dispatches: %llu)\n", label, (unsigned long long)metrics.aged_dispatches);
+    printf("  %-8s %8s %10s %10s %10s\n", "priority", "jobs", "p50_ms", "p99_ms", "peak_q");
+    for (int p = SCHED_NUM_PRIORITIES - 1; p >= 0; --p) {
+        size_t n = waits[p].size();
+        double p50 = percentile(waits[p], 50.0);
+        double p99 = percentile(waits[p], 99.0);
+        printf("  %-8d %8zu %10.2f %10.2f %10zu\n", p, n, p50, p99, peak_depth[p]);
+    }
+}
+
+// poll_job cost as the job table grows; lookups should stay flat
+static void run_poll_lookup() {
+    static const int POLLS = 200000;
+    const int sizes[] = {1000, 10000, 100000};
+
+    printf("poll_job lookup cost\n");
+    printf("  %-10s %12s\n", "history", "ns/poll");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        SchedulerConfig config;
+        config.history_retention = 0;
+        Scheduler scheduler(config);  // Not started: every job stays queued
+        for (int i = 0; i < sizes[s]; ++i) {
+            scheduler.submit_job("WEAPON_AXIOM_001", "bench", 0);
+        }
+
+        unsigned int seed = 7;
+        volatile int sink = 0;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < POLLS; ++i) {
+            uint32_t id = (uint32_t)(rand_r(&seed) % sizes[s]) + 1;
+            sink += (int)scheduler.poll_job(id);
+        }
+        double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - t0).count();
+        printf("  %-10d %12.1f\n", sizes[s], ns / POLLS);
+        (void)sink;
+    }
+}
+
+// Scheduling overhead: zero-work jobs from 4 producers, measured in jobs/sec
+static void run_throughput() {
+    static const int PRODUCERS = 4;
+    static const int JOBS_PER_PRODUCER = 25000;
+    const size_t worker_counts[] = {1, 4, 16, 64};
+    const SchedulingPolicy policies[] = {POLICY_FIFO, POLICY_WORK_STEALING};
+    const char* names[] = {"shared queue", "work stealing"};
+
+    printf("Throughput (%d producers x %d zero-work jobs)\n", PRODUCERS, JOBS_PER_PRODUCER);
+    printf("  %-8s %16s %16s\n", "workers", names[0], names[1]);
+    for (size_t w = 0; w < sizeof(worker_counts) / sizeof(worker_counts[0]); ++w) {
+        double rate[2];
+        for (int p = 0; p < 2; ++p) {
+            SchedulerConfig config;
+            config.policy = policies[p];
+            config.num_workers = worker_counts[w];
+            config.simulated_work_us = 0;
+            Scheduler scheduler(config);
+            scheduler.start();
+
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            std::vector<std::thread> producers;
+            for (int t = 0; t < PRODUCERS; ++t) {
+                producers.push_back(std::thread([&scheduler] {
+                    for (int i = 0; i < JOBS_PER_PRODUCER; ++i) {
+                        scheduler.submit_job("WEAPON_AXIOM_001", "bench", 0);
+                    }
+                }));
+            }
+            for (size_t t = 0; t < producers.size(); ++t) producers[t].join();
+            while (scheduler.get_metrics().completed < (uint64_t)(PRODUCERS * JOBS_PER_PRODUCER)) {
+                std::this_thread::yield();
+            }
+            double secs = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - t0).count();
+            scheduler.stop();
+            rate[p] = PRODUCERS * JOBS_PER_PRODUCER / secs;
+        }
+        printf("  %-8zu %12.0f j/s %12.0f j/s\n", worker_counts[w], rate[0], rate[1]);
+    }
+}
+
+// Heap traffic per job for the full submit -> dispatch -> complete path
+static void run_allocations() {
+    static const int JOBS = 2000;
+    const size_t prompt_sizes[] = {64, 4096, 65536};
+
+    printf("Allocations per job (submit + process, 1 worker)\n");
+    printf("  %-10s %-8s %12s %14s\n", "prompt", "submit", "allocs/job", "bytes/job");
+    for (size_t s = 0; s < sizeof(prompt_sizes) / sizeof(prompt_sizes[0]); ++s) {
+        for (int by_move = 0; by_move < 2; ++by_move) {
+            SchedulerConfig config;
+            config.num_workers = 1;
+            config.simulated_work_us = 0;
+            config.history_retention = JOBS;
+            Scheduler scheduler(config);
+            std::string weapon("WEAPON_AXIOM_001");
+            std::vector<std::string> prompts(JOBS, std::string(prompt_sizes[s], 'x'));
+
+            uint64_t count0 = g_alloc_count.load();
+            uint64_t bytes0 = g_alloc_bytes.load();
+            for (int i = 0; i < JOBS; ++i) {
+                if (by_move) {
+                    scheduler.submit_job(weapon, std::move(prompts[i]), 0);
+                } else {
+                    scheduler.submit_job(weapon, prompts[i], 0);
+                }
+            }
+            scheduler.start();
+            while (scheduler.get_metrics().completed < (uint64_t)JOBS) {
+                std::this_thread::yield();
+            }
+            uint64_t count = g_alloc_count.load() - count0;
+            uint64_t bytes = g_alloc_bytes.load() - bytes0;
+            scheduler.stop();
+
+            printf("  %-10zu %-8s %12.2f %14.0f\n", prompt_sizes[s], by_move ? "move" : "copy",
+                   (double)count / JOBS, (double)bytes / JOBS);
+        }
+    }
+}
+
+int main() {
+    printf("====================================================================\n");
+    printf("SCHEDULER BENCHMARK: %d jobs, %d workers, %dus/job, %d jobs/%dus offered\n",
+           BENCH_JOBS, MAX_WORKERS, BENCH_WORK_US, BENCH_BURST, BENCH_TICK_US);
+    printf("====================================================================\n");
+
+    run_mixed_load(POLICY_FIFO, "POLICY_FIFO");
+    run_mixed_load(POLICY_PRIORITY, "POLICY_PRIORITY");
+    run_poll_lookup();
+    run_throughput();
+    run_allocations();
+    return 0;
+}
@@ -0,0 +1,140 @@
+// ============================================================================
+// TASK RING BENCHMARK
+// Tasks/sec through the lock-free task ring from 1, 2 and 4 producer
+// threads to one consumer, one task and 16-task batches at a time, against
+// a mutex-protected deque. Producers yield and retry on
+// AGNI_ERROR_QUEUE_FULL; the retries are counted.
+// ============================================================================
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "agni_task_ring.h"
+#include "common.h"
+
+static const uint32_t BENCH_TASKS = 2000000;
+static const uint32_t BENCH_CAPACITY = 256;
+static const uint32_t BENCH_BATCH = 16;
+static const uint32_t BENCH_PRODUCERS[] = { 1, 2, 4 };
+
+static AgniTaskSlot g_slots[BENCH_CAPACITY];
+static AgniTaskRing g_ring;
+static volatile uint64_t g_sink;
+
+static void produce(uint32_t producer, uint32_t count, uint32_t batch, std::atomic<uint64_t>* full) {
+    Task tasks[BENCH_BATCH];
+    uint64_t retries = 0;
+    for (uint32_t i = 0; i < count; i += batch) {
+        for (uint32_t b = 0; b < batch; ++b) {
+            tasks[b].job_id = (producer << 24) | (i + b);
+            tasks[b].wrench_a_addr = tasks[b].wrench_b_addr = tasks[b].wrench_c_addr = 0;
+        }
+        while (agni_task_ring_push_batch(&g_ring, tasks, batch) == AGNI_ERROR_QUEUE_FULL) {
+            retries++;
+            std::this_thread::yield();
+        }
+    }
+    full->fetch_add(retries, std::memory_order_relaxed);
+}
+
+static void run_ring(uint32_t producers, uint32_t batch) {
+    agni_task_ring_init(&g_ring, g_slots, BENCH_CAPACITY, producers > 1);
+    const uint32_t per_producer = BENCH_TASKS / producers;
+    std::atomic<uint64_t> full(0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) threads.push_back(std::thread(produce, p, per_producer, batch, &full));
+    Task out[BENCH_BATCH];
+    uint64_t received = 0, sum = 0;
+    while (received < (uint64_t)per_producer * producers) {
+        uint32_t n = agni_task_ring_pop_batch(&g_ring, out, batch);
+        if (n == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (uint32_t i = 0; i < n; ++i) sum += out[i].job_id;
+        received += n;
+    }
+    for (size_t p = 0; p < threads.size(); ++p) threads[p].join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    g_sink = sum;
+
+    printf("  %-10s %9u %7u %14.0f %12llu\n", producers > 1 ? "MPSC ring" : "SPSC ring", producers, batch,
+           (double)received / sec, (unsigned long long)full.load());
+}
+
+// Baseline: the same traffic through a deque under one mutex, bounded at
+// the same capacity
+static void run_mutex(uint32_t producers, uint32_t batch) {
+    std::deque<Task> queue;
+    std::mutex mutex;
+    const uint32_t per_producer = BENCH_TASKS / producers;
+    std::atomic<uint64_t> full(0);
+
+    auto worker = [&](uint32_t producer) {
+        Task task = { 0, 0, 0, 0 };
+        uint64_t retries = 0;
+        for (uint32_t i = 0; i < per_producer; i += batch) {
+            for (bool queued = false; !queued; ) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (queue.size() + batch <= BENCH_CAPACITY) {
+                        for (uint32_t b = 0; b < batch; ++b) {
+                            task.job_id = (producer << 24) | (i + b);
+                            queue.push_back(task);
+                        }
+                        queued = true;
+                    }
+                }
+                if (!queued) {
+                    retries++;
+                    std::this_thread::yield();
+                }
+            }
+        }
+        full.fetch_add(retries, std::memory_order_relaxed);
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) threads.push_back(std::thread(worker, p));
+    uint64_t received = 0, sum = 0;
+    while (received < (uint64_t)per_producer * producers) {
+        uint32_t n = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (; n < batch && !queue.empty(); ++n) {
+                sum += queue.front().job_id;
+                queue.pop_front();
+            }
+        }
+        if (n == 0) std::this_thread::yield();
+        received += n;
+    }
+    for (size_t p = 0; p < threads.size(); ++p) threads[p].join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    g_sink = sum;
+
+    printf("  %-10s %9u %7u %14.0f %12llu\n", "mutex", producers, batch, (double)received / sec,
+           (unsigned long long)full.load());
+}
+
+int main() {
+    printf("====================================================================\n");
+    printf("TASK RING BENCHMARK: %u tasks, capacity %u, %u hardware threads\n", BENCH_TASKS, BENCH_CAPACITY,
+           std::thread::hardware_concurrency());
+    printf("====================================================================\n");
+    printf("  %-10s %9s %7s %14s %12s\n", "queue", "producers", "batch", "tasks/sec", "full retries");
+    for (size_t p = 0; p < sizeof(BENCH_PRODUCERS) / sizeof(BENCH_PRODUCERS[0]); ++p) {
+        for (uint32_t batch = 1; batch <= BENCH_BATCH; batch *= BENCH_BATCH) {
+            run_ring(BENCH_PRODUCERS[p], batch);
+            run_mutex(BENCH_PRODUCERS[p], batch);
+        }
+    }
+    return 0;
+}
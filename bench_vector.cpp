@@ -0,0 +1,381 @@
+// ============================================================================
+// VECTOR KERNEL BENCHMARK
+// GFLOP/s and bytes/cycle of simd_add/mul/dot at every supported SIMD level,
+// for working sets from L1-resident to DRAM-resident. Cycles are TSC ticks
+// (reference cycles), not core cycles, so they drift with turbo/throttling.
+// A second table gives ns/element and max ULP error against libm for the
+// transcendental kernels (exp, tanh, GELU, softmax), a third compares
+// gelu(a * b + c) as three simd_* calls with one simd_fused_f64 call, a
+// fourth gives the per-call cost of the checked, unchecked, restrict and
+// in-place variants on 64-element vectors, and a fifth finds the length
+// where simd_set_parallel starts paying off for dot and softmax on this
+// machine.
+// ============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "config.h"
+#include "vector_utils.h"
+
+static const double BENCH_TARGET_ELEMENTS = 2e8;   // Elements processed per case
+
+// Doubles per vector; add/mul touch three vectors, dot two
+static const size_t BENCH_LENGTHS[] = {
+    1024,           // 24 KB: L1
+    16 * 1024,      // 384 KB: L2
+    256 * 1024,     // 6 MB: L3
+    4 * 1024 * 1024 // 96 MB: DRAM
+};
+
+static inline uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+enum BenchOp { OP_ADD, OP_MUL, OP_DOT };
+
+static const char* op_name(BenchOp op) {
+    switch (op) {
+        case OP_ADD: return "add";
+        case OP_MUL: return "mul";
+        default:     return "dot";
+    }
+}
+
+static volatile double g_sink;
+
+static void run_case(BenchOp op, size_t len, double* dst, const double* x, const double* y) {
+    size_t reps = (size_t)(BENCH_TARGET_ELEMENTS / (double)len);
+    if (reps < 3) reps = 3;
+
+    double flops_per_elem = (op == OP_DOT) ? 2.0 : 1.0;
+    double bytes_per_elem = (op == OP_DOT) ? 16.0 : 24.0;
+
+    // Warm-up pulls the working set into the cache level under test
+    if (op == OP_DOT) g_sink = simd_dot_f64(x, y, len);
+    else simd_add_f64(dst, x, y, len);
+
+    double acc = 0.0;
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = read_cycles();
+    for (size_t r = 0; r < reps; ++r) {
+        switch (op) {
+            case OP_ADD: simd_add_f64(dst, x, y, len); break;
+            case OP_MUL: simd_mul_f64(dst, x, y, len); break;
+            case OP_DOT: acc += simd_dot_f64(x, y, len); break;
+        }
+    }
+    uint64_t cycles = read_cycles() - c0;
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    g_sink = acc + dst[len / 2];
+
+    double elems = (double)reps * (double)len;
+    printf("  %-4s %9zu %10.2f GFLOP/s %8.2f GB/s %7.2f B/cycle\n",
+           op_name(op), len,
+           elems * flops_per_elem / sec * 1e-9,
+           elems * bytes_per_elem / sec * 1e-9,
+           cycles ? elems * bytes_per_elem / (double)cycles : 0.0);
+}
+
+// ============================================================================
+// TRANSCENDENTALS
+// ============================================================================
+static const size_t ACT_LEN  = 4096;
+static const int    ACT_REPS = 5000;
+
+static uint64_t ulp_distance(double a, double b) {
+    if (a == b || (isnan(a) && isnan(b))) return 0;
+    int64_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) ia = INT64_MIN - ia;
+    if (ib < 0) ib = INT64_MIN - ib;
+    return (ia > ib) ? (uint64_t)(ia - ib) : (uint64_t)(ib - ia);
+}
+
+typedef void (*UnaryKernel)(double*, const double*, size_t);
+
+static void softmax_copy(double* dst, const double* src, size_t len) {
+    memcpy(dst, src, len * sizeof(double));
+    simd_softmax_f64(dst, len);
+}
+
+static void run_activation(const char* name, UnaryKernel f, double (*libm_f)(double),
+                           double lo, double hi) {
+    std::vector<double> x(ACT_LEN), y(ACT_LEN);
+    for (size_t i = 0; i < ACT_LEN; ++i) x[i] = lo + (hi - lo) * (double)i / (double)(ACT_LEN - 1);
+
+    f(y.data(), x.data(), ACT_LEN);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ACT_REPS; ++r) f(y.data(), x.data(), ACT_LEN);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    g_sink = y[ACT_LEN / 3];
+
+    if (libm_f) {
+        // Accuracy over a denser sweep of the same range
+        const size_t n = 1 << 20;
+        std::vector<double> ax(n), ay(n);
+        for (size_t i = 0; i < n; ++i) ax[i] = lo + (hi - lo) * (double)i / (double)(n - 1);
+        f(ay.data(), ax.data(), n);
+        uint64_t worst = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t d = ulp_distance(ay[i], libm_f(ax[i]));
+            if (d > worst) worst = d;
+        }
+        printf("  %-8s [%7.1f, %6.1f] %7.2f ns/elem   max %llu ULP\n", name, lo, hi,
+               ns / ((double)ACT_REPS * ACT_LEN), (unsigned long long)worst);
+    } else {
+        printf("  %-8s [%7.1f, %6.1f] %7.2f ns/elem\n", name, lo, hi,
+               ns / ((double)ACT_REPS * ACT_LEN));
+    }
+}
+
+// Softmax variants and sampling over a vocabulary-sized logit vector
+static void run_vocab(const char* name, void (*f)(double*, size_t)) {
+    const int reps = 400;
+    std::vector<double> logits(MAMBA_VOCAB_SIZE);
+    for (size_t i = 0; i < logits.size(); ++i) logits[i] = sin((double)i * 0.37) * 12.0;
+
+    f(logits.data(), logits.size());
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) f(logits.data(), logits.size());
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    g_sink = logits[7];
+    printf("  %-8s %7d logits   %8.2f us/call\n", name, MAMBA_VOCAB_SIZE, us / reps);
+}
+
+// ============================================================================
+// FUSED ELEMENTWISE
+// ============================================================================
+// Hidden and MLP widths for one token, and the MLP activations of a
+// 512-token prefill, which no longer fit in cache
+static const size_t FUSED_LENGTHS[] = { MAMBA_HIDDEN_SIZE, 4 * MAMBA_HIDDEN_SIZE, 512 * 4 * MAMBA_HIDDEN_SIZE };
+
+static void run_fused(size_t len) {
+    std::vector<double> a(len), b(len), c(len), tmp(len), dst(len);
+    for (size_t i = 0; i < len; ++i) {
+        a[i] = sin((double)i * 0.1);
+        b[i] = cos((double)i * 0.2);
+        c[i] = 0.01 * (double)(i % 7);
+    }
+    const SimdFusedOp ops[] = { {SIMD_OP_MUL, b.data(), 0, 0}, {SIMD_OP_ADD, c.data(), 0, 0},
+                                {SIMD_OP_GELU, NULL, 0, 0} };
+    size_t reps = (size_t)(BENCH_TARGET_ELEMENTS / 10.0 / (double)len);
+    if (reps < 3) reps = 3;
+
+    double ns[2];
+    for (int fused = 0; fused < 2; ++fused) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t r = 0; r <= reps; ++r) {
+            if (r == 1) t0 = std::chrono::steady_clock::now();     // Rep 0 warms up
+            if (fused) {
+                simd_fused_f64(dst.data(), a.data(), len, ops, 3);
+            } else {
+                simd_mul_f64(tmp.data(), a.data(), b.data(), len);
+                simd_add_f64(tmp.data(), tmp.data(), c.data(), len);
+                simd_gelu_f64(dst.data(), tmp.data(), len);
+            }
+        }
+        ns[fused] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() /
+                    ((double)reps * (double)len);
+        g_sink = dst[len / 2];
+    }
+    printf("  %9zu %10.3f ns %10.3f ns %7.2fx\n", len, ns[0], ns[1], ns[0] / ns[1]);
+}
+
+// ============================================================================
+// SMALL VECTORS
+// ============================================================================
+// A batch of short rows, as in per-head attention; all of it stays in L1
+static const size_t SMALL_LEN   = 64;
+static const size_t SMALL_ROWS  = 16;
+static const size_t SMALL_CALLS = 4000000;
+
+enum SmallVariant { SMALL_CHECKED, SMALL_UNCHECKED, SMALL_RESTRICT, SMALL_INPLACE };
+
+static double run_small_add(SmallVariant v, double* dst, const double* x, const double* y) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < SMALL_CALLS; ++c) {
+        size_t off = (c % SMALL_ROWS) * SMALL_LEN;
+        switch (v) {
+            case SMALL_CHECKED:   simd_add_f64(dst + off, x + off, y + off, SMALL_LEN); break;
+            case SMALL_UNCHECKED: simd_add_f64_unchecked(dst + off, x + off, y + off, SMALL_LEN); break;
+            case SMALL_RESTRICT:  simd_add_f64_restrict(dst + off, x + off, y + off, SMALL_LEN); break;
+            case SMALL_INPLACE:   simd_add_inplace_f64(dst + off, y + off, SMALL_LEN); break;
+        }
+    }
+    g_sink = dst[SMALL_LEN / 2];
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / SMALL_CALLS;
+}
+
+static double run_small_dot(bool checked, const double* x, const double* y) {
+    double acc = 0.0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < SMALL_CALLS; ++c) {
+        size_t off = (c % SMALL_ROWS) * SMALL_LEN;
+        acc += checked ? simd_dot_f64(x + off, y + off, SMALL_LEN) : simd_dot_f64_unchecked(x + off, y + off, SMALL_LEN);
+    }
+    g_sink = acc;
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / SMALL_CALLS;
+}
+
+static void run_small() {
+    std::vector<double> x(SMALL_ROWS * SMALL_LEN), y(x.size()), dst(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = 1.0 + (double)(i % 17) * 1e-3;
+        y[i] = 1e-9 * (double)(i % 13);     // In place, dst stays bounded
+    }
+    dst = x;
+    double add[4];
+    for (int v = SMALL_CHECKED; v <= SMALL_INPLACE; ++v) {
+        add[v] = run_small_add((SmallVariant)v, dst.data(), x.data(), y.data());
+    }
+    double dot[2] = { run_small_dot(true, x.data(), y.data()), run_small_dot(false, x.data(), y.data()) };
+    printf("  add %8.2f %10.2f %9.2f %9.2f   dot %8.2f %10.2f  ns/call\n",
+           add[SMALL_CHECKED], add[SMALL_UNCHECKED], add[SMALL_RESTRICT], add[SMALL_INPLACE], dot[0], dot[1]);
+}
+
+// ============================================================================
+// PARALLEL CROSSOVER
+// ============================================================================
+static const size_t CROSSOVER_LENGTHS[] = {
+    SIMD_PARALLEL_CHUNK, 2 * SIMD_PARALLEL_CHUNK, 4 * SIMD_PARALLEL_CHUNK, MAMBA_VOCAB_SIZE,
+    16 * SIMD_PARALLEL_CHUNK, 64 * SIMD_PARALLEL_CHUNK, 256 * SIMD_PARALLEL_CHUNK
+};
+
+// us/call of dot (softmax = false) or softmax at len under the current mode
+static double time_reduction(bool softmax, size_t len, std::vector<double>& a, const std::vector<double>& b) {
+    size_t reps = (size_t)(BENCH_TARGET_ELEMENTS / 20.0 / (double)len);
+    if (reps < 5) reps = 5;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t r = 0; r <= reps; ++r) {
+        if (r == 1) t0 = std::chrono::steady_clock::now();     // Rep 0 warms up
+        if (softmax) {
+            simd_softmax_f64(a.data(), len);
+        } else {
+            g_sink = simd_dot_f64(a.data(), b.data(), len);
+        }
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / (double)reps;
+}
+
+static void run_crossover(const char* name, bool softmax, size_t threads) {
+    size_t max_len = CROSSOVER_LENGTHS[sizeof(CROSSOVER_LENGTHS) / sizeof(CROSSOVER_LENGTHS[0]) - 1];
+    std::vector<double> a(max_len), b(max_len);
+    for (size_t i = 0; i < max_len; ++i) b[i] = cos((double)i * 0.2);
+
+    size_t crossover = 0;
+    for (size_t n = 0; n < sizeof(CROSSOVER_LENGTHS) / sizeof(CROSSOVER_LENGTHS[0]); ++n) {
+        size_t len = CROSSOVER_LENGTHS[n];
+        double us[2];
+        for (int par = 0; par < 2; ++par) {
+            // Softmax runs in place; the logits are reset before each timing
+            for (size_t i = 0; i < len; ++i) a[i] = sin((double)i * 0.37) * 12.0;
+            simd_set_parallel(par ? threads : 1, 1);
+            us[par] = time_reduction(softmax, len, a, b);
+        }
+        if (!crossover && us[1] < us[0]) crossover = len;
+        printf("  %-8s %9zu %10.2f us %10.2f us %7.2fx\n", name, len, us[0], us[1], us[0] / us[1]);
+    }
+    simd_set_parallel(1, 0);
+    if (crossover) {
+        printf("  %-8s crossover at %zu elements\n", name, crossover);
+    } else {
+        printf("  %-8s crossover: none up to %zu elements, keep it serial\n", name, max_len);
+    }
+}
+
+static double libm_exp(double x) { return exp(x); }
+static double libm_tanh(double x) { return tanh(x); }
+
+int main() {
+    size_t max_len = BENCH_LENGTHS[sizeof(BENCH_LENGTHS) / sizeof(BENCH_LENGTHS[0]) - 1];
+    std::vector<double> x(max_len), y(max_len), dst(max_len);
+    for (size_t i = 0; i < max_len; ++i) {
+        x[i] = 1.0 + (double)(i % 17) * 1e-3;
+        y[i] = 1.0 - (double)(i % 13) * 1e-3;
+    }
+
+    SimdLevel best = simd_detect_level();
+    printf("====================================================================\n");
+    printf("VECTOR KERNEL BENCHMARK: best level %s, ~%.0e elements per case\n",
+           simd_level_name(best), BENCH_TARGET_ELEMENTS);
+    printf("====================================================================\n");
+
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)best; ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        printf("[%s]\n", simd_level_name((SimdLevel)lvl));
+        for (size_t n = 0; n < sizeof(BENCH_LENGTHS) / sizeof(BENCH_LENGTHS[0]); ++n) {
+            size_t len = BENCH_LENGTHS[n];
+            run_case(OP_ADD, len, dst.data(), x.data(), y.data());
+            run_case(OP_MUL, len, dst.data(), x.data(), y.data());
+            run_case(OP_DOT, len, dst.data(), x.data(), y.data());
+        }
+    }
+
+    printf("--------------------------------------------------------------------\n");
+    printf("TRANSCENDENTALS: %zu elements x %d reps, error vs libm\n", ACT_LEN, ACT_REPS);
+    printf("--------------------------------------------------------------------\n");
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)best; ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        printf("[%s]\n", simd_level_name((SimdLevel)lvl));
+        run_activation("exp", simd_exp_f64, libm_exp, -745.0, 709.0);
+        run_activation("tanh", simd_tanh_f64, libm_tanh, -20.0, 20.0);
+        run_activation("gelu", simd_gelu_f64, nullptr, -10.0, 10.0);
+        run_activation("softmax", softmax_copy, nullptr, -10.0, 10.0);
+        run_vocab("softmax", simd_softmax_f64);
+        run_vocab("logsoft", simd_log_softmax_f64);
+        run_vocab("top-k50", [](double* v, size_t n) { g_sink = (double)simd_sample_f64(v, n, 50, 1.0, 0.8, 0.5); });
+        run_vocab("top-p.9", [](double* v, size_t n) { g_sink = (double)simd_sample_f64(v, n, 0, 0.9, 0.8, 0.5); });
+    }
+    simd_set_level(best);
+
+    printf("--------------------------------------------------------------------\n");
+    printf("FUSED gelu(a * b + c): ns/element, three simd_* calls vs simd_fused_f64\n");
+    printf("--------------------------------------------------------------------\n");
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)best; ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        printf("[%s]\n", simd_level_name((SimdLevel)lvl));
+        for (size_t n = 0; n < sizeof(FUSED_LENGTHS) / sizeof(FUSED_LENGTHS[0]); ++n) {
+            run_fused(FUSED_LENGTHS[n]);
+        }
+    }
+    simd_set_level(best);
+
+    printf("--------------------------------------------------------------------\n");
+    printf("SMALL VECTORS: %zu elements, %zu rows, ns/call\n", SMALL_LEN, SMALL_ROWS);
+    printf("      %8s %10s %9s %9s       %8s %10s\n", "checked", "unchecked", "restrict", "in-place",
+           "checked", "unchecked");
+    printf("--------------------------------------------------------------------\n");
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)best; ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        printf("[%s]\n", simd_level_name((SimdLevel)lvl));
+        run_small();
+    }
+    simd_set_level(best);
+
+    // At least two threads, so a single-core machine still shows the cost
+    size_t hw_threads = (size_t)std::thread::hardware_concurrency();
+    size_t threads = MAX(hw_threads, (size_t)2);
+    printf("--------------------------------------------------------------------\n");
+    printf("PARALLEL CROSSOVER [%s]: serial vs simd_set_parallel(%zu), %zu hardware threads\n",
+           simd_level_name(best), threads, hw_threads);
+    printf("(pass the crossover as min_len; the default is %d)\n", SIMD_PARALLEL_MIN_LEN);
+    printf("--------------------------------------------------------------------\n");
+    run_crossover("dot", false, threads);
+    run_crossover("softmax", true, threads);
+    return 0;
+}
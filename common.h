@@ -17,6 +17,7 @@
 #define AGNI_ERROR_ALLOCATION     -3
 #define AGNI_ERROR_TIMEOUT        -4
 #define AGNI_ERROR_RUNTIME        -5
+#define AGNI_ERROR_QUEUE_FULL     -6   // Backpressure: nothing was queued, retry later
 
 // ============================================================================
 // LOGGING MACROS
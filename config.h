@@ -23,6 +23,14 @@
 #define MAX_QUEUE_SIZE         1000
 #define MAX_WORKERS            4
 #define WORKER_TIMEOUT_MS      30000           // 30 second timeout
+#define SCHED_NUM_PRIORITIES   4               // Priority classes: 0 (bulk) .. 3 (interactive)
+#define SCHED_AGING_MS         500             // Each 500ms of waiting promotes a job one class
+#define SCHED_SIMULATED_WORK_MS 50             // Simulated inference time per job
+#define SCHED_HISTORY_RETENTION 10000          // Completed jobs kept for status polling
+#define SCHED_BATCH_MAX_JOBS   1               // Jobs per inference pass; 1 disables batching
+#define SCHED_BATCH_WAIT_US    2000            // Max wait for a batch to fill
+#define SCHED_SIMULATED_BATCH_ITEM_MS 5        // Simulated cost of each extra prompt in a pass
+#define SCHED_HISTORY_TTL_MS   600000          // Completed jobs expire after 10 minutes
 
 // ============================================================================
 // API SERVER PARAMETERS
@@ -31,6 +39,10 @@
 #define API_MAX_CONNECTIONS    100
 #define API_REQUEST_TIMEOUT_MS 60000           // 60 second timeout
 #define API_MAX_UPLOAD_SIZE    (50 * 1024 * 1024) // 50MB
+#define API_IO_THREADS         2               // HTTP event loops
+#define API_MAX_HEADER_BYTES   8192            // Request line + headers
+#define API_UPLOAD_DIR         "/tmp"          // Uploaded files land here
+#define API_STATUS_MAX_WAIT_MS 30000           // Cap on /v59/status ?wait_ms= long-polls
 
 // ============================================================================
 // BUZZING BEES PARAMETERS
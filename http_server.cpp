@@ -0,0 +1,904 @@
+#include "http_server.h"
+#include "json_codec.h"
+#include "common.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <mutex>
+
+#ifndef EPOLLEXCLUSIVE
+#define EPOLLEXCLUSIVE (1u << 28)
+#endif
+
+static const int    EPOLL_BATCH       = 256;
+static const int    SWEEP_INTERVAL_MS = 100;
+static const size_t READ_CHUNK        = 64 * 1024;
+static const size_t OUT_HIGH_WATER    = 1024 * 1024;  // Unsent bytes that hold back pipelined requests
+static const size_t IN_HELD_LIMIT     = READ_CHUNK;   // Unparsed bytes read while requests are held
+
+// ============================================================================
+// PARSING HELPERS
+// ============================================================================
+static const char* reason_phrase(int status_code) {
+    switch (status_code) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 408: return "Request Timeout";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default:  return "Unknown";
+    }
+}
+
+static void to_lower(std::string& s) {
+    for (size_t i = 0; i < s.size(); ++i) {
+        s[i] = (char)tolower((unsigned char)s[i]);
+    }
+}
+
+static std::string trim(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return std::string(begin, end);
+}
+
+// Parse "METHOD SP target SP HTTP/1.x" and the header block that follows.
+// Header names are lowercased. Returns false on a malformed head.
+static bool parse_head(const char* head, size_t len, APIRequest& req, bool& http11) {
+    const char* end = head + len;
+    const char* line_end = std::search(head, end, "\r\n", "\r\n" + 2);
+
+    const char* sp1 = std::find(head, line_end, ' ');
+    if (sp1 == line_end) return false;
+    const char* sp2 = std::find(sp1 + 1, line_end, ' ');
+    if (sp2 == line_end) return false;
+
+    req.method.assign(head, sp1);
+    std::string version(sp2 + 1, line_end);
+    if (version == "HTTP/1.1") {
+        http11 = true;
+    } else if (version == "HTTP/1.0") {
+        http11 = false;
+    } else {
+        return false;
+    }
+
+    const char* target = sp1 + 1;
+    const char* query = std::find(target, sp2, '?');
+    req.endpoint.assign(target, query);
+    req.query.assign(query == sp2 ? sp2 : query + 1, sp2);
+    if (req.method.empty() || req.endpoint.empty() || req.endpoint[0] != '/') return false;
+
+    const char* line = line_end + 2;
+    while (line < end) {
+        line_end = std::search(line, end, "\r\n", "\r\n" + 2);
+        if (line_end == line) break;
+        const char* colon = std::find(line, line_end, ':');
+        if (colon == line_end || colon == line) return false;
+
+        std::string name(line, colon);
+        to_lower(name);
+        req.headers[name] = trim(colon + 1, line_end);
+        line = line_end + 2;
+    }
+    return true;
+}
+
+static bool parse_content_length(const std::string& value, uint64_t& length) {
+    if (value.empty() || value.size() > 19) return false;
+    length = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] < '0' || value[i] > '9') return false;
+        length = length * 10 + (uint64_t)(value[i] - '0');
+    }
+    return true;
+}
+
+static bool header_has_token(const APIRequest& req, const char* name, const char* token) {
+    std::map<std::string, std::string>::const_iterator it = req.headers.find(name);
+    if (it == req.headers.end()) return false;
+    std::string value = it->second;
+    to_lower(value);
+    return value.find(token) != std::string::npos;
+}
+
+// ============================================================================
+// BODY DECODING
+// ============================================================================
+// Buffers a body into APIRequest::body for handlers that want it whole
+class StringBodySink : public RequestBodySink {
+public:
+    explicit StringBodySink(std::string& target) : body(target) {}
+    bool write(const char* data, size_t len) { body.append(data, len); return true; }
+    APIResponse finish(const APIRequest&, uint64_t) { return APIResponse(); }
+private:
+    std::string& body;
+};
+
+enum BodyResult {
+    BODY_NEED_MORE  = 0,
+    BODY_DONE       = 1,
+    BODY_MALFORMED  = -1,
+    BODY_TOO_LARGE  = -2,
+    BODY_SINK_ERROR = -3
+};
+
+// Incremental decoder for Content-Length and chunked bodies. It forwards
+// payload bytes straight from the connection buffer to the sink and keeps
+// at most one chunk-size or trailer line of its own.
+class BodyDecoder {
+public:
+    BodyDecoder() : state(FIXED), remaining(0), total(0), limit(0) {}
+
+    void init_fixed(uint64_t length, uint64_t max_bytes) {
+        state = length ? FIXED : DONE;
+        remaining = length;
+        limit = max_bytes;
+    }
+
+    void init_chunked(uint64_t max_bytes) {
+        state = CHUNK_SIZE;
+        limit = max_bytes;
+    }
+
+    uint64_t bytes() const { return total; }
+
+    BodyResult feed(const char* data, size_t len, size_t& consumed, RequestBodySink& sink) {
+        consumed = 0;
+        while (state != DONE) {
+            if (state == FIXED || state == CHUNK_DATA) {
+                size_t n = (size_t)MIN((uint64_t)(len - consumed), remaining);
+                if (n == 0) return BODY_NEED_MORE;
+                if (!sink.write(data + consumed, n)) return BODY_SINK_ERROR;
+                consumed += n;
+                remaining -= n;
+                total += n;
+                if (remaining == 0) state = (state == FIXED) ? DONE : CHUNK_DATA_END;
+                continue;
+            }
+
+            // Line-oriented states: chunk size, CRLF after data, trailers
+            const char* start = data + consumed;
+            const char* lf = (const char*)memchr(start, '\n', len - consumed);
+            if (!lf) {
+                line.append(start, len - consumed);
+                consumed = len;
+                return line.size() > MAX_LINE ? BODY_MALFORMED : BODY_NEED_MORE;
+            }
+            line.append(start, lf);
+            consumed += (size_t)(lf - start) + 1;
+            if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+
+            if (state == CHUNK_SIZE) {
+                uint64_t size = 0;
+                size_t digits = 0;
+                for (; digits < line.size() && isxdigit((unsigned char)line[digits]); ++digits) {
+                    if (digits >= 15) return BODY_MALFORMED;
+                    char c = line[digits];
+                    size = size * 16 + (uint64_t)(c <= '9' ? c - '0' : (tolower(c) - 'a' + 10));
+                }
+                if (digits == 0) return BODY_MALFORMED;
+                if (total + size > limit) return BODY_TOO_LARGE;
+                remaining = size;
+                state = size ? CHUNK_DATA : TRAILER;
+            } else if (state == CHUNK_DATA_END) {
+                if (!line.empty()) return BODY_MALFORMED;
+                state = CHUNK_SIZE;
+            } else if (line.empty()) {    // TRAILER: blank line ends the body
+                state = DONE;
+            }
+            line.clear();
+        }
+        return BODY_DONE;
+    }
+
+private:
+    enum State { FIXED, CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, TRAILER, DONE };
+    static const size_t MAX_LINE = 1024;
+
+    State state;
+    uint64_t remaining;     // Bytes left in the fixed body or current chunk
+    uint64_t total;
+    uint64_t limit;
+    std::string line;
+};
+
+struct HttpServer::RequestState {
+    APIRequest req;
+    bool keep_alive;
+    BodyDecoder decoder;
+    std::unique_ptr<RequestBodySink> sink;  // Streaming sink, or StringBodySink
+    bool streaming;
+    bool http11;
+};
+
+// ============================================================================
+// STREAMED RESPONSES
+// ============================================================================
+// Bytes queued for a connection by another thread. The loop's eventfd is
+// signalled only when the queue goes from empty to non-empty.
+struct HttpServer::Mailbox {
+    struct Delivery {
+        uint64_t connection_id;
+        std::string data;
+        bool end;               // Response complete after this data
+    };
+
+    std::mutex lock;
+    int wake_fd;
+    bool open;                  // Cleared when the loop shuts down
+    std::vector<Delivery> pending;
+
+    Mailbox() : wake_fd(-1), open(true) {}
+
+    void post(uint64_t connection_id, std::string& data, bool end) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!open) return;
+        bool was_empty = pending.empty();
+        pending.push_back(Delivery());
+        pending.back().connection_id = connection_id;
+        pending.back().data.swap(data);
+        pending.back().end = end;
+        if (was_empty) wake();
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t written = write(wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+};
+
+// Frames body data for the wire on the producing thread, so the loop only
+// appends bytes. Closed by finish_with() or when the connection goes away.
+// Buffered (deferred) responses use it unframed.
+class HttpServer::StreamChannel : public ResponseChannel {
+public:
+    StreamChannel(const std::shared_ptr<Mailbox>& mb, uint64_t id, bool chunked_coding)
+        : mailbox(mb), connection_id(id), chunked(chunked_coding), closed(false) {}
+
+    void send(const std::string& data) {
+        if (data.empty() || closed.load()) return;
+        std::string framed;
+        frame(data, framed);
+        mailbox->post(connection_id, framed, false);
+    }
+
+    void finish_with(const std::string& data) {
+        if (closed.exchange(true)) return;
+        std::string last;
+        frame(data, last);
+        if (chunked) last += "0\r\n\r\n";
+        mailbox->post(connection_id, last, true);
+    }
+
+    bool is_open() const { return !closed.load(); }
+
+    void detach() { closed = true; }
+
+private:
+    void frame(const std::string& data, std::string& out) const {
+        if (!chunked || data.empty()) {     // An empty chunk would end the body
+            out += data;
+            return;
+        }
+        char size_line[24];
+        int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", data.size());
+        out.reserve(out.size() + (size_t)n + data.size() + 7);
+        out.append(size_line, (size_t)n);
+        out += data;
+        out += "\r\n";
+    }
+
+    std::shared_ptr<Mailbox> mailbox;
+    uint64_t connection_id;
+    bool chunked;
+    std::atomic<bool> closed;
+};
+
+// ============================================================================
+// CONSTRUCTOR/DESTRUCTOR
+// ============================================================================
+HttpServer::HttpServer(const HttpServerConfig& cfg, Handler h, StreamFactory factory)
+    : config(cfg),
+      handler(h),
+      stream_factory(factory),
+      listen_fd(-1),
+      bound_port(0),
+      running(false),
+      accepted_count(0),
+      rejected_count(0),
+      timed_out_count(0),
+      served_count(0),
+      active_count(0) {
+    if (config.io_threads == 0) config.io_threads = 1;
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+// ============================================================================
+// SERVER LIFECYCLE
+// ============================================================================
+bool HttpServer::start() {
+    if (running) return true;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        LOG_ERROR("HTTP server: socket() failed: %s", strerror(errno));
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)config.port);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, SOMAXCONN) < 0) {
+        LOG_ERROR("HTTP server: cannot listen on port %d: %s", config.port, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len);
+    bound_port = ntohs(addr.sin_port);
+
+    running = true;
+    for (size_t i = 0; i < config.io_threads; ++i) {
+        IoLoop* loop = new IoLoop();
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop->mailbox = std::make_shared<Mailbox>();
+        loop->mailbox->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        loop->next_connection_id = 1;
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.ptr = nullptr;                      // Listening socket
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+        ev.events = EPOLLIN;
+        ev.data.ptr = loop;                         // Wake-up eventfd
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->mailbox->wake_fd, &ev);
+
+        loops.push_back(loop);
+    }
+    for (size_t i = 0; i < loops.size(); ++i) {
+        loops[i]->thread = std::thread(&HttpServer::run_loop, this, loops[i]);
+    }
+    return true;
+}
+
+void HttpServer::stop() {
+    if (!running) return;
+    running = false;
+
+    for (size_t i = 0; i < loops.size(); ++i) {
+        std::lock_guard<std::mutex> guard(loops[i]->mailbox->lock);
+        loops[i]->mailbox->wake();
+    }
+    for (size_t i = 0; i < loops.size(); ++i) {
+        IoLoop* loop = loops[i];
+        if (loop->thread.joinable()) loop->thread.join();
+
+        while (!loop->connections.empty()) {
+            close_connection(loop, loop->connections.begin()->second);
+        }
+        // Channels may outlive the server; later posts are dropped
+        {
+            std::lock_guard<std::mutex> guard(loop->mailbox->lock);
+            loop->mailbox->open = false;
+            loop->mailbox->pending.clear();
+            close(loop->mailbox->wake_fd);
+            loop->mailbox->wake_fd = -1;
+        }
+        close(loop->epoll_fd);
+        delete loop;
+    }
+    loops.clear();
+
+    close(listen_fd);
+    listen_fd = -1;
+}
+
+HttpServerStats HttpServer::get_stats() const {
+    HttpServerStats stats;
+    stats.connections_accepted = accepted_count.load();
+    stats.connections_rejected = rejected_count.load();
+    stats.connections_timed_out = timed_out_count.load();
+    stats.requests_served = served_count.load();
+    stats.active_connections = active_count.load();
+    return stats;
+}
+
+// ============================================================================
+// EVENT LOOP
+// ============================================================================
+void HttpServer::run_loop(IoLoop* loop) {
+    struct epoll_event events[EPOLL_BATCH];
+    Clock::time_point next_sweep = Clock::now() + std::chrono::milliseconds(SWEEP_INTERVAL_MS);
+
+    while (running) {
+        int timeout_ms = SWEEP_INTERVAL_MS;
+        if (!loop->timers.empty()) {
+            long until_ms = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                loop->timers.top().first - Clock::now()).count() + 1;
+            timeout_ms = (int)MAX(0L, MIN(until_ms, (long)timeout_ms));
+        }
+        int n = epoll_wait(loop->epoll_fd, events, EPOLL_BATCH, timeout_ms);
+        bool have_mail = false;
+        for (int i = 0; i < n && running; ++i) {
+            void* tag = events[i].data.ptr;
+            if (tag == nullptr) {
+                accept_connections(loop);
+                continue;
+            }
+            if (tag == loop) {          // Mailbox, or woken by stop()
+                have_mail = true;
+                continue;
+            }
+
+            Connection* conn = (Connection*)tag;
+            uint32_t ev = events[i].events;
+            if ((ev & (EPOLLHUP | EPOLLERR)) && !(conn->events & EPOLLIN)) {
+                close_connection(loop, conn);   // Input paused: would be reported forever
+                continue;
+            }
+            if (ev & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                handle_readable(loop, conn);
+                continue;  // conn may be gone
+            }
+            if (ev & EPOLLOUT) {
+                flush_output(loop, conn);
+            }
+        }
+        // After the batch: delivering may close connections it still names
+        if (have_mail) deliver_mail(loop);
+
+        Clock::time_point now = Clock::now();
+        fire_timers(loop, now);
+        if (now >= next_sweep) {
+            sweep_idle(loop);
+            next_sweep = now + std::chrono::milliseconds(SWEEP_INTERVAL_MS);
+        }
+    }
+}
+
+void HttpServer::accept_connections(IoLoop* loop) {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN, or another loop won the race
+
+        if (active_count.load() >= config.max_connections) {
+            rejected_count++;
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Connection* conn = new Connection();
+        conn->id = loop->next_connection_id++;
+        conn->fd = fd;
+        conn->request = nullptr;
+        conn->stream_keep_alive = false;
+        conn->deferred = nullptr;
+        conn->in_offset = 0;
+        conn->out_offset = 0;
+        conn->close_after_write = false;
+        conn->held = false;
+        conn->events = EPOLLIN;
+        conn->last_active = Clock::now();
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+
+        loop->connections[conn->id] = conn;
+        accepted_count++;
+        active_count++;
+    }
+}
+
+void HttpServer::handle_readable(IoLoop* loop, Connection* conn) {
+    char buffer[READ_CHUNK];
+    bool peer_closed = false;
+
+    // Parse after every chunk so streamed bodies drain into their sink and
+    // the input buffer stays bounded by one read. Requests held behind a
+    // stream or unsent output are read up to IN_HELD_LIMIT, then input is
+    // paused until they can be parsed.
+    while (!conn->close_after_write && !input_full(conn)) {
+        ssize_t n = read(conn->fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            conn->in.append(buffer, (size_t)n);
+            parse_requests(loop, conn);
+            if ((size_t)n < sizeof(buffer)) break;
+            continue;
+        }
+        if (n == 0) {
+            peer_closed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            peer_closed = true;
+        }
+        break;
+    }
+    conn->last_active = Clock::now();
+
+    if (!peer_closed) {
+        flush_output(loop, conn);
+        return;
+    }
+
+    // A peer that stops sending mid-stream is treated as gone
+    if (conn->stream) {
+        close_connection(loop, conn);
+        return;
+    }
+
+    // Half-closed peer: deliver what is already queued, then close. Input
+    // is no longer polled, which would report EOF forever.
+    conn->close_after_write = true;
+    flush_output(loop, conn);
+}
+
+// ============================================================================
+// REQUEST PARSING
+// ============================================================================
+// Handle every complete request in the input buffer (pipelining). Responses
+// are appended to conn->out in request order. Body bytes are handed to the
+// request's sink as soon as they arrive, so only heads are ever buffered.
+// Parsing pauses while a streamed response is in progress, and while more
+// than OUT_HIGH_WATER response bytes are unsent; flush_output resumes it.
+void HttpServer::parse_requests(IoLoop* loop, Connection* conn) {
+    while (!conn->close_after_write && !conn->stream) {
+        if (conn->out.size() - conn->out_offset > OUT_HIGH_WATER) {
+            conn->held = true;
+            break;
+        }
+        if (!conn->request && !begin_request(conn)) break;
+
+        RequestState& state = *conn->request;
+        size_t consumed = 0;
+        BodyResult result = state.decoder.feed(conn->in.data() + conn->in_offset,
+                                               conn->in.size() - conn->in_offset,
+                                               consumed, *state.sink);
+        conn->in_offset += consumed;
+
+        if (result == BODY_NEED_MORE) break;
+        if (result != BODY_DONE) {
+            delete conn->request;
+            conn->request = nullptr;
+            if (result == BODY_TOO_LARGE) {
+                send_error(conn, 413, "Payload too large");
+            } else if (result == BODY_SINK_ERROR) {
+                send_error(conn, 500, "Failed to store request body");
+            } else {
+                send_error(conn, 400, "Malformed chunked body");
+            }
+            break;
+        }
+        finish_request(loop, conn);
+    }
+
+    if (conn->in_offset == conn->in.size()) {
+        conn->in.clear();
+        conn->in_offset = 0;
+    } else if (conn->in_offset > READ_CHUNK) {
+        conn->in.erase(0, conn->in_offset);
+        conn->in_offset = 0;
+    }
+}
+
+// Parse the next request head, if complete, and set up its body decoder.
+// Returns false when more input is needed or the request was rejected.
+bool HttpServer::begin_request(Connection* conn) {
+    static const char CRLFCRLF[] = "\r\n\r\n";
+
+    const char* data = conn->in.data() + conn->in_offset;
+    size_t avail = conn->in.size() - conn->in_offset;
+    const char* head_end = std::search(data, data + avail, CRLFCRLF, CRLFCRLF + 4);
+
+    if (head_end == data + avail) {
+        if (avail > config.max_header_bytes) {
+            send_error(conn, 431, "Request header too large");
+        }
+        return false;
+    }
+    size_t head_len = (size_t)(head_end - data) + 4;
+    if (head_len > config.max_header_bytes) {
+        send_error(conn, 431, "Request header too large");
+        return false;
+    }
+
+    std::unique_ptr<RequestState> state(new RequestState());
+    APIRequest& req = state->req;
+    bool http11 = true;
+    if (!parse_head(data, head_len - 2, req, http11)) {
+        send_error(conn, 400, "Malformed request");
+        return false;
+    }
+    conn->in_offset += head_len;
+
+    // Reject oversized bodies from the head alone, before any body is read
+    if (header_has_token(req, "transfer-encoding", "chunked")) {
+        state->decoder.init_chunked(config.max_body_bytes);
+    } else if (req.headers.count("transfer-encoding")) {
+        send_error(conn, 501, "Transfer-Encoding not supported");
+        return false;
+    } else {
+        uint64_t content_length = 0;
+        std::map<std::string, std::string>::const_iterator cl = req.headers.find("content-length");
+        if (cl != req.headers.end() && !parse_content_length(cl->second, content_length)) {
+            send_error(conn, 400, "Invalid Content-Length");
+            return false;
+        }
+        if (content_length > config.max_body_bytes) {
+            send_error(conn, 413, "Payload too large");
+            return false;
+        }
+        state->decoder.init_fixed(content_length, config.max_body_bytes);
+    }
+
+    state->http11 = http11;
+    state->keep_alive = http11 ? !header_has_token(req, "connection", "close")
+                               : header_has_token(req, "connection", "keep-alive");
+
+    RequestBodySink* sink = stream_factory ? stream_factory(req) : nullptr;
+    state->streaming = (sink != nullptr);
+    state->sink.reset(sink ? sink : new StringBodySink(req.body));
+
+    if (header_has_token(req, "expect", "100-continue")) {
+        conn->out += "HTTP/1.1 100 Continue\r\n\r\n";
+    }
+    conn->request = state.release();
+    return true;
+}
+
+void HttpServer::finish_request(IoLoop* loop, Connection* conn) {
+    std::unique_ptr<RequestState> state(conn->request);
+    conn->request = nullptr;
+
+    APIResponse resp = state->streaming
+        ? state->sink->finish(state->req, state->decoder.bytes())
+        : handler(state->req);
+
+    if (resp.stream) {
+        bool chunked = false;
+        bool keep_alive = state->keep_alive;
+        if (resp.stream_buffered) {
+            // Head waits for the body; stream callbacks are not kept
+            conn->deferred = new APIResponse(resp);
+            conn->deferred->stream = nullptr;
+            conn->deferred->on_stream_timeout = nullptr;
+        } else {
+            // HTTP/1.0 has no chunked coding: the body ends when we close
+            chunked = state->http11;
+            keep_alive = keep_alive && chunked;
+            serialize_response(resp, keep_alive, conn->out, chunked);
+        }
+        conn->stream = std::make_shared<StreamChannel>(loop->mailbox, conn->id, chunked);
+        conn->stream_keep_alive = keep_alive;
+        if (resp.stream_timeout_ms > 0 && resp.on_stream_timeout) {
+            conn->stream_deadline = Clock::now() + std::chrono::milliseconds(resp.stream_timeout_ms);
+            conn->on_stream_timeout = resp.on_stream_timeout;
+            loop->timers.push(Timer(conn->stream_deadline, conn->id));
+        }
+        resp.stream(conn->stream);      // Served once the channel finishes
+        return;
+    }
+
+    serialize_response(resp, state->keep_alive, conn->out);
+    served_count++;
+    if (!state->keep_alive) conn->close_after_write = true;
+}
+
+// Apply data posted by stream producers. A finished stream lets parsing
+// resume with any requests pipelined behind it.
+void HttpServer::deliver_mail(IoLoop* loop) {
+    Mailbox& mailbox = *loop->mailbox;
+    std::vector<Mailbox::Delivery> mail;
+    {
+        std::lock_guard<std::mutex> guard(mailbox.lock);
+        uint64_t count;
+        ssize_t n = read(mailbox.wake_fd, &count, sizeof(count));
+        (void)n;
+        mail.swap(mailbox.pending);
+    }
+
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < mail.size(); ++i) {
+        std::unordered_map<uint64_t, Connection*>::iterator it =
+            loop->connections.find(mail[i].connection_id);
+        if (it == loop->connections.end()) continue;     // Client already gone
+
+        Connection* conn = it->second;
+        (conn->deferred ? conn->deferred_body : conn->out) += mail[i].data;
+        conn->last_active = now;
+        if (mail[i].end) end_stream(loop, conn);
+        flush_output(loop, conn);
+    }
+}
+
+void HttpServer::end_stream(IoLoop* loop, Connection* conn) {
+    if (conn->deferred) {
+        conn->deferred->body.swap(conn->deferred_body);
+        serialize_response(*conn->deferred, conn->stream_keep_alive, conn->out);
+        delete conn->deferred;
+        conn->deferred = nullptr;
+        conn->deferred_body.clear();
+    }
+    conn->stream.reset();
+    conn->on_stream_timeout = nullptr;
+    served_count++;
+    if (!conn->stream_keep_alive) {
+        conn->close_after_write = true;
+    } else {
+        parse_requests(loop, conn);
+    }
+}
+
+// Run timeout handlers of streams whose deadline passed. Their answer
+// arrives through the mailbox like any other.
+void HttpServer::fire_timers(IoLoop* loop, Clock::time_point now) {
+    while (!loop->timers.empty() && loop->timers.top().first <= now) {
+        uint64_t id = loop->timers.top().second;
+        loop->timers.pop();
+
+        std::unordered_map<uint64_t, Connection*>::iterator it = loop->connections.find(id);
+        if (it == loop->connections.end()) continue;
+        Connection* conn = it->second;
+        if (!conn->stream || !conn->on_stream_timeout || conn->stream_deadline > now) continue;
+
+        std::function<void(const ResponseChannelRef&)> on_timeout;
+        on_timeout.swap(conn->on_stream_timeout);
+        on_timeout(conn->stream);
+    }
+}
+
+void HttpServer::send_error(Connection* conn, int status_code, const char* message) {
+    APIResponse resp;
+    resp.status_code = status_code;
+    resp.headers["Content-Type"] = "application/json";
+    JsonWriter(resp.body).begin_object().key("error").string_value(message).end_object();
+    serialize_response(resp, false, conn->out);
+    conn->close_after_write = true;
+}
+
+void HttpServer::serialize_response(const APIResponse& resp, bool keep_alive, std::string& out,
+                                    bool chunked) {
+    char line[64];
+    snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", resp.status_code,
+             reason_phrase(resp.status_code));
+    out += line;
+
+    for (std::map<std::string, std::string>::const_iterator it = resp.headers.begin();
+         it != resp.headers.end(); ++it) {
+        out += it->first;
+        out += ": ";
+        out += it->second;
+        out += "\r\n";
+    }
+
+    if (!resp.stream) {
+        snprintf(line, sizeof(line), "Content-Length: %zu\r\n", resp.body.size());
+        out += line;
+    } else if (chunked) {
+        out += "Transfer-Encoding: chunked\r\n";
+    }
+    out += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    if (!resp.stream) out += resp.body;
+}
+
+// ============================================================================
+// OUTPUT AND CONNECTION MANAGEMENT
+// ============================================================================
+// Once the output drains, requests held behind it are parsed and their
+// responses sent. Returns false if the connection was closed.
+bool HttpServer::flush_output(IoLoop* loop, Connection* conn) {
+    for (;;) {
+        while (conn->out_offset < conn->out.size()) {
+            ssize_t n = write(conn->fd, conn->out.data() + conn->out_offset,
+                              conn->out.size() - conn->out_offset);
+            if (n > 0) {
+                conn->out_offset += (size_t)n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                update_events(loop, conn);
+                return true;
+            }
+            close_connection(loop, conn);
+            return false;
+        }
+
+        conn->out.clear();
+        conn->out_offset = 0;
+        if (!conn->held) break;
+        conn->held = false;
+        parse_requests(loop, conn);
+        if (conn->out.empty()) break;
+    }
+
+    update_events(loop, conn);
+    if (conn->close_after_write && !conn->stream) {
+        close_connection(loop, conn);
+        return false;
+    }
+    return true;
+}
+
+// Requests are held behind a stream or unsent output, and enough input is
+// queued behind them
+bool HttpServer::input_full(const Connection* conn) {
+    return (conn->stream || conn->held) && conn->in.size() - conn->in_offset >= IN_HELD_LIMIT;
+}
+
+// Poll input unless it is full or no longer wanted, and output while any
+// is unsent
+void HttpServer::update_events(IoLoop* loop, Connection* conn) {
+    uint32_t events = 0;
+    if (!conn->close_after_write && !input_full(conn)) events |= EPOLLIN;
+    if (conn->out_offset < conn->out.size()) events |= EPOLLOUT;
+    if (events == conn->events) return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = conn;
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->events = events;
+}
+
+void HttpServer::close_connection(IoLoop* loop, Connection* conn) {
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    loop->connections.erase(conn->id);
+    delete conn->request;       // Aborts any partially received body
+    delete conn->deferred;
+    if (conn->stream) conn->stream->detach();   // Producers see is_open() == false
+    delete conn;
+    active_count--;
+}
+
+void HttpServer::sweep_idle(IoLoop* loop) {
+    Clock::time_point cutoff = Clock::now() - std::chrono::milliseconds(config.request_timeout_ms);
+    std::vector<Connection*> idle;
+    for (std::unordered_map<uint64_t, Connection*>::iterator it = loop->connections.begin();
+         it != loop->connections.end(); ++it) {
+        if (it->second->last_active < cutoff) idle.push_back(it->second);
+    }
+    for (size_t i = 0; i < idle.size(); ++i) {
+        timed_out_count++;
+        close_connection(loop, idle[i]);
+    }
+}
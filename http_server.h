@@ -0,0 +1,179 @@
+#ifndef AGNI_HTTP_SERVER_H
+#define AGNI_HTTP_SERVER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <queue>
+#include "api_gateway.h"
+#include "config.h"
+
+// ============================================================================
+// HTTP SERVER CONFIGURATION
+// ============================================================================
+struct HttpServerConfig {
+    int port;                       // 0 binds an ephemeral port
+    size_t io_threads;              // Event loops, separate from scheduler workers
+    size_t max_connections;         // Further connections are accepted and closed
+    uint32_t request_timeout_ms;    // Idle connections are closed after this
+    size_t max_header_bytes;        // Larger request heads get 431
+    size_t max_body_bytes;          // Larger bodies get 413 (before reading, when Content-Length is known)
+
+    HttpServerConfig()
+        : port(API_PORT),
+          io_threads(API_IO_THREADS),
+          max_connections(API_MAX_CONNECTIONS),
+          request_timeout_ms(API_REQUEST_TIMEOUT_MS),
+          max_header_bytes(API_MAX_HEADER_BYTES),
+          max_body_bytes(API_MAX_UPLOAD_SIZE) {}
+};
+
+// ============================================================================
+// HTTP SERVER STATISTICS
+// ============================================================================
+struct HttpServerStats {
+    uint64_t connections_accepted;
+    uint64_t connections_rejected;  // Over max_connections
+    uint64_t connections_timed_out;
+    uint64_t requests_served;
+    size_t active_connections;
+
+    HttpServerStats()
+        : connections_accepted(0), connections_rejected(0), connections_timed_out(0),
+          requests_served(0), active_connections(0) {}
+};
+
+// ============================================================================
+// REQUEST BODY SINK
+// Receives a request body incrementally as it arrives off the socket, so a
+// large upload is never held in memory. Chunked transfer coding is removed
+// before write() sees the data.
+// ============================================================================
+class RequestBodySink {
+public:
+    virtual ~RequestBodySink() {}
+
+    // Consume the next piece of the body. Returning false aborts the
+    // request with 500 and closes the connection.
+    virtual bool write(const char* data, size_t len) = 0;
+
+    // Body complete: produce the response. req carries the head only.
+    virtual APIResponse finish(const APIRequest& req, uint64_t body_bytes) = 0;
+};
+
+// ============================================================================
+// HTTP SERVER CLASS
+// Event-driven HTTP/1.1 server: non-blocking sockets, one epoll loop per
+// I/O thread, keep-alive and pipelining. Every loop waits on the shared
+// listening socket with EPOLLEXCLUSIVE, so each connection is owned by the
+// loop that accepted it and needs no locking. Requests are parsed into
+// APIRequest and answered in order by the handler on the I/O thread.
+// Streamed and deferred responses are fed from other threads through the
+// owning loop's mailbox, with optional timeouts kept in a per-loop timer
+// heap; later pipelined requests wait until such a response finishes.
+// ============================================================================
+class HttpServer {
+public:
+    typedef std::function<APIResponse(const APIRequest&)> Handler;
+
+    // Called once the request head is parsed. Returning a sink (owned by
+    // the server afterwards) streams the body into it; nullptr buffers the
+    // body into APIRequest::body and calls the Handler.
+    typedef std::function<RequestBodySink*(const APIRequest&)> StreamFactory;
+
+    HttpServer(const HttpServerConfig& config, Handler handler,
+               StreamFactory stream_factory = StreamFactory());
+    ~HttpServer();
+
+    // Bind, listen and start the I/O threads. Returns false on failure.
+    bool start();
+    void stop();
+
+    // Port actually bound (useful when config.port is 0)
+    int get_port() const { return bound_port; }
+
+    HttpServerStats get_stats() const;
+
+    // Serialize a response as an HTTP/1.1 message. For a streamed response
+    // only the head is written, announcing chunked transfer coding, or for
+    // HTTP/1.0 peers (chunked false) a body delimited by connection close.
+    static void serialize_response(const APIResponse& resp, bool keep_alive, std::string& out,
+                                   bool chunked = true);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct RequestState;            // Request whose body is still arriving
+    struct Mailbox;                 // Deliveries to a loop from other threads
+    class StreamChannel;            // ResponseChannel bound to one connection
+
+    struct Connection {
+        uint64_t id;                // Unique per loop; fds are reused
+        int fd;
+        RequestState* request;
+        std::shared_ptr<StreamChannel> stream;  // Response still being streamed
+        bool stream_keep_alive;
+        APIResponse* deferred;                  // Held head of a buffered stream
+        std::string deferred_body;
+        Clock::time_point stream_deadline;      // When stream_timeout_ms applies
+        std::function<void(const ResponseChannelRef&)> on_stream_timeout;
+        std::string in;             // Received bytes, in[in_offset..] unparsed
+        size_t in_offset;
+        std::string out;            // Pending response bytes, out[out_offset..] unsent
+        size_t out_offset;
+        bool close_after_write;
+        bool held;                  // Parsing waits for out to drain
+        uint32_t events;            // Registered epoll interest
+        Clock::time_point last_active;
+    };
+
+    // Stream deadline of one connection; stale entries are skipped
+    typedef std::pair<Clock::time_point, uint64_t> Timer;
+
+    struct IoLoop {
+        int epoll_fd;
+        std::shared_ptr<Mailbox> mailbox;   // Its eventfd also wakes stop()
+        std::thread thread;
+        uint64_t next_connection_id;
+        std::unordered_map<uint64_t, Connection*> connections;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer> > timers;
+    };
+
+    HttpServerConfig config;
+    Handler handler;
+    StreamFactory stream_factory;
+    int listen_fd;
+    int bound_port;
+    std::atomic<bool> running;
+    std::vector<IoLoop*> loops;
+
+    std::atomic<uint64_t> accepted_count;
+    std::atomic<uint64_t> rejected_count;
+    std::atomic<uint64_t> timed_out_count;
+    std::atomic<uint64_t> served_count;
+    std::atomic<size_t> active_count;
+
+    void run_loop(IoLoop* loop);
+    void accept_connections(IoLoop* loop);
+    void handle_readable(IoLoop* loop, Connection* conn);
+    void parse_requests(IoLoop* loop, Connection* conn);
+    bool begin_request(Connection* conn);
+    void finish_request(IoLoop* loop, Connection* conn);
+    void deliver_mail(IoLoop* loop);
+    void end_stream(IoLoop* loop, Connection* conn);
+    void fire_timers(IoLoop* loop, Clock::time_point now);
+    bool flush_output(IoLoop* loop, Connection* conn);
+    static bool input_full(const Connection* conn);
+    void update_events(IoLoop* loop, Connection* conn);
+    void close_connection(IoLoop* loop, Connection* conn);
+    void sweep_idle(IoLoop* loop);
+    void send_error(Connection* conn, int status_code, const char* message);
+};
+
+#endif // AGNI_HTTP_SERVER_H
@@ -0,0 +1,412 @@
+#include "json_codec.h"
+#include "common.h"
+
+// ============================================================================
+// JSON WRITER
+// ============================================================================
+JsonWriter::JsonWriter(std::string& target, size_t reserve_bytes)
+    : out(target), depth(0), after_key(false) {
+    has_members[0] = false;
+    out.reserve(out.size() + reserve_bytes);
+}
+
+// Comma before every member or element except the first of its container
+void JsonWriter::separate() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (has_members[depth]) out += ", ";
+    has_members[depth] = true;
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    separate();
+    out += '{';
+    if (depth < JSON_MAX_DEPTH) depth++;
+    has_members[depth] = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    out += '}';
+    if (depth > 0) depth--;
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    separate();
+    out += '[';
+    if (depth < JSON_MAX_DEPTH) depth++;
+    has_members[depth] = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    out += ']';
+    if (depth > 0) depth--;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separate();
+    out += '"';
+    append_escaped(name, strlen(name));
+    out += "\": ";
+    after_key = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string_value(const char* s, size_t len) {
+    separate();
+    out += '"';
+    append_escaped(s, len);
+    out += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::string_value(const char* s) {
+    return string_value(s, strlen(s));
+}
+
+JsonWriter& JsonWriter::uint_value(uint64_t v) {
+    separate();
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    out.append(p, (size_t)(digits + sizeof(digits) - p));
+    return *this;
+}
+
+JsonWriter& JsonWriter::int_value(int64_t v) {
+    if (v >= 0) return uint_value((uint64_t)v);
+    separate();
+    out += '-';
+    after_key = true;       // The digits continue this value
+    return uint_value(0 - (uint64_t)v);
+}
+
+JsonWriter& JsonWriter::double_value(double v) {
+    if (!isfinite(v)) return null_value();
+    separate();
+    char buffer[32];
+    int n = snprintf(buffer, sizeof(buffer), "%.17g", v);
+    out.append(buffer, (size_t)n);
+    return *this;
+}
+
+JsonWriter& JsonWriter::bool_value(bool v) {
+    separate();
+    out += v ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null_value() {
+    separate();
+    out += "null";
+    return *this;
+}
+
+// Runs of plain bytes are appended in one go; UTF-8 passes through as is
+void JsonWriter::append_escaped(const char* s, size_t len) {
+    static const char HEX[] = "0123456789abcdef";
+    size_t run = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(s + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15]};
+                out.append(u, sizeof(u));
+            }
+        }
+    }
+    out.append(s + run, len - run);
+}
+
+// ============================================================================
+// JSON READER
+// ============================================================================
+JsonResult JsonReader::parse(const char* data, size_t len, JsonHandler& h) {
+    begin = data;
+    pos = data;
+    end = data + len;
+    handler = &h;
+    depth = 0;
+    failure = JSON_OK;
+
+    skip_whitespace();
+    if (!parse_value()) return failure;
+    skip_whitespace();
+    if (pos != end) return JSON_MALFORMED;     // Trailing garbage
+    return JSON_OK;
+}
+
+bool JsonReader::fail(JsonResult result) {
+    if (failure == JSON_OK) failure = result;
+    return false;
+}
+
+bool JsonReader::emit(bool keep_going) {
+    return keep_going || fail(JSON_STOPPED);
+}
+
+void JsonReader::skip_whitespace() {
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')) ++pos;
+}
+
+bool JsonReader::parse_value() {
+    if (pos == end) return fail(JSON_MALFORMED);
+    switch (*pos) {
+        case '{': return parse_object();
+        case '[': return parse_array();
+        case '"': {
+            const char* s;
+            size_t len;
+            return parse_string(s, len) && emit(handler->on_string(s, len));
+        }
+        case 't': return parse_literal("true", 4) && emit(handler->on_bool(true));
+        case 'f': return parse_literal("false", 5) && emit(handler->on_bool(false));
+        case 'n': return parse_literal("null", 4) && emit(handler->on_null());
+        default:  return parse_number();
+    }
+}
+
+bool JsonReader::parse_object() {
+    if (++depth > JSON_MAX_DEPTH) return fail(JSON_TOO_DEEP);
+    ++pos;
+    if (!emit(handler->on_begin_object())) return false;
+
+    skip_whitespace();
+    if (pos < end && *pos == '}') {
+        ++pos;
+        --depth;
+        return emit(handler->on_end_object());
+    }
+    while (true) {
+        const char* key;
+        size_t key_len;
+        if (pos == end || *pos != '"') return fail(JSON_MALFORMED);
+        if (!parse_string(key, key_len) || !emit(handler->on_key(key, key_len))) return false;
+
+        skip_whitespace();
+        if (pos == end || *pos != ':') return fail(JSON_MALFORMED);
+        ++pos;
+        skip_whitespace();
+        if (!parse_value()) return false;
+
+        skip_whitespace();
+        if (pos == end) return fail(JSON_MALFORMED);
+        if (*pos == '}') break;
+        if (*pos != ',') return fail(JSON_MALFORMED);
+        ++pos;
+        skip_whitespace();
+    }
+    ++pos;
+    --depth;
+    return emit(handler->on_end_object());
+}
+
+bool JsonReader::parse_array() {
+    if (++depth > JSON_MAX_DEPTH) return fail(JSON_TOO_DEEP);
+    ++pos;
+    if (!emit(handler->on_begin_array())) return false;
+
+    skip_whitespace();
+    if (pos < end && *pos == ']') {
+        ++pos;
+        --depth;
+        return emit(handler->on_end_array());
+    }
+    while (true) {
+        if (!parse_value()) return false;
+        skip_whitespace();
+        if (pos == end) return fail(JSON_MALFORMED);
+        if (*pos == ']') break;
+        if (*pos != ',') return fail(JSON_MALFORMED);
+        ++pos;
+        skip_whitespace();
+    }
+    ++pos;
+    --depth;
+    return emit(handler->on_end_array());
+}
+
+// First byte in [p, end) that ends a plain string run: '"', '\\' or a
+// control character. Eight bytes are tested at a time (SWAR).
+static const char* scan_plain(const char* p, const char* end) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    while (end - p >= 8) {
+        uint64_t x;
+        memcpy(&x, p, sizeof(x));
+        uint64_t quote = x ^ (ones * '"');
+        uint64_t slash = x ^ (ones * '\\');
+        uint64_t special = ((quote - ones) & ~quote) |
+                           ((slash - ones) & ~slash) |
+                           ((x - ones * 0x20) & ~x);
+        if (special & highs) break;
+        p += 8;
+    }
+    while (p < end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) ++p;
+    return p;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+// The common case, no escapes, returns a pointer into the input. Otherwise
+// the string is decoded into `scratch`.
+bool JsonReader::parse_string(const char*& s, size_t& len) {
+    const char* start = ++pos;
+    pos = scan_plain(pos, end);
+    if (pos == end || (unsigned char)*pos < 0x20) return fail(JSON_MALFORMED);
+    if (*pos == '"') {
+        s = start;
+        len = (size_t)(pos - start);
+        ++pos;
+        return true;
+    }
+
+    // Decoded text is never longer than the rest of the input: one allocation
+    scratch.reserve((size_t)(end - start));
+    scratch.assign(start, pos);
+    while (true) {
+        // Copy the plain run up to the next quote or escape in one go
+        const char* run = pos;
+        pos = scan_plain(pos, end);
+        scratch.append(run, pos);
+        if (pos == end || (unsigned char)*pos < 0x20) return fail(JSON_MALFORMED);
+        if (*pos++ == '"') break;
+
+        if (pos == end) return fail(JSON_MALFORMED);
+        switch (*pos++) {
+            case '"':  scratch += '"'; break;
+            case '\\': scratch += '\\'; break;
+            case '/':  scratch += '/'; break;
+            case 'b':  scratch += '\b'; break;
+            case 'f':  scratch += '\f'; break;
+            case 'n':  scratch += '\n'; break;
+            case 'r':  scratch += '\r'; break;
+            case 't':  scratch += '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                for (int pair = 0; pair < 2; ++pair) {
+                    if (end - pos < 4) return fail(JSON_MALFORMED);
+                    uint32_t unit = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        int d = hex_digit(pos[i]);
+                        if (d < 0) return fail(JSON_MALFORMED);
+                        unit = (unit << 4) | (uint32_t)d;
+                    }
+                    pos += 4;
+                    if (pair == 0) {
+                        if (unit >= 0xDC00 && unit <= 0xDFFF) return fail(JSON_MALFORMED);
+                        cp = unit;
+                        if (unit < 0xD800 || unit > 0xDBFF) break;
+                        // High surrogate: the low half must follow
+                        if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u') return fail(JSON_MALFORMED);
+                        pos += 2;
+                    } else {
+                        if (unit < 0xDC00 || unit > 0xDFFF) return fail(JSON_MALFORMED);
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (unit - 0xDC00);
+                    }
+                }
+                append_utf8(scratch, cp);
+                break;
+            }
+            default:
+                return fail(JSON_MALFORMED);
+        }
+    }
+    s = scratch.data();
+    len = scratch.size();
+    return true;
+}
+
+// Validate the JSON number grammar, then convert. Integers of up to 15
+// digits are exact in a double and skip strtod.
+bool JsonReader::parse_number() {
+    const char* start = pos;
+    bool negative = (pos < end && *pos == '-');
+    if (negative) ++pos;
+    if (pos == end) return fail(JSON_MALFORMED);
+    const char* digits = pos;
+    uint64_t integer = 0;
+    if (*pos == '0') {
+        ++pos;
+    } else if (*pos >= '1' && *pos <= '9') {
+        while (pos < end && *pos >= '0' && *pos <= '9') integer = integer * 10 + (uint64_t)(*pos++ - '0');
+    } else {
+        return fail(JSON_MALFORMED);
+    }
+    if (pos - digits <= 15 && (pos == end || (*pos != '.' && *pos != 'e' && *pos != 'E'))) {
+        double value = (double)integer;
+        return emit(handler->on_number(negative ? -value : value));
+    }
+    if (pos < end && *pos == '.') {
+        ++pos;
+        if (pos == end || *pos < '0' || *pos > '9') return fail(JSON_MALFORMED);
+        while (pos < end && *pos >= '0' && *pos <= '9') ++pos;
+    }
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        ++pos;
+        if (pos < end && (*pos == '+' || *pos == '-')) ++pos;
+        if (pos == end || *pos < '0' || *pos > '9') return fail(JSON_MALFORMED);
+        while (pos < end && *pos >= '0' && *pos <= '9') ++pos;
+    }
+
+    // strtod needs a terminator; short numbers are copied to the stack
+    size_t len = (size_t)(pos - start);
+    char buffer[64];
+    const char* text = buffer;
+    if (len < sizeof(buffer)) {
+        memcpy(buffer, start, len);
+        buffer[len] = '\0';
+    } else {
+        scratch.assign(start, len);
+        text = scratch.c_str();
+    }
+    return emit(handler->on_number(strtod(text, nullptr)));
+}
+
+bool JsonReader::parse_literal(const char* word, size_t len) {
+    if ((size_t)(end - pos) < len || memcmp(pos, word, len) != 0) return fail(JSON_MALFORMED);
+    pos += len;
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef AGNI_JSON_CODEC_H
+#define AGNI_JSON_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#define JSON_MAX_DEPTH 32               // Nesting limit for both writer and reader
+
+// ============================================================================
+// JSON WRITER
+// Appends compact JSON ("key": value, separated by ", ") to a caller-owned
+// string. Commas and string escaping are handled here; numbers are
+// formatted on the stack, so the only allocation is the output buffer,
+// sized up front by reserve_bytes.
+// ============================================================================
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out, size_t reserve_bytes = 128);
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    // Object member name; the next call writes its value
+    JsonWriter& key(const char* name);
+
+    JsonWriter& string_value(const char* s, size_t len);
+    JsonWriter& string_value(const std::string& s) { return string_value(s.data(), s.size()); }
+    JsonWriter& string_value(const char* s);
+    JsonWriter& uint_value(uint64_t v);
+    JsonWriter& int_value(int64_t v);
+    JsonWriter& double_value(double v);     // Non-finite values are written as null
+    JsonWriter& bool_value(bool v);
+    JsonWriter& null_value();
+
+private:
+    std::string& out;
+    int depth;
+    bool after_key;
+    bool has_members[JSON_MAX_DEPTH + 1];
+
+    void separate();
+    void append_escaped(const char* s, size_t len);
+};
+
+// ============================================================================
+// JSON READER (SAX)
+// Parses a complete document and reports it as a stream of events. String
+// and key pointers refer into the input when the text has no escapes, or
+// into the reader's scratch buffer otherwise; they are valid only during
+// the callback. Returning false from a callback stops the parse.
+// ============================================================================
+class JsonHandler {
+public:
+    virtual ~JsonHandler() {}
+
+    virtual bool on_begin_object() { return true; }
+    virtual bool on_end_object() { return true; }
+    virtual bool on_begin_array() { return true; }
+    virtual bool on_end_array() { return true; }
+    virtual bool on_key(const char*, size_t) { return true; }
+    virtual bool on_string(const char*, size_t) { return true; }
+    virtual bool on_number(double) { return true; }
+    virtual bool on_bool(bool) { return true; }
+    virtual bool on_null() { return true; }
+};
+
+enum JsonResult {
+    JSON_OK        = 0,
+    JSON_STOPPED   = 1,     // A handler callback returned false
+    JSON_MALFORMED = -1,
+    JSON_TOO_DEEP  = -2     // Nested deeper than JSON_MAX_DEPTH
+};
+
+class JsonReader {
+public:
+    JsonReader()
+        : begin(nullptr), pos(nullptr), end(nullptr), handler(nullptr), depth(0), failure(JSON_OK) {}
+
+    // The reader may be reused; its scratch buffer is kept between parses
+    JsonResult parse(const char* data, size_t len, JsonHandler& h);
+    JsonResult parse(const std::string& text, JsonHandler& h) { return parse(text.data(), text.size(), h); }
+
+    // Offset of the first byte that could not be parsed, after JSON_MALFORMED
+    size_t error_offset() const { return (size_t)(pos - begin); }
+
+private:
+    const char* begin;
+    const char* pos;
+    const char* end;
+    JsonHandler* handler;
+    int depth;
+    JsonResult failure;     // Why parsing stopped early
+    std::string scratch;    // Unescaped copy of the current string
+
+    void skip_whitespace();
+    bool parse_value();
+    bool parse_object();
+    bool parse_array();
+    bool parse_string(const char*& s, size_t& len);
+    bool parse_number();
+    bool parse_literal(const char* word, size_t len);
+    bool emit(bool keep_going);
+    bool fail(JsonResult result);
+};
+
+#endif // AGNI_JSON_CODEC_H
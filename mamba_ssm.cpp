@@ -0,0 +1,143 @@
+#include "mamba_ssm.h"
+#include "vector_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static std::atomic<size_t> g_scan_threads(0);
+
+void mamba_set_scan_threads(size_t threads) {
+    g_scan_threads.store(threads, std::memory_order_relaxed);
+}
+
+static bool valid_params(const MambaScanParams* params) {
+    return params && params->A && params->D && params->d_model > 0 && params->d_state > 0;
+}
+
+// Per-thread rows for the decay factors, delta * u, and the y of a pass
+// that only needs the state
+struct ScanScratch {
+    explicit ScanScratch(size_t d_model) : decay(d_model), x(d_model), discard(d_model) {}
+    std::vector<double> decay;
+    std::vector<double> x;
+    std::vector<double> discard;
+};
+
+// ============================================================================
+// RECURRENT STEP
+// Per state row: decay = exp(delta * A[n]) on the exp kernel, then one
+// fused pass updates h[n] and accumulates C[n] * h[n] into y.
+// ============================================================================
+static void scan_token(const VectorKernels* kern, const MambaScanParams* params, double* state,
+                       const double* u, const double* delta, const double* B, const double* C,
+                       double* y, ScanScratch& scratch) {
+    const size_t dm = params->d_model;
+    double* decay = scratch.decay.data();
+    kern->mul(scratch.x.data(), delta, u, dm);
+    if (y) kern->mul(y, params->D, u, dm);
+
+    for (size_t n = 0; n < params->d_state; n++) {
+        kern->mul(decay, delta, params->A + n * dm, dm);
+        kern->exp(decay, decay, dm);
+        kern->ssm_update(state + n * dm, decay, scratch.x.data(), B[n], y ? C[n] : 0.0,
+                         y ? y : scratch.discard.data(), dm);
+    }
+}
+
+// Tokens [begin, end); y == NULL skips the outputs
+static void scan_range(const VectorKernels* kern, const MambaScanParams* params, double* state,
+                       const double* u, const double* delta, const double* B, const double* C,
+                       double* y, size_t begin, size_t end) {
+    const size_t dm = params->d_model;
+    const size_t ds = params->d_state;
+    ScanScratch scratch(dm);
+    for (size_t t = begin; t < end; t++) {
+        scan_token(kern, params, state, u + t * dm, delta + t * dm, B + t * ds, C + t * ds,
+                   y ? y + t * dm : NULL, scratch);
+    }
+}
+
+void mamba_scan_step(const MambaScanParams* params, double* state,
+                     const double* u, const double* delta, const double* B, const double* C,
+                     double* y) {
+    if (!valid_params(params) || !state || !u || !delta || !B || !C || !y) return;
+
+    ScanScratch scratch(params->d_model);
+    scan_token(vector_kernels_active(), params, state, u, delta, B, C, y, scratch);
+}
+
+// ============================================================================
+// CHUNKED PREFILL
+// ============================================================================
+static size_t scan_chunk_count(size_t tokens) {
+    size_t threads = g_scan_threads.load(std::memory_order_relaxed);
+    if (threads == 0) threads = MAX((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    return MAX(MIN(threads, tokens / MAMBA_SCAN_MIN_CHUNK), (size_t)1);
+}
+
+// Runs work(0) .. work(count - 1) on one thread each, work(0) on the caller
+template <typename Work>
+static void run_chunks(size_t count, Work work) {
+    std::vector<std::thread> workers;
+    for (size_t c = 1; c < count; c++) workers.push_back(std::thread(work, c));
+    work((size_t)0);
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+}
+
+void mamba_scan_prefill(const MambaScanParams* params, double* state,
+                        const double* u, const double* delta, const double* B, const double* C,
+                        double* y, size_t tokens) {
+    if (!valid_params(params) || !state || !u || !delta || !B || !C || !y) return;
+    if (tokens == 0) return;
+
+    // One kernel table for the whole call, even if the level changes meanwhile
+    const VectorKernels* kern = vector_kernels_active();
+    size_t chunks = scan_chunk_count(tokens);
+    if (chunks == 1) {
+        scan_range(kern, params, state, u, delta, B, C, y, 0, tokens);
+        return;
+    }
+
+    const size_t dm = params->d_model;
+    const size_t state_size = params->d_state * dm;
+    const size_t chunk_len = (tokens + chunks - 1) / chunks;
+    chunks = (tokens + chunk_len - 1) / chunk_len;
+
+    // Phase 1: end state of every chunk but the last, from a zero state
+    std::vector<double> local((chunks - 1) * state_size, 0.0);
+    run_chunks(chunks - 1, [&](size_t c) {
+        scan_range(kern, params, &local[c * state_size], u, delta, B, C, NULL,
+                   c * chunk_len, (c + 1) * chunk_len);
+    });
+
+    // Phase 2: true start state of each chunk. Chunk c contributes its
+    // local end state plus the incoming state decayed by
+    // exp(A * sum(delta)) over the chunk, computed here on one thread.
+    std::vector<double> starts(chunks * state_size);
+    memcpy(starts.data(), state, state_size * sizeof(double));
+    ScanScratch scratch(dm);
+    std::vector<double> delta_sum(dm);
+    for (size_t c = 0; c + 1 < chunks; c++) {
+        std::fill(delta_sum.begin(), delta_sum.end(), 0.0);
+        for (size_t t = c * chunk_len; t < (c + 1) * chunk_len; t++) {
+            kern->add(delta_sum.data(), delta_sum.data(), delta + t * dm, dm);
+        }
+        double* next = &starts[(c + 1) * state_size];
+        memcpy(next, &starts[c * state_size], state_size * sizeof(double));
+        for (size_t n = 0; n < params->d_state; n++) {
+            kern->mul(scratch.decay.data(), delta_sum.data(), params->A + n * dm, dm);
+            kern->exp(scratch.decay.data(), scratch.decay.data(), dm);
+            kern->ssm_update(next + n * dm, scratch.decay.data(), &local[c * state_size + n * dm], 1.0, 0.0,
+                             scratch.discard.data(), dm);
+        }
+    }
+
+    // Phase 3: every chunk rescans from its start state, emitting y
+    run_chunks(chunks, [&](size_t c) {
+        scan_range(kern, params, &starts[c * state_size], u, delta, B, C, y,
+                   c * chunk_len, MIN((c + 1) * chunk_len, tokens));
+    });
+    memcpy(state, &starts[(chunks - 1) * state_size], state_size * sizeof(double));
+}
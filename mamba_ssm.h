@@ -0,0 +1,48 @@
+#ifndef AGNI_MAMBA_SSM_H
+#define AGNI_MAMBA_SSM_H
+
+#include <stddef.h>
+#include "common.h"
+#include "config.h"
+
+// ============================================================================
+// MAMBA SELECTIVE SCAN (S6)
+// For channel d and state index n, with delta already through softplus:
+//   h[n][d] = exp(delta[d] * A[n][d]) * h[n][d] + delta[d] * u[d] * B[n]
+//   y[d]    = sum_n C[n] * h[n][d] + D[d] * u[d]
+// The state and A are state-major (d_state x d_model), so every inner loop
+// runs across the hidden dimension on the SIMD kernels. Per-token inputs
+// are token-major: u, delta and y are tokens x d_model, B and C are
+// tokens x d_state.
+// ============================================================================
+typedef struct {
+    size_t d_model;         // Channels, e.g. MAMBA_HIDDEN_SIZE
+    size_t d_state;         // MAMBA_STATE_SIZE
+    const double* A;        // d_state x d_model, negative for a decaying state
+    const double* D;        // d_model skip weights
+} MambaScanParams;
+
+// Decode: one recurrent step. state (d_state x d_model) is updated in
+// place; y receives d_model outputs.
+void mamba_scan_step(const MambaScanParams* params, double* state,
+                     const double* u, const double* delta, const double* B, const double* C,
+                     double* y);
+
+// Prefill: tokens steps starting from state, which holds the final state
+// on return so decode can continue from it. The sequence is cut into one
+// chunk per thread. Chunks first scan from a zero state to get their local
+// end state; carries are then chained across chunks, using
+// prod_t exp(delta_t * A) = exp(A * sum_t delta_t); finally every chunk
+// rescans from its true start state, emitting y. Equal to a sequence of
+// mamba_scan_step calls up to rounding.
+void mamba_scan_prefill(const MambaScanParams* params, double* state,
+                        const double* u, const double* delta, const double* B, const double* C,
+                        double* y, size_t tokens);
+
+// Worker threads for mamba_scan_prefill. 0 (default) uses the hardware
+// concurrency, limited so each chunk holds at least MAMBA_SCAN_MIN_CHUNK
+// tokens.
+#define MAMBA_SCAN_MIN_CHUNK 32
+void mamba_set_scan_threads(size_t threads);
+
+#endif // AGNI_MAMBA_SSM_H
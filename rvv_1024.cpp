@@ -0,0 +1,356 @@
+#include "rvv_1024.h"
+#include "vector_kernels.h"
+#include "vector_utils.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// VECTOR CREATION AND DESTRUCTION
+// ============================================================================
+Vec1024_f64* vec1024_create(size_t length) {
+    Vec1024_f64* vec = (Vec1024_f64*)malloc(sizeof(Vec1024_f64));
+    if (!vec) return NULL;
+
+    vec->length = length;
+    vec->data = NULL;
+    if (length == 0) return vec;
+
+    size_t bytes = VEC1024_STRIPS(length) * VEC1024_LANES * sizeof(double);
+    void* data = NULL;
+    if (posix_memalign(&data, VEC1024_ALIGN, bytes) != 0) {
+        LOG_ERROR("vec1024_create: cannot allocate %zu bytes", bytes);
+        free(vec);
+        return NULL;
+    }
+    memset(data, 0, bytes);
+    vec->data = (double*)data;
+    return vec;
+}
+
+void vec1024_free(Vec1024_f64* vec) {
+    if (!vec) return;
+    free(vec->data);
+    free(vec);
+}
+
+// Padded element count: whole strips
+static inline size_t strip_span(const Vec1024_f64* vec) {
+    return VEC1024_STRIPS(vec->length) * VEC1024_LANES;
+}
+
+static bool same_length(const char* op, const Vec1024_f64* a, const Vec1024_f64* b) {
+    if (a->length == b->length) return true;
+    LOG_ERROR("%s: length mismatch (%zu vs %zu)", op, a->length, b->length);
+    return false;
+}
+
+// ============================================================================
+// VECTOR OPERATIONS
+// Elementwise ops cover the padding too (0 op 0 == 0), so the kernels only
+// ever see whole strips. Softmax must not see the padding, since it would
+// add exp(-max) per padded lane to the normalizer.
+// ============================================================================
+void vec1024_add(Vec1024_f64* dest, const Vec1024_f64* src1, const Vec1024_f64* src2) {
+    if (!dest || !src1 || !src2) return;
+    if (!same_length("vec1024_add", dest, src1) || !same_length("vec1024_add", dest, src2)) return;
+
+    simd_add_f64(dest->data, src1->data, src2->data, strip_span(dest));
+}
+
+void vec1024_mul(Vec1024_f64* dest, const Vec1024_f64* src1, const Vec1024_f64* src2) {
+    if (!dest || !src1 || !src2) return;
+    if (!same_length("vec1024_mul", dest, src1) || !same_length("vec1024_mul", dest, src2)) return;
+
+    simd_mul_f64(dest->data, src1->data, src2->data, strip_span(dest));
+}
+
+void vec1024_dot(double* result, const Vec1024_f64* src1, const Vec1024_f64* src2) {
+    if (!result || !src1 || !src2) return;
+    if (!same_length("vec1024_dot", src1, src2)) return;
+
+    *result = simd_dot_lanes16_f64(src1->data, src2->data, strip_span(src1));
+}
+
+void vec1024_softmax(Vec1024_f64* vec) {
+    if (!vec) return;
+
+    simd_softmax_f64(vec->data, vec->length);
+}
+
+void vec1024_relu(Vec1024_f64* vec) {
+    if (!vec) return;
+
+    simd_relu_f64(vec->data, vec->data, strip_span(vec));
+}
+
+void vec1024_gelu(Vec1024_f64* vec) {
+    if (!vec) return;
+
+    simd_gelu_f64(vec->data, vec->data, strip_span(vec));
+}
+
+// ============================================================================
+// MATRIX OPERATIONS (GotoBLAS-style blocked GEMM)
+// Loop nest jc (NC columns of B, L3) > pc (KC deep, packed B panel) >
+// ic (MC rows of A, packed A block in L2) > jr > ir (MR x NR micro-tile,
+// B sliver in L1). K blocks run in order and later ones accumulate into C,
+// so every element still sees one ascending-k FMA chain.
+// ============================================================================
+static const size_t GEMM_KC = 192;      // 12 x 192 A sliver + 192 x 16 B sliver fit L1
+static const size_t GEMM_MC = 96;       // Multiple of every MR
+static const size_t GEMM_NC = 3072;     // Multiple of every NR
+static const double GEMM_MIN_FLOPS_PER_THREAD = 8e6;
+
+static std::atomic<size_t> g_gemm_threads(0);
+
+void vec1024_set_gemm_threads(size_t threads) {
+    g_gemm_threads.store(threads, std::memory_order_relaxed);
+}
+
+// posix_memalign-backed scratch that frees itself
+template <typename T>
+class PackBuffer {
+public:
+    explicit PackBuffer(size_t count) : data(NULL) {
+        void* ptr = NULL;
+        if (count && posix_memalign(&ptr, VEC1024_ALIGN, count * sizeof(T)) == 0) data = (T*)ptr;
+    }
+    ~PackBuffer() { free(data); }
+    T* data;
+
+private:
+    PackBuffer(const PackBuffer&);
+    PackBuffer& operator=(const PackBuffer&);
+};
+
+static inline size_t round_up(size_t n, size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+// Micro-kernel and tile shape for one compute type
+template <typename T>
+struct GemmMicro {
+    void (*micro)(size_t kc, const T* a, const T* b, T* c, size_t ldc, bool accumulate);
+    size_t mr;
+    size_t nr;
+};
+
+static GemmMicro<double> gemm_micro_for(const VectorKernels* kern, double*) {
+    GemmMicro<double> g = { kern->gemm_micro, kern->gemm_mr, kern->gemm_nr };
+    return g;
+}
+
+static GemmMicro<float> gemm_micro_for(const VectorKernels* kern, float*) {
+    GemmMicro<float> g = { kern->gemm_micro_f32, kern->gemm_mr_f32, kern->gemm_nr_f32 };
+    return g;
+}
+
+// Packing converts the storage type In to the compute type T, so bf16
+// operands are widened once per panel rather than once per FMA
+static inline double to_compute(double v, double*) { return v; }
+static inline float to_compute(float v, float*) { return v; }
+static inline float to_compute(bf16 v, float*) { return bf16_to_f32(v); }
+
+// mc x kc block of A into MR-row slivers, zero-padded to whole slivers
+template <typename In, typename T>
+static void pack_a(const In* A, size_t lda, size_t mc, size_t kc, size_t mr, T* out) {
+    for (size_t i0 = 0; i0 < mc; i0 += mr) {
+        size_t rows = MIN(mr, mc - i0);
+        for (size_t k = 0; k < kc; k++) {
+            for (size_t r = 0; r < rows; r++) out[r] = to_compute(A[(i0 + r) * lda + k], out);
+            for (size_t r = rows; r < mr; r++) out[r] = 0;
+            out += mr;
+        }
+    }
+}
+
+// kc x nc panel of B into NR-column slivers, zero-padded to whole slivers
+template <typename In, typename T>
+static void pack_b(const In* B, size_t ldb, size_t kc, size_t nc, size_t nr, T* out) {
+    for (size_t j0 = 0; j0 < nc; j0 += nr) {
+        size_t cols = MIN(nr, nc - j0);
+        for (size_t k = 0; k < kc; k++) {
+            const In* row = B + k * ldb + j0;
+            for (size_t j = 0; j < cols; j++) out[j] = to_compute(row[j], out);
+            for (size_t j = cols; j < nr; j++) out[j] = 0;
+            out += nr;
+        }
+    }
+}
+
+template <typename In, typename T>
+static void gemm_serial(GemmMicro<T> kern, size_t M, size_t N, size_t K,
+                        const In* A, size_t lda, const In* B, size_t ldb, T* C, size_t ldc) {
+    const size_t mr = kern.mr;
+    const size_t nr = kern.nr;
+    if (K == 0) {
+        for (size_t i = 0; i < M; i++) memset(C + i * ldc, 0, N * sizeof(T));
+        return;
+    }
+
+    // With a single A block each B panel is used once, so B is packed one
+    // sliver at a time into an L1-sized buffer instead of a whole panel
+    // that would be written out to L3/DRAM and read back
+    bool sliver_b = M <= GEMM_MC;
+    size_t kc_max = MIN(GEMM_KC, K);
+    PackBuffer<T> a_pack(MIN(GEMM_MC, round_up(M, mr)) * kc_max);
+    PackBuffer<T> b_pack(kc_max * (sliver_b ? nr : MIN(GEMM_NC, round_up(N, nr))));
+    if (!a_pack.data || !b_pack.data) {
+        LOG_ERROR("vec1024_matmul: cannot allocate packing buffers");
+        return;
+    }
+    T tile[VECTOR_GEMM_MAX_MR * VECTOR_GEMM_MAX_NR_F32];
+
+    for (size_t jc = 0; jc < N; jc += GEMM_NC) {
+        size_t nc = MIN(GEMM_NC, N - jc);
+        for (size_t pc = 0; pc < K; pc += GEMM_KC) {
+            size_t kc = MIN(GEMM_KC, K - pc);
+            bool accumulate = pc > 0;
+            if (!sliver_b) pack_b(B + pc * ldb + jc, ldb, kc, nc, nr, b_pack.data);
+
+            for (size_t ic = 0; ic < M; ic += GEMM_MC) {
+                size_t mc = MIN(GEMM_MC, M - ic);
+                pack_a(A + ic * lda + pc, lda, mc, kc, mr, a_pack.data);
+
+                for (size_t jr = 0; jr < nc; jr += nr) {
+                    size_t cols = MIN(nr, nc - jr);
+                    const T* b_sliver = b_pack.data + jr * kc;
+                    if (sliver_b) {
+                        pack_b(B + pc * ldb + jc + jr, ldb, kc, cols, nr, b_pack.data);
+                        b_sliver = b_pack.data;
+                    }
+                    for (size_t ir = 0; ir < mc; ir += mr) {
+                        size_t rows = MIN(mr, mc - ir);
+                        const T* a_sliver = a_pack.data + ir * kc;
+                        T* c = C + (ic + ir) * ldc + jc + jr;
+                        if (rows == mr && cols == nr) {
+                            kern.micro(kc, a_sliver, b_sliver, c, ldc, accumulate);
+                            continue;
+                        }
+                        // Edge tile: run the full kernel on a scratch tile
+                        for (size_t r = 0; r < rows && accumulate; r++) memcpy(tile + r * nr, c + r * ldc, cols * sizeof(T));
+                        kern.micro(kc, a_sliver, b_sliver, tile, nr, accumulate);
+                        for (size_t r = 0; r < rows; r++) memcpy(c + r * ldc, tile + r * nr, cols * sizeof(T));
+                    }
+                }
+            }
+        }
+    }
+}
+
+static size_t gemm_thread_count(size_t M, size_t N, size_t K, size_t tiles) {
+    size_t threads = g_gemm_threads.load(std::memory_order_relaxed);
+    if (threads == 0) {
+        threads = MAX((size_t)std::thread::hardware_concurrency(), (size_t)1);
+        size_t by_work = (size_t)(2.0 * (double)M * (double)N * (double)K / GEMM_MIN_FLOPS_PER_THREAD);
+        threads = MIN(threads, MAX(by_work, (size_t)1));
+    }
+    return MAX(MIN(threads, tiles), (size_t)1);
+}
+
+// Runs work(begin, len) over [0, extent) in chunks of whole units, one per
+// thread, with the first chunk on the calling thread
+template <typename Work>
+static void split_work(size_t extent, size_t unit, size_t threads, Work work) {
+    size_t chunk = round_up((extent + threads - 1) / threads, unit);
+    std::vector<std::thread> workers;
+    for (size_t begin = chunk; begin < extent; begin += chunk) {
+        workers.push_back(std::thread(work, begin, MIN(chunk, extent - begin)));
+    }
+    work((size_t)0, MIN(chunk, extent));
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+}
+
+template <typename In, typename T>
+static void gemm_parallel(T* C, const In* A, const In* B, size_t M, size_t N, size_t K) {
+    // One kernel table for the whole call, even if the level changes meanwhile
+    GemmMicro<T> kern = gemm_micro_for(vector_kernels_active(), C);
+    size_t m_tiles = (M + kern.mr - 1) / kern.mr;
+    size_t n_tiles = (N + kern.nr - 1) / kern.nr;
+    bool split_n = n_tiles >= m_tiles;
+    size_t threads = gemm_thread_count(M, N, K, split_n ? n_tiles : m_tiles);
+    if (threads == 1) {
+        gemm_serial(kern, M, N, K, A, K, B, N, C, N);
+        return;
+    }
+
+    // Disjoint column (or row) ranges of C, whole micro-tiles each; every
+    // thread packs its own panels, so nothing is shared but read-only input
+    if (split_n) {
+        split_work(N, kern.nr, threads, [=](size_t begin, size_t len) {
+            gemm_serial(kern, M, len, K, A, K, B + begin, N, C + begin, N);
+        });
+    } else {
+        split_work(M, kern.mr, threads, [=](size_t begin, size_t len) {
+            gemm_serial(kern, len, N, K, A + begin * K, K, B, N, C + begin * N, N);
+        });
+    }
+}
+
+void vec1024_matmul(double* C, const double* A, const double* B,
+                    size_t M, size_t N, size_t K) {
+    if (!C || M == 0 || N == 0) return;
+    if (K > 0 && (!A || !B)) return;      // With K == 0, C is just zeroed
+
+    gemm_parallel(C, A, B, M, N, K);
+}
+
+void vec1024_matmul_f32(float* C, const float* A, const float* B,
+                        size_t M, size_t N, size_t K) {
+    if (!C || M == 0 || N == 0) return;
+    if (K > 0 && (!A || !B)) return;
+
+    gemm_parallel(C, A, B, M, N, K);
+}
+
+void vec1024_matmul_bf16(float* C, const bf16* A, const bf16* B,
+                         size_t M, size_t N, size_t K) {
+    if (!C || M == 0 || N == 0) return;
+    if (K > 0 && (!A || !B)) return;
+
+    gemm_parallel(C, A, B, M, N, K);
+}
+
+// ============================================================================
+// INT8 MATMUL
+// Each output is one int32 dot product of two contiguous K-length rows,
+// which is the layout madd_epi16 wants, so nothing is packed. W is walked
+// in blocks of GEMM_I8_WC rows that stay in L2 while every row of A passes
+// over them.
+// ============================================================================
+static const size_t GEMM_I8_WC = 128;
+
+static void gemm_i8_serial(const VectorKernels* kern, float* C, size_t ldc,
+                           const int8_t* A, const float* a_scales, const int8_t* W, const float* w_scales,
+                           size_t M, size_t N, size_t K) {
+    for (size_t jc = 0; jc < N; jc += GEMM_I8_WC) {
+        size_t nc = MIN(GEMM_I8_WC, N - jc);
+        for (size_t i = 0; i < M; i++) {
+            const int8_t* a = A + i * K;
+            float* c = C + i * ldc + jc;
+            for (size_t j = 0; j < nc; j++) {
+                int32_t acc = kern->dot_i8(a, W + (jc + j) * K, K);
+                c[j] = (float)acc * (a_scales[i] * w_scales[jc + j]);
+            }
+        }
+    }
+}
+
+void vec1024_matmul_i8(float* C, const int8_t* A, const float* a_scales,
+                       const int8_t* W, const float* w_scales,
+                       size_t M, size_t N, size_t K) {
+    if (!C || M == 0 || N == 0) return;
+    if (!a_scales || !w_scales || (K > 0 && (!A || !W))) return;
+    if (K > SIMD_DOT_I8_MAX_LEN) {
+        LOG_ERROR("vec1024_matmul_i8: K = %zu exceeds the int32 accumulator range", K);
+        return;
+    }
+
+    const VectorKernels* kern = vector_kernels_active();
+    size_t threads = gemm_thread_count(M, N, K, (N + GEMM_I8_WC - 1) / GEMM_I8_WC);
+    split_work(N, GEMM_I8_WC, threads, [=](size_t begin, size_t len) {
+        gemm_i8_serial(kern, C + begin, N, A, a_scales, W + begin * K, w_scales + begin, M, len, K);
+    });
+}
@@ -5,10 +5,18 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "common.h"
+#include "vector_utils.h"
 
 // ============================================================================
 // RVV 1.0 VECTOR TYPE (1024-bit)
+// Host backend: work is strip-mined in VEC1024_LANES-element strips, one
+// device vector register each. data is VEC1024_ALIGN-aligned and zero-padded
+// to a whole number of strips, so no strip ever needs a tail.
 // ============================================================================
+#define VEC1024_LANES      16       // f64 lanes per 1024-bit register
+#define VEC1024_ALIGN      128      // Bytes; one register
+#define VEC1024_STRIPS(n)  (((n) + VEC1024_LANES - 1) / VEC1024_LANES)
+
 typedef struct {
     double* data;
     size_t length;
@@ -17,11 +25,15 @@ typedef struct {
 // ============================================================================
 // VECTOR CREATION AND DESTRUCTION
 // ============================================================================
+// Zero-filled; NULL on allocation failure
 Vec1024_f64* vec1024_create(size_t length);
 void vec1024_free(Vec1024_f64* vec);
 
 // ============================================================================
 // VECTOR OPERATIONS
+// Operands must have equal lengths; on a mismatch the call logs and leaves
+// dest untouched. dot folds lanes in the device order (see
+// simd_dot_lanes16_f64), so host and device results are bit-identical.
 // ============================================================================
 void vec1024_add(Vec1024_f64* dest, const Vec1024_f64* src1, const Vec1024_f64* src2);
 void vec1024_mul(Vec1024_f64* dest, const Vec1024_f64* src1, const Vec1024_f64* src2);
@@ -32,8 +44,33 @@ void vec1024_gelu(Vec1024_f64* vec);
 
 // ============================================================================
 // MATRIX OPERATIONS
+// C (M x N) = A (M x K) * B (K x N), all row-major: a blocked, packed GEMM
+// with per-ISA register-tile micro-kernels. Every element accumulates over
+// k in ascending order with fused multiply-add, as a vfmacc sequence
+// would, so results are bit-identical across SIMD levels and thread counts.
 // ============================================================================
 void vec1024_matmul(double* C, const double* A, const double* B,
                     size_t M, size_t N, size_t K);
 
+// Reduced precision, same layout and blocking. Both accumulate in f32 with
+// fmaf in ascending k, so they are bit-identical across SIMD levels and
+// vec1024_matmul_bf16 equals vec1024_matmul_f32 on the widened inputs.
+void vec1024_matmul_f32(float* C, const float* A, const float* B,
+                        size_t M, size_t N, size_t K);
+void vec1024_matmul_bf16(float* C, const bf16* A, const bf16* B,
+                         size_t M, size_t N, size_t K);
+
+// C (M x N) = A (M x K) * W^T, with W (N x K) holding one output channel
+// per row as simd_quantize_i8 produces. C[i][j] = dot_i8(A_i, W_j) *
+// a_scales[i] * w_scales[j]; the integer part is exact, so results do not
+// depend on the SIMD level. K is limited to SIMD_DOT_I8_MAX_LEN.
+void vec1024_matmul_i8(float* C, const int8_t* A, const float* a_scales,
+                       const int8_t* W, const float* w_scales,
+                       size_t M, size_t N, size_t K);
+
+// Worker threads for the vec1024_matmul family, which splits C into
+// disjoint blocks of micro-tiles. 0 (default) uses the hardware
+// concurrency, scaled down so each thread gets at least a few MFLOP.
+void vec1024_set_gemm_threads(size_t threads);
+
 #endif // RVV_1024_H
\ No newline at end of file
@@ -1,13 +1,58 @@
 #include "scheduler.h"
+#include "common.h"
 #include <chrono>
+#include <algorithm>
 
 // ============================================================================
 // CONSTRUCTOR/DESTRUCTOR
 // ============================================================================
-Scheduler::Scheduler() : running(false), next_job_id(1) {}
+Scheduler::Scheduler() : Scheduler(SchedulerConfig()) {}
+
+Scheduler::Scheduler(const SchedulerConfig& cfg)
+    : config(cfg),
+      next_worker_queue(0),
+      sleeping_workers(0),
+      queued_jobs(0),
+      aged_dispatches(0),
+      completed_jobs(0),
+      steal_count(0),
+      batch_count(0),
+      batched_job_count(0),
+      max_batch_seen(0),
+      batch_wait_total_us(0),
+      first_token_total_us(0),
+      running(false),
+      next_job_id(1) {
+    if (config.num_workers == 0) config.num_workers = 1;
+    if (config.batch_max_jobs == 0) config.batch_max_jobs = 1;
+    for (int p = 0; p < SCHED_NUM_PRIORITIES; ++p) {
+        queue_depth[p].store(0);
+        dispatched[p].store(0);
+    }
+    if (config.policy == POLICY_WORK_STEALING) {
+        for (size_t i = 0; i < config.num_workers; ++i) {
+            worker_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+        }
+    }
+    job_table.reserve(MAX_QUEUE_SIZE);
+}
 
 Scheduler::~Scheduler() {
     stop();
+
+    // Jobs still queued at shutdown are never run; release their nodes
+    for (size_t i = 0; i < worker_queues.size(); ++i) {
+        WorkerQueue& q = *worker_queues[i];
+        JobNode* node = q.inbox.exchange(nullptr);
+        while (node) {
+            JobNode* next = node->next;
+            delete node;
+            node = next;
+        }
+        for (size_t j = 0; j < q.jobs.size(); ++j) {
+            delete q.jobs[j];
+        }
+    }
 }
 
 // ============================================================================
@@ -16,53 +61,112 @@ Scheduler::~Scheduler() {
 uint32_t Scheduler::submit_job(const std::string& weapon_id,
                             const std::string& prompt,
                             int priority) {
-    // BUG FIX #6: Add lock guard to protect next_job_id and job_queue
-    std::lock_guard<std::mutex> lock(queue_mutex);
+    return submit_job(weapon_id, std::string(prompt), priority);
+}
 
-    Job new_job;
-    new_job.job_id = next_job_id++;
-    new_job.weapon_id = weapon_id;
-    new_job.prompt = prompt;
-    new_job.priority = priority;
-    new_job.status = STATUS_QUEUED;
+uint32_t Scheduler::submit_job(const std::string& weapon_id,
+                            std::string&& prompt,
+                            int priority) {
+    JobRef new_job = std::make_shared<Job>();
+    new_job->job_id = next_job_id.fetch_add(1);
+    new_job->weapon_id = weapon_id;
+    new_job->prompt.swap(prompt);
+    new_job->priority = CLAMP(priority, 0, SCHED_NUM_PRIORITIES - 1);
+    new_job->status = STATUS_QUEUED;
+    new_job->submit_time = Job::Clock::now();
 
-    job_queue.push(new_job);
+    uint32_t job_id = new_job->job_id;
+    int job_priority = new_job->priority;
 
-    // Also add to history for polling
+    // Add to history first so the record is pollable before it can run
     {
         std::lock_guard<std::mutex> history_lock(history_mutex);
-        job_history.push_back(new_job);
+        job_table[job_id] = new_job;
+    }
+
+    queue_depth[job_priority]++;
+
+    if (config.policy == POLICY_WORK_STEALING) {
+        JobNode* node = new JobNode;
+        node->job.swap(new_job);
+
+        // Counted before the push so the count never underflows; a worker
+        // woken in between just rescans until the node becomes visible.
+        queued_jobs++;
+
+        // Round-robin over inboxes; idle workers steal to rebalance
+        size_t target = next_worker_queue.fetch_add(1, std::memory_order_relaxed) %
+                        worker_queues.size();
+        std::atomic<JobNode*>& inbox = worker_queues[target]->inbox;
+        node->next = inbox.load(std::memory_order_relaxed);
+        while (!inbox.compare_exchange_weak(node->next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+
+        // Paired with sleeping_workers++ before the wait predicate in
+        // stealing_worker_thread: one side always sees the other's update.
+        if (sleeping_workers.load() > 0) {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            job_available.notify_one();
+        }
+        return job_id;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        int bucket = (config.policy == POLICY_PRIORITY) ? job_priority : 0;
+        job_queues[bucket].push_back(JobRef());
+        job_queues[bucket].back().swap(new_job);
+        queued_jobs++;
     }
 
     job_available.notify_one();
-    return new_job.job_id;
+    return job_id;
 }
 
 // ============================================================================
 // GET JOB DETAILS
 // ============================================================================
-Job* Scheduler::get_job(uint32_t job_id) {
+JobRef Scheduler::get_job_ref(uint32_t job_id) {
     std::lock_guard<std::mutex> lock(history_mutex);
-    for (auto& job : job_history) {
-        if (job.job_id == job_id) {
-            return &job;
-        }
-    }
-    return nullptr;
+    std::unordered_map<uint32_t, JobRef>::iterator it = job_table.find(job_id);
+    return (it != job_table.end()) ? it->second : JobRef();
 }
 
 // ============================================================================
 // POLL JOB STATUS
 // ============================================================================
 JobStatus Scheduler::poll_job(uint32_t job_id) {
-    Job* job = get_job(job_id);
+    JobRef job = get_job_ref(job_id);
     if (job) {
-        // No need to lock here, get_job already did.
+        // The handle keeps the record alive if it is evicted meanwhile;
+        // status is written under stream_mutex
+        std::lock_guard<std::mutex> lock(job->stream_mutex);
         return job->status;
     }
     return STATUS_ERROR; // Represents "not found"
 }
 
+// ============================================================================
+// SUBSCRIBE TO JOB OUTPUT
+// ============================================================================
+bool Scheduler::subscribe_job(uint32_t job_id, const JobListener& listener) {
+    JobRef job = get_job_ref(job_id);
+    if (!job) return false;
+
+    // Replay and registration happen under the same lock the worker
+    // publishes under, so no event is missed or seen twice
+    std::lock_guard<std::mutex> lock(job->stream_mutex);
+    bool keep = true;
+    if (!job->result.empty()) keep = listener(*job, JOB_EVENT_TOKEN, job->result);
+    if (keep) keep = listener(*job, JOB_EVENT_STATUS, std::string());
+    if (keep && job->status != STATUS_COMPLETE && job->status != STATUS_ERROR) {
+        job->listeners.push_back(listener);
+    }
+    return true;
+}
+
 // ============================================================================
 // START/STOP SCHEDULER
 // ============================================================================
@@ -70,8 +174,12 @@ void Scheduler::start() {
     if (running) return;
 
     running = true;
-    for (int i = 0; i < MAX_WORKERS; ++i) {
-        workers.emplace_back(&Scheduler::worker_thread, this);
+    for (size_t i = 0; i < config.num_workers; ++i) {
+        if (config.policy == POLICY_WORK_STEALING) {
+            workers.emplace_back(&Scheduler::stealing_worker_thread, this, i);
+        } else {
+            workers.emplace_back(&Scheduler::worker_thread, this);
+        }
     }
 }
 
@@ -96,49 +204,378 @@ void Scheduler::stop() {
 // GET QUEUE SIZE
 // ============================================================================
 size_t Scheduler::get_queue_size() const {
-    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(queue_mutex));
-    return job_queue.size();
+    return queued_jobs.load();
+}
+
+size_t Scheduler::get_queue_depth(int priority) const {
+    if (priority < 0 || priority >= SCHED_NUM_PRIORITIES) return 0;
+    return queue_depth[priority].load();
+}
+
+SchedulerMetrics Scheduler::get_metrics() const {
+    SchedulerMetrics snapshot;
+    for (int p = 0; p < SCHED_NUM_PRIORITIES; ++p) {
+        snapshot.queue_depth[p] = queue_depth[p].load();
+        snapshot.dispatched[p] = dispatched[p].load();
+    }
+    snapshot.aged_dispatches = aged_dispatches.load();
+    snapshot.completed = completed_jobs.load();
+    snapshot.steals = steal_count.load();
+    snapshot.batches = batch_count.load();
+    snapshot.batched_jobs = batched_job_count.load();
+    snapshot.max_batch_size = max_batch_seen.load();
+    snapshot.batch_wait_us = batch_wait_total_us.load();
+    snapshot.first_token_us = first_token_total_us.load();
+    snapshot.batch_max_jobs = config.batch_max_jobs;
+    snapshot.batch_wait_limit_us = config.batch_wait_us;
+    return snapshot;
+}
+
+size_t Scheduler::get_history_size() const {
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(history_mutex));
+    return job_table.size();
+}
+
+// ============================================================================
+// POP NEXT JOB (queue_mutex must be held)
+// ============================================================================
+// Under POLICY_PRIORITY each class is a FIFO, so only the head of each class
+// needs inspecting. A head's effective priority is its class plus one for
+// every aging_ms it has waited; ties go to the higher base class. This keeps
+// interactive jobs ahead of bulk work while guaranteeing bulk work progress.
+bool Scheduler::pop_next_job(JobRef& job) {
+    if (queued_jobs == 0) return false;
+
+    Job::Clock::time_point now = Job::Clock::now();
+    int best = -1;
+    long best_effective = -1;
+    int highest_nonempty = -1;
+
+    for (int p = SCHED_NUM_PRIORITIES - 1; p >= 0; --p) {
+        if (job_queues[p].empty()) continue;
+        if (highest_nonempty < 0) highest_nonempty = p;
+
+        long effective = p;
+        if (config.aging_ms > 0) {
+            long waited_ms = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - job_queues[p].front()->submit_time).count();
+            effective += waited_ms / (long)config.aging_ms;
+        }
+        if (effective > best_effective) {
+            best = p;
+            best_effective = effective;
+        }
+    }
+
+    job.swap(job_queues[best].front());
+    job_queues[best].pop_front();
+
+    if (best != highest_nonempty) {
+        aged_dispatches++;
+    }
+    account_dispatch(*job);
+    return true;
+}
+
+// ============================================================================
+// BATCH COLLECTION (queue_mutex must be held)
+// ============================================================================
+// Only a bounded window at the front of each class is searched, so a
+// mismatched job deep in a long queue never makes collection O(queue).
+void Scheduler::take_compatible_jobs(std::vector<JobRef>& batch) {
+    const std::string& weapon_id = batch[0]->weapon_id;
+    const size_t window = config.batch_max_jobs * 4;
+
+    for (int p = SCHED_NUM_PRIORITIES - 1; p >= 0 && batch.size() < config.batch_max_jobs; --p) {
+        std::deque<JobRef>& queue = job_queues[p];
+        size_t i = 0;
+        while (i < queue.size() && i < window && batch.size() < config.batch_max_jobs) {
+            if (queue[i]->weapon_id != weapon_id) {
+                ++i;
+                continue;
+            }
+            account_dispatch(*queue[i]);
+            batch.push_back(JobRef());
+            batch.back().swap(queue[i]);
+            queue.erase(queue.begin() + i);
+        }
+    }
+}
+
+void Scheduler::collect_batch(std::unique_lock<std::mutex>& lock, std::vector<JobRef>& batch) {
+    take_compatible_jobs(batch);
+    if (batch.size() >= config.batch_max_jobs || config.batch_wait_us == 0) return;
+
+    Job::Clock::time_point begin = Job::Clock::now();
+    Job::Clock::time_point deadline = begin + std::chrono::microseconds(config.batch_wait_us);
+    while (batch.size() < config.batch_max_jobs && running) {
+        size_t taken = batch.size();
+        bool timed_out = job_available.wait_until(lock, deadline) == std::cv_status::timeout;
+        take_compatible_jobs(batch);
+        if (timed_out) break;
+
+        // The wakeup was for a job of another weapon: pass it on now, not
+        // after our window closes
+        if (batch.size() == taken && queued_jobs > 0) job_available.notify_one();
+    }
+    batch_wait_total_us += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        Job::Clock::now() - begin).count();
+
+    // We may have absorbed a wakeup meant for a job we could not take
+    if (queued_jobs > 0) job_available.notify_one();
+}
+
+// ============================================================================
+// DISPATCH ACCOUNTING
+// ============================================================================
+void Scheduler::account_dispatch(Job& job) {
+    job.start_time = Job::Clock::now();
+    queued_jobs--;
+    queue_depth[job.priority]--;
+    dispatched[job.priority]++;
+}
+
+// ============================================================================
+// WORK-STEALING QUEUE OPERATIONS
+// ============================================================================
+// Move everything in the inbox to the back of the deque (q.lock held). The
+// inbox is a LIFO stack, so it is reversed to keep submission order.
+void Scheduler::drain_inbox(WorkerQueue& q) {
+    JobNode* node = q.inbox.exchange(nullptr, std::memory_order_acquire);
+    size_t first = q.jobs.size();
+    while (node) {
+        q.jobs.push_back(node);
+        node = node->next;
+    }
+    std::reverse(q.jobs.begin() + first, q.jobs.end());
+}
+
+// Take the front job and, when batching, any directly following jobs with
+// the same weapon_id. Batch-mates are moved into `batch`; their nodes freed.
+Scheduler::JobNode* Scheduler::take_local_job(size_t self, std::vector<JobRef>& batch) {
+    WorkerQueue& q = *worker_queues[self];
+    std::lock_guard<std::mutex> lock(q.lock);
+    drain_inbox(q);
+    if (q.jobs.empty()) return nullptr;
+
+    JobNode* node = q.jobs.front();
+    q.jobs.pop_front();
+    account_dispatch(*node->job);
+
+    while (!q.jobs.empty() && batch.size() + 1 < config.batch_max_jobs &&
+           q.jobs.front()->job->weapon_id == node->job->weapon_id) {
+        JobNode* mate = q.jobs.front();
+        q.jobs.pop_front();
+        account_dispatch(*mate->job);
+        batch.push_back(JobRef());
+        batch.back().swap(mate->job);
+        delete mate;
+    }
+    return node;
+}
+
+// Scan the other workers starting with the next one and take the newer half
+// of the first non-empty deque: one job to run now, the rest to our deque.
+Scheduler::JobNode* Scheduler::steal_job(size_t self) {
+    size_t n = worker_queues.size();
+    std::vector<JobNode*> loot;
+
+    for (size_t i = 1; i < n && loot.empty(); ++i) {
+        WorkerQueue& victim = *worker_queues[(self + i) % n];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        drain_inbox(victim);
+
+        size_t take = (victim.jobs.size() + 1) / 2;
+        for (size_t k = 0; k < take; ++k) {
+            loot.push_back(victim.jobs.back());
+            victim.jobs.pop_back();
+        }
+        if (!loot.empty()) {
+            account_dispatch(*loot.back()->job);  // Oldest stolen job runs first
+        }
+    }
+    if (loot.empty()) return nullptr;
+    steal_count++;
+
+    JobNode* node = loot.back();
+    loot.pop_back();
+    if (!loot.empty()) {
+        WorkerQueue& q = *worker_queues[self];
+        std::lock_guard<std::mutex> lock(q.lock);
+        q.jobs.insert(q.jobs.end(), loot.rbegin(), loot.rend());
+    }
+    return node;
 }
 
 // ============================================================================
 // WORKER THREAD
 // ============================================================================
 void Scheduler::worker_thread() {
+    std::vector<JobRef> batch;
+    batch.reserve(config.batch_max_jobs);
+
     while (running) {
-        Job current_job;
+        batch.clear();
         {
             std::unique_lock<std::mutex> lock(queue_mutex);
-            job_available.wait(lock, [this] { return !job_queue.empty() || !running; });
+            job_available.wait(lock, [this] { return queued_jobs > 0 || !running; });
 
-            if (!running && job_queue.empty()) {
-                return;
+            batch.push_back(JobRef());
+            if (!pop_next_job(batch.back())) {
+                return;  // Stopped with an empty queue
+            }
+            if (config.batch_max_jobs > 1) {
+                collect_batch(lock, batch);
             }
+        }
+
+        process_batch(batch);
+    }
+}
+
+void Scheduler::stealing_worker_thread(size_t self) {
+    std::vector<JobRef> batch;
+    batch.reserve(config.batch_max_jobs);
+
+    while (running) {
+        batch.clear();
+        JobNode* node = take_local_job(self, batch);
+        if (!node) node = steal_job(self);
+
+        if (!node) {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            sleeping_workers++;
+            job_available.wait(lock, [this] { return queued_jobs.load() > 0 || !running; });
+            sleeping_workers--;
+            continue;
+        }
+
+        batch.insert(batch.begin(), JobRef());
+        batch.front().swap(node->job);
+        delete node;
+        process_batch(batch);
+    }
+}
+
+// ============================================================================
+// PROCESS BATCH
+// ============================================================================
+// Split a result into tokens: each word carries its leading space
+static void split_tokens(const std::string& text, std::vector<std::string>& tokens) {
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find(' ', begin + 1);
+        if (end == std::string::npos) end = text.size();
+        tokens.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+}
+
+// Every job in the batch shares one (simulated) weight pass: the base cost
+// is paid once and each extra prompt adds simulated_batch_item_us. The pass
+// is spread over the decode steps and each step's token is appended to
+// every job in the batch as soon as it exists. Job records are the ones
+// the job table holds, so updates are visible to pollers directly.
+void Scheduler::process_batch(std::vector<JobRef>& batch) {
+    size_t count = batch.size();
+    for (size_t i = 0; i < count; ++i) {
+        publish_status(*batch[i], STATUS_RUNNING);
+    }
+
+    std::vector<std::vector<std::string> > tokens(count);
+    size_t steps = 1;
+    for (size_t i = 0; i < count; ++i) {
+        split_tokens("Job " + std::to_string(batch[i]->job_id) + " completed.", tokens[i]);
+        steps = MAX(steps, tokens[i].size());
+    }
 
-            current_job = job_queue.front();
-            job_queue.pop();
+    // Simulate work being done, one decode step at a time
+    uint64_t work_us = config.simulated_work_us +
+                       (uint64_t)(count - 1) * config.simulated_batch_item_us;
+    for (size_t step = 0; step < steps; ++step) {
+        std::this_thread::sleep_for(std::chrono::microseconds(work_us / steps));
+        for (size_t i = 0; i < count; ++i) {
+            if (step < tokens[i].size()) publish_token(*batch[i], tokens[i][step]);
         }
+    }
+
+    // Publish the final status, then record completion order for eviction,
+    // so no poller sees a job vanish while it still reads as RUNNING
+    Job::Clock::time_point now = Job::Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        Job& job = *batch[i];
+        job.end_time = now;
+        first_token_total_us += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            job.first_token_time - job.submit_time).count();
+        publish_status(job, STATUS_COMPLETE);
+    }
+    {
+        std::lock_guard<std::mutex> lock(history_mutex);
+        for (size_t i = 0; i < count; ++i) {
+            finished_order.push_back(batch[i]->job_id);
+        }
+        evict_finished_jobs(now);
+    }
 
-        process_job(current_job);
+    batch_count++;
+    if (count > 1) batched_job_count += count;
+    size_t seen = max_batch_seen.load();
+    while (count > seen && !max_batch_seen.compare_exchange_weak(seen, count)) {
     }
+    completed_jobs += count;
 }
 
 // ============================================================================
-// PROCESS JOB
+// JOB EVENT PUBLICATION
 // ============================================================================
-void Scheduler::process_job(Job& job) {
-    // Update status in history to RUNNING
-    Job* history_job = get_job(job.job_id);
-    if (history_job) {
-        history_job->status = STATUS_RUNNING;
+void Scheduler::publish_token(Job& job, const std::string& token) {
+    std::lock_guard<std::mutex> lock(job.stream_mutex);
+    if (job.result.empty()) job.first_token_time = Job::Clock::now();
+    job.result += token;
+    notify_listeners(job, JOB_EVENT_TOKEN, token);
+}
+
+void Scheduler::publish_status(Job& job, JobStatus status) {
+    std::lock_guard<std::mutex> lock(job.stream_mutex);
+    job.status = status;
+    notify_listeners(job, JOB_EVENT_STATUS, std::string());
+    if (status == STATUS_COMPLETE || status == STATUS_ERROR) {
+        job.listeners.clear();
     }
+}
+
+// Call every listener, dropping those that unsubscribe (stream_mutex held)
+void Scheduler::notify_listeners(Job& job, JobEventType type, const std::string& text) {
+    size_t kept = 0;
+    for (size_t i = 0; i < job.listeners.size(); ++i) {
+        if (!job.listeners[i](job, type, text)) continue;
+        if (kept != i) job.listeners[kept].swap(job.listeners[i]);
+        kept++;
+    }
+    job.listeners.resize(kept);
+}
+
+// ============================================================================
+// EVICT FINISHED JOBS (history_mutex must be held)
+// ============================================================================
+// finished_order is in completion order, so eviction only ever looks at its
+// front: amortized O(1) per completed job, and the table stays bounded by
+// the number of in-flight jobs plus history_retention.
+void Scheduler::evict_finished_jobs(Job::Clock::time_point now) {
+    while (!finished_order.empty()) {
+        std::unordered_map<uint32_t, JobRef>::iterator it = job_table.find(finished_order.front());
+        if (it == job_table.end()) {
+            finished_order.pop_front();
+            continue;
+        }
 
-    // Simulate work being done
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    job.result = "Job " + std::to_string(job.job_id) + " completed.";
+        bool over_count = config.history_retention > 0 &&
+                          finished_order.size() > config.history_retention;
+        bool expired = config.history_ttl_ms > 0 &&
+                       now - it->second->end_time > std::chrono::milliseconds(config.history_ttl_ms);
+        if (!over_count && !expired) break;
 
-    // Update final status in history to COMPLETE
-    if (history_job) {
-        history_job->status = STATUS_COMPLETE;
-        history_job->result = job.result;
+        job_table.erase(it);
+        finished_order.pop_front();
     }
 }
\ No newline at end of file
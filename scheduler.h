@@ -3,11 +3,16 @@
 
 #include <stdint.h>
 #include <string>
-#include <queue>
+#include <deque>
+#include <unordered_map>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <functional>
 #include <cstring>
 #include "config.h"
 
@@ -21,24 +26,117 @@ enum JobStatus {
     STATUS_ERROR    = 3
 };
 
+// ============================================================================
+// SCHEDULING POLICY
+// ============================================================================
+enum SchedulingPolicy {
+    POLICY_FIFO           = 0,  // Strict arrival order, priority ignored
+    POLICY_PRIORITY       = 1,  // Highest priority class first, with aging
+    POLICY_WORK_STEALING  = 2   // Per-worker deques, priority ignored, max throughput
+};
+
+// ============================================================================
+// SCHEDULER CONFIGURATION
+// ============================================================================
+struct SchedulerConfig {
+    SchedulingPolicy policy;
+    size_t num_workers;           // Worker threads started by start()
+    uint32_t aging_ms;            // 0 disables aging
+    uint32_t simulated_work_us;   // Per-job processing time
+    size_t history_retention;     // Max finished jobs kept; 0 keeps all
+    uint32_t history_ttl_ms;      // Finished jobs older than this are evicted; 0 disables
+    size_t batch_max_jobs;        // Same-weapon jobs run in one pass; 1 disables batching
+    uint32_t batch_wait_us;       // Wait for a batch to fill (shared-queue policies only)
+    uint32_t simulated_batch_item_us; // Extra processing time per additional batched job
+
+    SchedulerConfig()
+        : policy(POLICY_PRIORITY),
+          num_workers(MAX_WORKERS),
+          aging_ms(SCHED_AGING_MS),
+          simulated_work_us(SCHED_SIMULATED_WORK_MS * 1000),
+          history_retention(SCHED_HISTORY_RETENTION),
+          history_ttl_ms(SCHED_HISTORY_TTL_MS),
+          batch_max_jobs(SCHED_BATCH_MAX_JOBS),
+          batch_wait_us(SCHED_BATCH_WAIT_US),
+          simulated_batch_item_us(SCHED_SIMULATED_BATCH_ITEM_MS * 1000) {}
+};
+
+// ============================================================================
+// SCHEDULER METRICS
+// ============================================================================
+struct SchedulerMetrics {
+    size_t queue_depth[SCHED_NUM_PRIORITIES];     // Currently queued, per class
+    uint64_t dispatched[SCHED_NUM_PRIORITIES];    // Total dispatched, per class
+    uint64_t aged_dispatches;                     // Dispatched ahead of a higher class
+    uint64_t completed;                           // Jobs finished by workers
+    uint64_t steals;                              // Steal operations (work stealing only)
+    uint64_t batches;                             // Inference passes (including size 1)
+    uint64_t batched_jobs;                        // Jobs that shared a pass with others
+    size_t max_batch_size;                        // Largest pass so far
+    uint64_t batch_wait_us;                       // Total time spent waiting for batches to fill
+    uint64_t first_token_us;                      // Total submit-to-first-token time, over completed jobs
+    size_t batch_max_jobs;                        // Configured limits, for reporting
+    uint32_t batch_wait_limit_us;
+
+    SchedulerMetrics()
+        : aged_dispatches(0), completed(0), steals(0), batches(0), batched_jobs(0),
+          max_batch_size(0), batch_wait_us(0), first_token_us(0), batch_max_jobs(0), batch_wait_limit_us(0) {
+        memset(queue_depth, 0, sizeof(queue_depth));
+        memset(dispatched, 0, sizeof(dispatched));
+    }
+};
+
+// ============================================================================
+// JOB EVENTS
+// ============================================================================
+enum JobEventType {
+    JOB_EVENT_TOKEN  = 0,   // `text` was appended to Job::result
+    JOB_EVENT_STATUS = 1    // Job::status changed; `text` is empty
+};
+
+struct Job;
+
+// Called on the worker that produced the event with the job's stream_mutex
+// held, so events arrive in order. Must be quick and must not call back
+// into the scheduler. Returning false unsubscribes the listener.
+typedef std::function<bool(const Job& job, JobEventType type, const std::string& text)> JobListener;
+
 // ============================================================================
 // JOB STRUCTURE
+// One record per job, shared by the job table and the run queues through
+// JobRef and never copied, so the prompt is stored exactly once.
 // ============================================================================
 struct Job {
+    typedef std::chrono::steady_clock Clock;
+
     uint32_t job_id;
     std::string weapon_id;
     std::string prompt;
-    int priority;
+    int priority;               // Clamped to [0, SCHED_NUM_PRIORITIES - 1], higher runs first
     JobStatus status;
-    std::string result;
+    std::string result;         // Grows token by token while the job runs
     char error_message[256];
+    Clock::time_point submit_time;
+    Clock::time_point start_time;   // Set when a worker dequeues the job
+    Clock::time_point first_token_time;
+    Clock::time_point end_time;
+
+    // Guards result, status transitions and listeners
+    std::mutex stream_mutex;
+    std::vector<JobListener> listeners;
 
     // Constructor
     Job() : job_id(0), priority(0), status(STATUS_QUEUED) {
         memset(error_message, 0, sizeof(error_message));
     }
+
+    // Non-copyable: pass JobRef instead
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
 };
 
+typedef std::shared_ptr<Job> JobRef;
+
 // ============================================================================
 // SCHEDULER CLASS
 // ============================================================================
@@ -46,19 +144,34 @@ class Scheduler {
 public:
     // Constructor/Destructor
     Scheduler();
+    explicit Scheduler(const SchedulerConfig& config);
     ~Scheduler();
 
-    // Submit a job
+    // Submit a job. The rvalue overload takes ownership of the prompt
+    // without copying it; the const& overload copies it once.
     uint32_t submit_job(const std::string& weapon_id,
                         const std::string& prompt,
                         int priority = 0);
+    uint32_t submit_job(const std::string& weapon_id,
+                        std::string&& prompt,
+                        int priority = 0);
 
-    // Get job details
-    Job* get_job(uint32_t job_id);
+    // Get job details: a reference-counted handle, O(1), that stays valid
+    // after the retention policy evicts the job. Fields the worker updates
+    // (status, result) are read under the job's stream_mutex.
+    JobRef get_job_ref(uint32_t job_id);
 
     // Poll job status
     JobStatus poll_job(uint32_t job_id);
 
+    // Follow a job's output as it is produced. The listener is first called
+    // with the result so far (one TOKEN event, if any) and the current
+    // status, then with every later event until it returns false or the
+    // final STATUS event has been delivered. This is the per-job completion
+    // notification: nothing blocks while waiting. Returns false if the job
+    // is unknown.
+    bool subscribe_job(uint32_t job_id, const JobListener& listener);
+
     // Start/Stop scheduler
     void start();
     void stop();
@@ -66,23 +179,97 @@ public:
     // Get queue size
     size_t get_queue_size() const;
 
+    // Get number of queued jobs in one priority class
+    size_t get_queue_depth(int priority) const;
+
+    // Snapshot of per-class counters
+    SchedulerMetrics get_metrics() const;
+
+    // Number of jobs currently held in the job table
+    size_t get_history_size() const;
+
 private:
-    std::queue<Job> job_queue;
-    std::vector<Job> job_history;
+    // Work-stealing queue entry: submitters link nodes into an inbox
+    struct JobNode {
+        JobRef job;
+        JobNode* next;
+    };
+
+    // Per-worker state for POLICY_WORK_STEALING. Submitters push onto the
+    // inbox with a CAS (lock-free); consumers detach the whole inbox with an
+    // exchange, so there is no ABA hazard. The deque is touched only under
+    // `lock`, by its owner and by thieves.
+    struct WorkerQueue {
+        std::atomic<JobNode*> inbox;
+        char pad[64 - sizeof(std::atomic<JobNode*>)];
+        std::mutex lock;
+        std::deque<JobNode*> jobs;
+
+        WorkerQueue() : inbox(nullptr) {}
+    };
+
+    SchedulerConfig config;
+
+    // One FIFO per priority class; POLICY_FIFO uses only job_queues[0]
+    std::deque<JobRef> job_queues[SCHED_NUM_PRIORITIES];
+    std::vector<std::unique_ptr<WorkerQueue> > worker_queues;
+    std::atomic<size_t> next_worker_queue;
+    std::atomic<int> sleeping_workers;
+
+    // Counters are atomic so the work-stealing path never takes queue_mutex
+    std::atomic<size_t> queued_jobs;
+    std::atomic<size_t> queue_depth[SCHED_NUM_PRIORITIES];
+    std::atomic<uint64_t> dispatched[SCHED_NUM_PRIORITIES];
+    std::atomic<uint64_t> aged_dispatches;
+    std::atomic<uint64_t> completed_jobs;
+    std::atomic<uint64_t> steal_count;
+    std::atomic<uint64_t> batch_count;
+    std::atomic<uint64_t> batched_job_count;
+    std::atomic<size_t> max_batch_seen;
+    std::atomic<uint64_t> batch_wait_total_us;
+    std::atomic<uint64_t> first_token_total_us;
+    // Job table indexed by job_id. Finished ids are appended to
+    // finished_order for eviction.
+    std::unordered_map<uint32_t, JobRef> job_table;
+    std::deque<uint32_t> finished_order;
     std::vector<std::thread> workers;
 
     std::mutex queue_mutex;
     std::mutex history_mutex;
     std::condition_variable job_available;
 
-    volatile bool running;
-    uint32_t next_job_id;
+    std::atomic<bool> running;
+    std::atomic<uint32_t> next_job_id;
 
-    // Worker thread main loop
+    // Worker thread main loop (POLICY_FIFO / POLICY_PRIORITY)
     void worker_thread();
 
-    // Process individual job
-    void process_job(Job& job);
+    // Worker thread main loop (POLICY_WORK_STEALING)
+    void stealing_worker_thread(size_t self);
+
+    // Dequeue the next job according to the policy (queue_mutex held)
+    bool pop_next_job(JobRef& job);
+
+    // Grow a batch with queued jobs sharing its weapon_id (queue_mutex held)
+    void take_compatible_jobs(std::vector<JobRef>& batch);
+    void collect_batch(std::unique_lock<std::mutex>& lock, std::vector<JobRef>& batch);
+
+    // Work-stealing helpers
+    static void drain_inbox(WorkerQueue& q);
+    JobNode* take_local_job(size_t self, std::vector<JobRef>& batch);
+    JobNode* steal_job(size_t self);
+    void account_dispatch(Job& job);
+
+    // Run a batch of same-weapon jobs in one pass and publish each result
+    void process_batch(std::vector<JobRef>& batch);
+
+    // Append a token / change status, notifying the job's listeners
+    void publish_token(Job& job, const std::string& token);
+    void publish_status(Job& job, JobStatus status);
+    static void notify_listeners(Job& job, JobEventType type, const std::string& text);
+
+    // Drop finished jobs beyond the retention limits (history_mutex held)
+    void evict_finished_jobs(Job::Clock::time_point now);
 };
 
 #endif // AGNI_SCHEDULER_H
\ No newline at end of file
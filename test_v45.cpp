@@ -1,14 +1,28 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 #include "common.h"
 #include "config.h"
 #include "vector_utils.h"
+#include "rvv_1024.h"
+#include "mamba_ssm.h"
 #include "scheduler.h"
 #include "api_gateway.h"
+#include "http_server.h"
+#include "json_codec.h"
+#include "agni_hal.h"
+#include "agni_scheduler_hw.h"
+#include "agni_task_ring.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 // ============================================================================
 // TEST RUNNER
@@ -101,6 +115,1204 @@ void test_simd_tanh_f64() {
     assert(abs(dst[2] - 0.761594) < 1e-5);
 }
 
+void test_simd_dispatch_levels() {
+    // Odd offsets and lengths exercise unaligned loads and every tail path
+    const size_t max_len = 67;
+    std::vector<double> a(max_len + 1), b(max_len + 1);
+    for (size_t i = 0; i <= max_len; ++i) {
+        a[i] = (double)((int)(i * 7 % 23) - 11) * 0.37;
+        b[i] = (double)((int)(i * 5 % 19) - 9) * 1.13;
+    }
+    a[3] = -0.0;
+    const double* x = &a[1];
+    const double* y = &b[1];
+
+    SimdLevel original = simd_get_level();
+    assert(original == simd_detect_level());
+
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        assert(simd_set_level((SimdLevel)lvl) == (SimdLevel)lvl);
+        for (size_t len = 0; len <= max_len - 1; ++len) {
+            std::vector<double> sum(len + 1), prod(len + 1), relu(len + 1);
+            simd_add_f64(&sum[1], x, y, len);
+            simd_mul_f64(&prod[1], x, y, len);
+            simd_relu_f64(&relu[1], x, len);
+
+            double expected_dot = 0.0, magnitude = 0.0;
+            for (size_t i = 0; i < len; ++i) {
+                assert(sum[i + 1] == x[i] + y[i]);
+                assert(prod[i + 1] == x[i] * y[i]);
+                assert(relu[i + 1] == ((x[i] > 0.0) ? x[i] : 0.0));
+                assert(!std::signbit(relu[i + 1]));
+                expected_dot += x[i] * y[i];
+                magnitude += std::fabs(x[i] * y[i]);
+            }
+            // Reassociated sum: bounded relative to the sum of magnitudes
+            double dot = simd_dot_f64(x, y, len);
+            assert(std::fabs(dot - expected_dot) <= 1e-13 * (magnitude + 1.0));
+        }
+    }
+
+    assert(simd_set_level(SIMD_LEVEL_AVX512) == simd_detect_level());
+    simd_set_level(original);
+}
+
+// Distance between two doubles in representable values; 0 for NaN == NaN
+static uint64_t ulp_distance(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) return (std::isnan(a) && std::isnan(b)) ? 0 : UINT64_MAX;
+    if (a == b) return 0;
+    int64_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) ia = INT64_MIN - ia;
+    if (ib < 0) ib = INT64_MIN - ib;
+    return (ia > ib) ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+}
+
+// Max ULP error of f against libm_f over xs
+static uint64_t max_ulp_error(void (*f)(double*, const double*, size_t), double (*libm_f)(double),
+                              const std::vector<double>& xs) {
+    std::vector<double> out(xs.size());
+    f(out.data(), xs.data(), xs.size());
+    uint64_t worst = 0;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        worst = std::max(worst, ulp_distance(out[i], libm_f(xs[i])));
+    }
+    return worst;
+}
+
+static double libm_exp(double x) { return std::exp(x); }
+static double libm_tanh(double x) { return std::tanh(x); }
+
+void test_simd_transcendental_accuracy() {
+    // Dense sweeps over each function's full range, tiny and subnormal
+    // magnitudes, and special values
+    std::vector<double> exp_xs, tanh_xs;
+    for (int i = 0; i <= 400000; ++i) {
+        exp_xs.push_back(-745.5 + 1455.5 * i / 400000.0);
+        tanh_xs.push_back(-25.0 + 50.0 * i / 400000.0);
+    }
+    for (double m = 1e-300; m < 1.0; m *= 1.7) {
+        exp_xs.push_back(m);
+        exp_xs.push_back(-m);
+        tanh_xs.push_back(m);
+        tanh_xs.push_back(-m);
+    }
+    const double specials[] = {0.0, -0.0, 4.9e-324, 709.78, 709.79, -708.4, -744.44, -745.14, -746.0,
+                               1e308, -1e308, INFINITY, -INFINITY, NAN};
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); ++i) {
+        exp_xs.push_back(specials[i]);
+        tanh_xs.push_back(specials[i]);
+    }
+
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_AVX2; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        assert(max_ulp_error(simd_exp_f64, libm_exp, exp_xs) <= SIMD_EXP_MAX_ULP);
+        assert(max_ulp_error(simd_tanh_f64, libm_tanh, tanh_xs) <= SIMD_TANH_MAX_ULP);
+
+        // Signed zeros survive tanh
+        double z[2] = {-0.0, 0.0}, tz[2];
+        simd_tanh_f64(tz, z, 2);
+        assert(std::signbit(tz[0]) && !std::signbit(tz[1]));
+
+        // GELU against the same formula in long double: relative error
+        // stays small even where 1 + tanh(u) would cancel
+        std::vector<double> gx, gy;
+        for (int i = 0; i <= 20000; ++i) gx.push_back(-40.0 + 80.0 * i / 20000.0);
+        gy.resize(gx.size());
+        simd_gelu_f64(gy.data(), gx.data(), gx.size());
+        for (size_t i = 0; i < gx.size(); ++i) {
+            long double x = gx[i];
+            long double u = 0.7978845608028654L * (x + 0.044715L * x * x * x);
+            long double ref = x / (1.0L + expl(-2.0L * u));
+            assert(std::fabs((long double)gy[i] - ref) <= 1e-12L * std::fabs(ref) + 1e-300L);
+        }
+
+        // Softmax sums to one and matches the scalar path
+        std::vector<double> logits(37), scalar_out(37);
+        for (size_t i = 0; i < logits.size(); ++i) logits[i] = std::sin((double)i) * 30.0;
+        logits[5] = -INFINITY;
+        std::vector<double> vec_out = logits;
+        simd_softmax_f64(vec_out.data(), vec_out.size());
+        simd_set_level(SIMD_LEVEL_SCALAR);
+        scalar_out = logits;
+        simd_softmax_f64(scalar_out.data(), scalar_out.size());
+        simd_set_level((SimdLevel)lvl);
+        double sum = 0.0;
+        for (size_t i = 0; i < vec_out.size(); ++i) {
+            sum += vec_out[i];
+            assert(std::fabs(vec_out[i] - scalar_out[i]) <= 1e-15 + 1e-14 * scalar_out[i]);
+        }
+        assert(vec_out[5] == 0.0);
+        assert(std::fabs(sum - 1.0) < 1e-12);
+    }
+    simd_set_level(original);
+}
+
+
+// Three-pass softmax in long double as the reference
+static std::vector<double> reference_softmax(const std::vector<double>& x, double temperature) {
+    long double m = -INFINITY, sum = 0.0L;
+    for (size_t i = 0; i < x.size(); ++i) m = std::max(m, (long double)x[i]);
+    std::vector<long double> e(x.size());
+    for (size_t i = 0; i < x.size(); ++i) sum += (e[i] = expl(((long double)x[i] - m) / temperature));
+    std::vector<double> out(x.size());
+    for (size_t i = 0; i < x.size(); ++i) out[i] = (double)(e[i] / sum);
+    return out;
+}
+
+void test_simd_softmax_variants() {
+    // Rising logits move the running max in every block; the tail block is partial
+    std::vector<double> logits(1000);
+    for (size_t i = 0; i < logits.size(); ++i) logits[i] = std::sin((double)i * 0.7) * 8.0 + (double)i * 0.01;
+    logits[17] = -INFINITY;
+
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        for (size_t len = 1; len <= logits.size(); len += (len < 70) ? 1 : 233) {
+            std::vector<double> x(logits.begin(), logits.begin() + len);
+            std::vector<double> ref = reference_softmax(x, 1.0);
+
+            std::vector<double> p = x;
+            simd_softmax_f64(p.data(), len);
+            std::vector<double> lp = x;
+            simd_log_softmax_f64(lp.data(), len);
+            std::vector<double> t2 = x;
+            simd_softmax_temperature_f64(t2.data(), len, 2.0);
+            std::vector<double> ref_t2 = reference_softmax(x, 2.0);
+
+            for (size_t i = 0; i < len; ++i) {
+                assert(std::fabs(p[i] - ref[i]) <= 1e-14 * ref[i] + 1e-300);
+                assert(std::fabs(t2[i] - ref_t2[i]) <= 1e-14 * ref_t2[i] + 1e-300);
+                if (ref[i] > 0.0) assert(std::fabs(lp[i] - std::log(ref[i])) <= 1e-12 * (1.0 + std::fabs(lp[i])));
+            }
+            if (len > 17) assert(p[17] == 0.0 && lp[17] == -INFINITY);
+        }
+
+        // Temperature 1 matches plain softmax; 0 is greedy
+        std::vector<double> a = logits, b = logits, g = logits;
+        simd_softmax_f64(a.data(), a.size());
+        simd_softmax_temperature_f64(b.data(), b.size(), 1.0);
+        assert(a == b);
+        simd_softmax_temperature_f64(g.data(), g.size(), 0.0);
+        size_t best = std::max_element(logits.begin(), logits.end()) - logits.begin();
+        for (size_t i = 0; i < g.size(); ++i) assert(g[i] == (i == best ? 1.0 : 0.0));
+    }
+    simd_set_level(original);
+}
+
+void test_simd_sample() {
+    // Probabilities 0.5, 0.3, 0.2 behind two distractors at -inf
+    const double small[] = {std::log(0.3), -INFINITY, std::log(0.5), std::log(0.2), -INFINITY};
+    const size_t n = 5;
+
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+
+        // Unrestricted: the uniform point walks the vocabulary in index order
+        assert(simd_sample_f64(small, n, 0, 1.0, 1.0, 0.10) == 0);
+        assert(simd_sample_f64(small, n, 0, 1.0, 1.0, 0.50) == 2);
+        assert(simd_sample_f64(small, n, 0, 1.0, 1.0, 0.95) == 3);
+
+        // Greedy: zero temperature, top-k 1, or a vanishing top-p
+        assert(simd_sample_f64(small, n, 0, 1.0, 0.0, 0.99) == 2);
+        assert(simd_sample_f64(small, n, 1, 1.0, 1.0, 0.99) == 2);
+        assert(simd_sample_f64(small, n, 0, 1e-9, 1.0, 0.99) == 2);
+
+        // Top-p 0.75 keeps {0.5, 0.3}; top-k 2 with top-p 0.6 renormalizes
+        // to {0.625, 0.375} and keeps only the first
+        for (double u = 0.0; u < 1.0; u += 0.05) {
+            assert(simd_sample_f64(small, n, 0, 0.75, 1.0, u) != 3);
+            assert(simd_sample_f64(small, n, 2, 0.6, 1.0, u) == 2);
+        }
+        assert(simd_sample_f64(small, n, 0, 0.75, 1.0, 0.99) == 0);
+
+        // Vocabulary-sized, flat enough that the nucleus outgrows the probe:
+        // the sampled tokens must be exactly the nucleus, with frequencies
+        // close to their renormalized probabilities
+        std::vector<double> logits(MAMBA_VOCAB_SIZE);
+        for (size_t i = 0; i < logits.size(); ++i) logits[i] = std::sin((double)i * 1.3) * 3.0;
+        const double top_p = 0.5, temperature = 0.9;
+        std::vector<double> probs = reference_softmax(logits, temperature);
+        std::vector<size_t> order(logits.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+            return logits[x] > logits[y] || (logits[x] == logits[y] && x < y);
+        });
+        std::vector<bool> in_nucleus(logits.size(), false);
+        double mass = 0.0;
+        size_t nucleus = 0;
+        while (mass < top_p) {
+            mass += probs[order[nucleus]];
+            in_nucleus[order[nucleus++]] = true;
+        }
+        assert(nucleus > 64);
+
+        const int draws = 400;
+        double top_freq = 0.0;
+        for (int d = 0; d < draws; ++d) {
+            double u = (d + 0.5) / draws;
+            size_t tok = simd_sample_f64(logits.data(), logits.size(), 0, top_p, temperature, u);
+            assert(tok < logits.size() && in_nucleus[tok]);
+            if (tok == order[0]) top_freq += 1.0 / draws;
+        }
+        assert(std::fabs(top_freq - probs[order[0]] / mass) < 0.01);
+    }
+    simd_set_level(original);
+}
+
+void test_simd_fused() {
+    const size_t lengths[] = {0, 5, 513, 3079};     // Partial tiles and vector tails
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+            size_t n = lengths[l];
+            std::vector<double> a(n), b(n), c(n), fused(n), ref(n);
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = std::sin((double)i * 0.7) * 3.0;
+                b[i] = std::cos((double)i * 0.3);
+                c[i] = (double)(i % 11) * 0.1 - 0.5;
+            }
+
+            // gelu(a * b + c), bit-identical to the unfused calls
+            SimdFusedOp gelu_chain[] = { {SIMD_OP_MUL, b.data(), 0, 0}, {SIMD_OP_ADD, c.data(), 0, 0},
+                                         {SIMD_OP_GELU, NULL, 0, 0} };
+            simd_fused_f64(fused.data(), a.data(), n, gelu_chain, 3);
+            simd_mul_f64(ref.data(), a.data(), b.data(), n);
+            simd_add_f64(ref.data(), ref.data(), c.data(), n);
+            simd_gelu_f64(ref.data(), ref.data(), n);
+            assert(fused == ref);
+
+            // In place, through every unary op
+            SimdFusedOp unary_chain[] = { {SIMD_OP_TANH, NULL, 0, 0}, {SIMD_OP_AFFINE, NULL, 2.0, -0.25},
+                                          {SIMD_OP_RELU, NULL, 0, 0}, {SIMD_OP_EXP, NULL, 0, 0} };
+            fused = a;
+            simd_fused_f64(fused.data(), fused.data(), n, unary_chain, 4);
+            for (size_t i = 0; i < n; ++i) {
+                double x = std::fma(std::tanh(a[i]), 2.0, -0.25);
+                assert(std::fabs(fused[i] - std::exp(x > 0.0 ? x : 0.0)) <= 1e-14 * 8.0);
+            }
+
+            // An empty chain copies
+            simd_fused_f64(fused.data(), a.data(), n, NULL, 0);
+            assert(fused == a);
+        }
+    }
+    simd_set_level(original);
+}
+
+void test_simd_parallel() {
+    // Vocab-sized, with a partial last chunk and a partial last block
+    const size_t n = 3 * SIMD_PARALLEL_CHUNK + 1001;
+    std::vector<double> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = std::sin((double)i * 0.013) * 8.0;
+        b[i] = std::cos((double)i * 0.007);
+    }
+    std::vector<double> serial_map(n), serial_soft(a), serial_log(a);
+    simd_gelu_f64(serial_map.data(), a.data(), n);
+    double serial_dot = simd_dot_f64(a.data(), b.data(), n);
+    simd_softmax_f64(serial_soft.data(), n);
+    simd_log_softmax_f64(serial_log.data(), n);
+
+    std::vector<double> first_soft;
+    double first_dot = 0.0;
+    for (size_t threads = 2; threads <= 4; ++threads) {
+        simd_set_parallel(threads, SIMD_PARALLEL_CHUNK);
+        assert(simd_get_parallel_threads() == threads);
+
+        // Maps split on chunk boundaries: bit-identical to serial
+        std::vector<double> map(n);
+        simd_gelu_f64(map.data(), a.data(), n);
+        assert(map == serial_map);
+
+        // Reductions merge in chunk order: identical across thread counts
+        double dot = simd_dot_f64(a.data(), b.data(), n);
+        std::vector<double> soft(a), log_soft(a);
+        simd_softmax_f64(soft.data(), n);
+        simd_log_softmax_f64(log_soft.data(), n);
+        if (threads == 2) {
+            first_dot = dot;
+            first_soft = soft;
+        }
+        assert(dot == first_dot);
+        assert(soft == first_soft);
+        assert(std::fabs(dot - serial_dot) <= 1e-9 * std::fabs(serial_dot));
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            assert(std::fabs(soft[i] - serial_soft[i]) <= 1e-12 * serial_soft[i] + 1e-300);
+            assert(std::fabs(log_soft[i] - serial_log[i]) <= 1e-12);
+            sum += soft[i];
+        }
+        assert(std::fabs(sum - 1.0) < 1e-9);
+    }
+
+    // Below the threshold the call stays serial
+    simd_set_parallel(4, 2 * n);
+    std::vector<double> soft(a);
+    simd_softmax_f64(soft.data(), n);
+    assert(soft == serial_soft);
+    simd_set_parallel(1, 0);
+    assert(simd_get_parallel_threads() == 1);
+}
+
+void test_simd_variants() {
+    const size_t lengths[] = {0, 1, 64, 67};
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+            size_t n = lengths[l];
+            std::vector<double> a(n + 1), b(n + 1), ref(n + 1), out(n + 1, -7.0);
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = std::sin((double)i * 0.7) * 3.0;
+                b[i] = std::cos((double)i * 0.3);
+            }
+
+            simd_add_f64(ref.data(), a.data(), b.data(), n);
+            simd_add_f64_restrict(out.data(), a.data(), b.data(), n);
+            assert(std::equal(ref.begin(), ref.begin() + n, out.begin()));
+            assert(out[n] == -7.0);     // Nothing written past len
+            simd_add_f64_unchecked(out.data(), a.data(), b.data(), n);
+            assert(std::equal(ref.begin(), ref.begin() + n, out.begin()));
+            out = a;
+            simd_add_inplace_f64(out.data(), b.data(), n);
+            assert(std::equal(ref.begin(), ref.begin() + n, out.begin()));
+
+            simd_mul_f64(ref.data(), a.data(), b.data(), n);
+            simd_mul_f64_restrict(out.data(), a.data(), b.data(), n);
+            assert(std::equal(ref.begin(), ref.begin() + n, out.begin()));
+            simd_mul_f64_unchecked(out.data(), a.data(), b.data(), n);
+            assert(std::equal(ref.begin(), ref.begin() + n, out.begin()));
+            out = a;
+            simd_mul_inplace_f64(out.data(), b.data(), n);
+            assert(std::equal(ref.begin(), ref.begin() + n, out.begin()));
+
+            assert(simd_dot_f64_unchecked(a.data(), b.data(), n) == simd_dot_f64(a.data(), b.data(), n));
+        }
+    }
+    simd_set_level(original);
+
+    // The in-place calls keep the NULL checks
+    double x = 1.0;
+    simd_add_inplace_f64(NULL, &x, 1);
+    simd_mul_inplace_f64(&x, NULL, 1);
+    assert(x == 1.0);
+}
+
+// Distance between two floats in representable values
+static uint32_t ulp_distance_f32(float a, float b) {
+    if (std::isnan(a) || std::isnan(b)) return (std::isnan(a) && std::isnan(b)) ? 0 : UINT32_MAX;
+    if (a == b) return 0;
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) ia = INT32_MIN - ia;
+    if (ib < 0) ib = INT32_MIN - ib;
+    return (ia > ib) ? (uint32_t)ia - (uint32_t)ib : (uint32_t)ib - (uint32_t)ia;
+}
+
+static double gelu_ref(double x) {
+    double u = 0.7978845608028654 * (x + 0.044715 * x * x * x);
+    return x / (1.0 + std::exp(-2.0 * u));
+}
+
+void test_simd_reduced_precision() {
+    // bf16 rounds to nearest even and keeps NaN/inf
+    assert(f32_to_bf16(1.0f) == 0x3f80);
+    assert(f32_to_bf16(1.0f + 1.0f / 256.0f) == 0x3f80);
+    assert(f32_to_bf16(1.0f + 3.0f / 256.0f) == 0x3f82);
+    assert(f32_to_bf16(-2.5f) == 0xc020);
+    assert(std::isnan(bf16_to_f32(f32_to_bf16(NAN))));
+    assert(bf16_to_f32(f32_to_bf16(INFINITY)) == INFINITY);
+
+    const size_t n = 1003;      // Tails at every vector width
+    std::vector<float> x(n), y(n), out(n);
+    std::vector<bf16> xb(n), yb(n), outb(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = (float)(std::sin((double)i * 0.37) * 6.0);
+        y[i] = (float)(std::cos((double)i * 0.11) * 3.0);
+    }
+    simd_f32_to_bf16(xb.data(), x.data(), n);
+    simd_f32_to_bf16(yb.data(), y.data(), n);
+
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+
+        // f32 add/mul are correctly rounded
+        simd_add_f32(out.data(), x.data(), y.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(out[i] == (float)((double)x[i] + (double)y[i]));
+        simd_mul_f32(out.data(), x.data(), y.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(out[i] == (float)((double)x[i] * (double)y[i]));
+        simd_relu_f32(out.data(), x.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(out[i] == std::max(x[i], 0.0f));
+
+        // Dots against the f64 dot of the same values
+        double ref = 0.0, mag = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            ref += (double)x[i] * (double)y[i];
+            mag += std::fabs((double)x[i] * (double)y[i]);
+        }
+        assert(std::fabs(simd_dot_f32(x.data(), y.data(), n) - ref) <= 1e-5 * mag);
+        double ref_b = 0.0;
+        for (size_t i = 0; i < n; ++i) ref_b += (double)bf16_to_f32(xb[i]) * (double)bf16_to_f32(yb[i]);
+        assert(std::fabs(simd_dot_bf16(xb.data(), yb.data(), n) - ref_b) <= 1e-5 * mag);
+
+        // Transcendentals: within 1 ULP of the f64 result rounded to f32
+        simd_exp_f32(out.data(), x.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(ulp_distance_f32(out[i], (float)std::exp((double)x[i])) <= 1);
+        simd_tanh_f32(out.data(), x.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(ulp_distance_f32(out[i], (float)std::tanh((double)x[i])) <= 1);
+        simd_gelu_f32(out.data(), x.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(ulp_distance_f32(out[i], (float)gelu_ref(x[i])) <= 1);
+
+        std::vector<double> soft(x.begin(), x.end());
+        simd_softmax_f64(soft.data(), n);
+        out = x;
+        simd_softmax_f32(out.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(std::fabs(out[i] - soft[i]) <= soft[i] * 1e-6 + 1e-12);
+
+        // bf16 results are the f32 ones rounded to bf16, to within a ULP
+        simd_add_bf16(outb.data(), xb.data(), yb.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            assert(outb[i] == f32_to_bf16(bf16_to_f32(xb[i]) + bf16_to_f32(yb[i])));
+        }
+        simd_gelu_bf16(outb.data(), xb.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            float r = (float)gelu_ref(bf16_to_f32(xb[i]));
+            assert(ulp_distance_f32(bf16_to_f32(outb[i]), bf16_to_f32(f32_to_bf16(r))) <= 0x10000);
+        }
+        std::vector<double> softb(n);
+        for (size_t i = 0; i < n; ++i) softb[i] = bf16_to_f32(xb[i]);
+        simd_softmax_f64(softb.data(), n);
+        outb = xb;
+        simd_softmax_bf16(outb.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(std::fabs(bf16_to_f32(outb[i]) - softb[i]) <= softb[i] / 256.0 + 1e-12);
+
+        // int8 dot is exact at every length
+        std::vector<int8_t> qa(200), qb(200);
+        for (size_t i = 0; i < qa.size(); ++i) {
+            qa[i] = (int8_t)((int)(i * 37 % 255) - 127);
+            qb[i] = (int8_t)((int)(i * 91 % 255) - 127);
+        }
+        for (size_t len = 0; len <= qa.size(); len += 7) {
+            int32_t exact = 0;
+            for (size_t i = 0; i < len; ++i) exact += (int32_t)qa[i] * (int32_t)qb[i];
+            assert(simd_dot_i8(qa.data(), qb.data(), len) == exact);
+        }
+    }
+    simd_set_level(original);
+
+    // Per-row quantization round-trips within half a step
+    const size_t rows = 3, cols = 50;
+    std::vector<float> m(rows * cols), back(rows * cols), scales(rows);
+    std::vector<int8_t> q(rows * cols);
+    for (size_t i = 0; i < cols; ++i) {
+        m[i] = (float)std::sin((double)i) * 0.01f;
+        m[cols + i] = (float)std::cos((double)i) * 40.0f;
+        m[2 * cols + i] = 0.0f;
+    }
+    simd_quantize_i8(q.data(), scales.data(), m.data(), rows, cols);
+    simd_dequantize_i8(back.data(), q.data(), scales.data(), rows, cols);
+    assert(scales[2] == 0.0f);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            assert(q[r * cols + c] >= -127);
+            assert(std::fabs(back[r * cols + c] - m[r * cols + c]) <= scales[r] * 0.5f * 1.0001f);
+        }
+    }
+}
+
+// ============================================================================
+// VEC1024 HOST BACKEND TESTS
+// ============================================================================
+void test_simd_dot_lanes16() {
+    std::vector<double> a(203), b(203);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = std::sin((double)i) * 1e3;
+        b[i] = std::cos((double)i * 0.3) * 1e-3;
+    }
+
+    SimdLevel original = simd_get_level();
+    for (size_t len = 0; len <= a.size(); len += (len < 40) ? 1 : 37) {
+        // Scalar reference in the documented order
+        double lanes[16] = {0.0};
+        for (size_t i = 0; i < len; ++i) lanes[i % 16] = std::fma(a[i], b[i], lanes[i % 16]);
+        for (int w = 8; w >= 1; w /= 2) {
+            for (int l = 0; l < w; ++l) lanes[l] += lanes[l + w];
+        }
+        for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+            simd_set_level((SimdLevel)lvl);
+            assert(simd_dot_lanes16_f64(a.data(), b.data(), len) == lanes[0]);
+        }
+    }
+    simd_set_level(original);
+}
+
+void test_vec1024_backend() {
+    const size_t n = 37;     // Two full strips and a partial one
+    Vec1024_f64* x = vec1024_create(n);
+    Vec1024_f64* y = vec1024_create(n);
+    Vec1024_f64* z = vec1024_create(n);
+    assert(x && y && z && x->length == n);
+    assert(((uintptr_t)x->data % VEC1024_ALIGN) == 0);
+    for (size_t i = 0; i < VEC1024_STRIPS(n) * VEC1024_LANES; ++i) assert(x->data[i] == 0.0);
+
+    for (size_t i = 0; i < n; ++i) {
+        x->data[i] = (double)i - 18.0;
+        y->data[i] = 0.5 * (double)i;
+    }
+    vec1024_add(z, x, y);
+    for (size_t i = 0; i < n; ++i) assert(z->data[i] == x->data[i] + y->data[i]);
+    vec1024_mul(z, x, y);
+    for (size_t i = 0; i < n; ++i) assert(z->data[i] == x->data[i] * y->data[i]);
+
+    double dot = 0.0;
+    vec1024_dot(&dot, x, y);
+    assert(dot == simd_dot_lanes16_f64(x->data, y->data, n));
+
+    // Padding stays zero and is excluded from the softmax normalizer
+    memcpy(z->data, x->data, n * sizeof(double));
+    vec1024_relu(z);
+    for (size_t i = 0; i < n; ++i) assert(z->data[i] == std::max(x->data[i], 0.0));
+    vec1024_softmax(z);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += z->data[i];
+    assert(std::fabs(sum - 1.0) < 1e-12);
+    for (size_t i = n; i < VEC1024_STRIPS(n) * VEC1024_LANES; ++i) assert(z->data[i] == 0.0);
+
+    std::vector<double> g(x->data, x->data + n);
+    simd_gelu_f64(g.data(), g.data(), n);
+    vec1024_gelu(x);
+    for (size_t i = 0; i < n; ++i) assert(x->data[i] == g[i]);
+
+    // Mismatched lengths leave dest untouched
+    Vec1024_f64* shorter = vec1024_create(n - 1);
+    std::vector<double> before(z->data, z->data + n);
+    vec1024_add(z, shorter, y);
+    assert(std::equal(before.begin(), before.end(), z->data));
+    dot = 42.0;
+    vec1024_dot(&dot, shorter, y);
+    assert(dot == 42.0);
+
+    Vec1024_f64* empty = vec1024_create(0);
+    assert(empty && empty->length == 0);
+    vec1024_dot(&dot, empty, empty);
+    assert(dot == 0.0);
+
+    vec1024_free(empty);
+    vec1024_free(shorter);
+    vec1024_free(x);
+    vec1024_free(y);
+    vec1024_free(z);
+    vec1024_free(NULL);
+}
+
+void test_vec1024_matmul() {
+    // Edge tiles in both dimensions, several K blocks, and a K = 0 product
+    const size_t shapes[][3] = { {5, 35, 19}, {29, 37, 411}, {100, 17, 200}, {3, 4, 0} };
+    SimdLevel original = simd_get_level();
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s) {
+        const size_t M = shapes[s][0], N = shapes[s][1], K = shapes[s][2];
+        std::vector<double> A(M * K), B(K * N), C(M * N);
+        for (size_t i = 0; i < A.size(); ++i) A[i] = std::sin((double)i * 0.9);
+        for (size_t i = 0; i < B.size(); ++i) B[i] = std::cos((double)i * 0.4);
+
+        // Ascending-k fused multiply-add per element, bit for bit
+        std::vector<double> ref(M * N);
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                double acc = 0.0;
+                for (size_t k = 0; k < K; ++k) acc = std::fma(A[i * K + k], B[k * N + j], acc);
+                ref[i * N + j] = acc;
+            }
+        }
+
+        for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+            simd_set_level((SimdLevel)lvl);
+            for (size_t threads = 1; threads <= 3; threads += 2) {
+                vec1024_set_gemm_threads(threads);
+                std::fill(C.begin(), C.end(), -1.0);
+                vec1024_matmul(C.data(), A.data(), B.data(), M, N, K);
+                assert(C == ref);
+            }
+        }
+    }
+    vec1024_set_gemm_threads(0);
+    simd_set_level(original);
+}
+
+void test_vec1024_matmul_reduced() {
+    const size_t shapes[][3] = { {5, 35, 19}, {29, 67, 411}, {100, 40, 200}, {3, 4, 0} };
+    SimdLevel original = simd_get_level();
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s) {
+        const size_t M = shapes[s][0], N = shapes[s][1], K = shapes[s][2];
+        std::vector<float> A(M * K), B(K * N), C(M * N), Cb(M * N), Wt(N * K);
+        for (size_t i = 0; i < A.size(); ++i) A[i] = (float)std::sin((double)i * 0.9);
+        for (size_t i = 0; i < B.size(); ++i) B[i] = (float)std::cos((double)i * 0.4);
+        std::vector<bf16> Ab(M * K), Bb(K * N);
+        simd_f32_to_bf16(Ab.data(), A.data(), A.size());
+        simd_f32_to_bf16(Bb.data(), B.data(), B.size());
+        std::vector<float> Aw(M * K), Bw(K * N);
+        simd_bf16_to_f32(Aw.data(), Ab.data(), Ab.size());
+        simd_bf16_to_f32(Bw.data(), Bb.data(), Bb.size());
+
+        // int8 operands: per-row A scales, per-output-channel W scales
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t j = 0; j < N; ++j) Wt[j * K + k] = B[k * N + j];
+        }
+        std::vector<int8_t> Aq(M * K), Wq(N * K);
+        std::vector<float> a_scales(M), w_scales(N), Ci(M * N);
+        simd_quantize_i8(Aq.data(), a_scales.data(), A.data(), M, K);
+        simd_quantize_i8(Wq.data(), w_scales.data(), Wt.data(), N, K);
+
+        // Ascending-k fmaf per element, bit for bit; f64 for the accuracy check
+        std::vector<float> ref(M * N), ref_b(M * N), ref_i(M * N);
+        std::vector<double> ref64(M * N), bound_i(M * N);
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                float acc = 0.0f, acc_b = 0.0f;
+                double acc64 = 0.0, mag = 0.0, qerr = 0.0;
+                int32_t acc_i = 0;
+                for (size_t k = 0; k < K; ++k) {
+                    acc = std::fma(A[i * K + k], B[k * N + j], acc);
+                    acc_b = std::fma(Aw[i * K + k], Bw[k * N + j], acc_b);
+                    acc64 += (double)A[i * K + k] * (double)B[k * N + j];
+                    mag += std::fabs((double)A[i * K + k] * (double)B[k * N + j]);
+                    acc_i += (int32_t)Aq[i * K + k] * (int32_t)Wq[j * K + k];
+                    qerr += std::fabs(A[i * K + k]) * w_scales[j] + std::fabs(B[k * N + j]) * a_scales[i];
+                }
+                ref[i * N + j] = acc;
+                ref_b[i * N + j] = acc_b;
+                ref_i[i * N + j] = (float)acc_i * (a_scales[i] * w_scales[j]);
+                ref64[i * N + j] = acc64;
+                assert(std::fabs(acc - acc64) <= 1e-5 * mag + 1e-30);
+                bound_i[i * N + j] = 0.5 * qerr + 0.25 * K * a_scales[i] * w_scales[j] + 1e-5 * mag;
+            }
+        }
+
+        for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+            simd_set_level((SimdLevel)lvl);
+            for (size_t threads = 1; threads <= 3; threads += 2) {
+                vec1024_set_gemm_threads(threads);
+                std::fill(C.begin(), C.end(), -1.0f);
+                std::fill(Cb.begin(), Cb.end(), -1.0f);
+                std::fill(Ci.begin(), Ci.end(), -1.0f);
+                vec1024_matmul_f32(C.data(), A.data(), B.data(), M, N, K);
+                vec1024_matmul_bf16(Cb.data(), Ab.data(), Bb.data(), M, N, K);
+                vec1024_matmul_i8(Ci.data(), Aq.data(), a_scales.data(), Wq.data(), w_scales.data(), M, N, K);
+                assert(C == ref);
+                assert(Cb == ref_b);
+                assert(Ci == ref_i);
+                for (size_t i = 0; i < Ci.size(); ++i) assert(std::fabs(Ci[i] - ref64[i]) <= bound_i[i]);
+            }
+        }
+    }
+    vec1024_set_gemm_threads(0);
+    simd_set_level(original);
+}
+
+// ============================================================================
+// MAMBA SCAN TESTS
+// ============================================================================
+void test_mamba_selective_scan() {
+    // Odd d_model exercises the vector tails; 203 tokens give uneven chunks
+    const size_t dm = 37, ds = MAMBA_STATE_SIZE, T = 203;
+    std::vector<double> A(ds * dm), D(dm), u(T * dm), delta(T * dm), B(T * ds), C(T * ds);
+    for (size_t i = 0; i < A.size(); ++i) A[i] = -(double)(1 + i / dm) * (0.5 + 0.01 * (double)(i % dm));
+    for (size_t d = 0; d < dm; ++d) D[d] = 0.1 * std::cos((double)d);
+    for (size_t i = 0; i < u.size(); ++i) {
+        u[i] = std::sin((double)i * 0.31);
+        delta[i] = std::log1p(std::exp(std::sin((double)i * 0.17)));    // softplus
+    }
+    for (size_t i = 0; i < B.size(); ++i) {
+        B[i] = std::cos((double)i * 0.23);
+        C[i] = std::sin((double)i * 0.19);
+    }
+    MambaScanParams params = { dm, ds, A.data(), D.data() };
+
+    // Direct recurrence from a nonzero initial state
+    std::vector<double> init(ds * dm), h(ds * dm), ref_y(T * dm);
+    for (size_t i = 0; i < init.size(); ++i) init[i] = 0.5 * std::sin((double)i);
+    h = init;
+    for (size_t t = 0; t < T; ++t) {
+        for (size_t d = 0; d < dm; ++d) {
+            double acc = D[d] * u[t * dm + d];
+            for (size_t n = 0; n < ds; ++n) {
+                double& hv = h[n * dm + d];
+                hv = std::exp(delta[t * dm + d] * A[n * dm + d]) * hv + delta[t * dm + d] * u[t * dm + d] * B[t * ds + n];
+                acc += C[t * ds + n] * hv;
+            }
+            ref_y[t * dm + d] = acc;
+        }
+    }
+    auto close = [](const std::vector<double>& a, const std::vector<double>& b) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::fabs(a[i] - b[i]) > 1e-11 * (1.0 + std::fabs(b[i]))) return false;
+        }
+        return true;
+    };
+
+    SimdLevel original = simd_get_level();
+    for (int lvl = SIMD_LEVEL_SCALAR; lvl <= (int)simd_detect_level(); ++lvl) {
+        simd_set_level((SimdLevel)lvl);
+
+        std::vector<double> state = init, y(T * dm);
+        for (size_t t = 0; t < T; ++t) {
+            mamba_scan_step(&params, state.data(), &u[t * dm], &delta[t * dm], &B[t * ds], &C[t * ds], &y[t * dm]);
+        }
+        assert(close(y, ref_y) && close(state, h));
+
+        for (size_t threads = 1; threads <= 4; ++threads) {
+            mamba_set_scan_threads(threads);
+            state = init;
+            std::fill(y.begin(), y.end(), -1.0);
+            mamba_scan_prefill(&params, state.data(), u.data(), delta.data(), B.data(), C.data(), y.data(), T);
+            assert(close(y, ref_y) && close(state, h));
+        }
+
+        // Decode continues from the state a prefill leaves behind
+        mamba_set_scan_threads(3);
+        const size_t split = 150;
+        state = init;
+        mamba_scan_prefill(&params, state.data(), u.data(), delta.data(), B.data(), C.data(), y.data(), split);
+        for (size_t t = split; t < T; ++t) {
+            mamba_scan_step(&params, state.data(), &u[t * dm], &delta[t * dm], &B[t * ds], &C[t * ds], &y[t * dm]);
+        }
+        assert(close(y, ref_y) && close(state, h));
+    }
+    mamba_set_scan_threads(0);
+    simd_set_level(original);
+}
+
+// ============================================================================
+// HAL SIMULATOR TESTS
+// ============================================================================
+static int g_hal_irqs = 0;
+static void count_hal_irq() { g_hal_irqs++; }
+
+void test_hal_sim_noc() {
+    assert(agni_sim_init() == AGNI_OK);
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+
+    // Regions are host memory at their device addresses; the NOC window is not
+    assert(agni_sim_host_ptr(GLOBAL_DRAM_BASE + GLOBAL_DRAM_SIZE - 8, 8) != NULL);
+    assert(agni_sim_host_ptr(GLOBAL_DRAM_BASE + GLOBAL_DRAM_SIZE - 8, 16) == NULL);
+    assert(agni_sim_host_ptr(NOC_BASE, 8) == NULL);
+
+    const uint32_t bytes = 4096;
+    uint8_t* src = (uint8_t*)agni_sim_host_ptr(GLOBAL_DRAM_BASE + 0x1000, bytes);
+    uint8_t* dst = (uint8_t*)agni_sim_host_ptr(KEY_L2_BASE, bytes);
+    for (uint32_t i = 0; i < bytes; ++i) src[i] = (uint8_t)(i * 7);
+
+    // Busy until latency + bytes / bandwidth (+ DRAM latency) have passed
+    agni_hal_register_noc_irq_handler(count_hal_irq);
+    g_hal_irqs = 0;
+    agni_hal_noc_irq_enable();
+    uint64_t issued = agni_sim_now();
+    agni_hal_noc_copy_async(GLOBAL_DRAM_BASE + 0x1000, KEY_L2_BASE, bytes);
+    assert(memcmp(src, dst, bytes) == 0);
+    assert(agni_hal_noc_is_busy());
+    assert(g_hal_irqs == 0);
+    assert(agni_hal_noc_wait(1) == 0);
+    assert(!agni_hal_noc_is_busy());
+    uint64_t expected = config.noc_latency_cycles + bytes / 16 + config.dram_latency_cycles;
+    assert(agni_sim_now() - issued >= expected);
+    assert(agni_sim_now() - issued <= expected + 4 * config.mmio_cycles);
+
+    // One IRQ per transfer; the status read clears it
+    assert(g_hal_irqs == 1);
+    assert(agni_hal_noc_irq_pending());
+    assert(!agni_hal_noc_irq_pending());
+
+    // Transfers queue on the NOC; a timeout leaves the second in flight
+    agni_hal_noc_copy_async(KEY_L2_BASE, WRENCH_L2_BASE, bytes);
+    agni_hal_noc_copy_async(KEY_L2_BASE, WRENCH_L2_BASE + bytes, bytes);
+    assert(agni_hal_noc_wait(0) == -1);
+    agni_sim_drain();
+    assert(g_hal_irqs == 3);
+    agni_hal_noc_irq_disable();
+    agni_hal_register_noc_irq_handler(NULL);
+
+    // Out-of-map copies are dropped and counted
+    agni_hal_noc_copy_async(NOC_BASE, KEY_L2_BASE, 64);
+    AgniSimStats stats;
+    agni_sim_get_stats(&stats);
+    assert(stats.noc_transfers == 3);
+    assert(stats.noc_bytes == 3 * bytes);
+    assert(stats.errors == 1);
+}
+
+void test_hal_sim_wrench_tasks() {
+    assert(agni_sim_init() == AGNI_OK);
+    agni_sim_reset();
+
+    // 8x8 f32 C = A * B
+    const uint64_t tile = 8 * 8 * sizeof(float);
+    float* A = (float*)agni_sim_host_ptr(GLOBAL_DRAM_BASE, tile);
+    float* B = (float*)agni_sim_host_ptr(GLOBAL_DRAM_BASE + tile, tile);
+    for (int i = 0; i < 64; ++i) {
+        A[i] = (float)(i % 5) - 2.0f;
+        B[i] = (float)(i % 3) * 0.5f;
+    }
+    agni_wrench_config(8, 8);
+    agni_wrench_load_a(GLOBAL_DRAM_BASE);
+    agni_wrench_load_b(GLOBAL_DRAM_BASE + tile);
+    agni_wrench_execute(WRENCH_L2_BASE);
+    const float* C = (const float*)agni_sim_host_ptr(WRENCH_L2_BASE, tile);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            float ref = 0.0f;
+            for (int k = 0; k < 8; ++k) ref += A[i * 8 + k] * B[k * 8 + j];
+            assert(C[i * 8 + j] == ref);
+        }
+    }
+
+    // A copy of the output waits for the Wrench to finish
+    AgniSimStats stats;
+    agni_sim_get_stats(&stats);
+    uint64_t wrench_done = stats.wrench_busy_cycles;     // Lower bound on its completion
+    agni_hal_noc_copy_async(WRENCH_L2_BASE, KEY_L2_BASE, (uint32_t)tile);
+    agni_sim_drain();
+    assert(agni_sim_now() >= wrench_done + 100 + tile / 16);
+
+    // Scheduler tasks drain through the simulator with cycles per task
+    agni_sim_reset();
+    for (uint32_t t = 0; t < 3; ++t) {
+        Task task = { t, GLOBAL_DRAM_BASE, GLOBAL_DRAM_BASE + tile, WRENCH_L2_BASE + t * 4096 };
+        agni_scheduler_submit_task(&task);
+    }
+    while (agni_scheduler_step()) {
+    }
+    agni_sim_get_stats(&stats);
+    assert(stats.tasks == 3);
+    assert(stats.wrench_ops == 3);
+    assert(stats.noc_transfers == 3);
+    assert(stats.task_cycles_min > 0);
+    assert(stats.task_cycles_min <= stats.task_cycles_max);
+    assert(!agni_hal_noc_is_busy());
+}
+
+void test_hal_sim_noc_ring() {
+    assert(agni_sim_init() == AGNI_OK);
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+    agni_hal_noc_ring_init();
+    assert(agni_hal_noc_completed_seq() == 0);
+    assert(agni_hal_noc_ring_space(1) == NOC_RING_ENTRIES);
+
+    // A gather chain of 4 descriptors completes as one unit with one IRQ
+    const uint32_t part = 1024;
+    uint8_t* src = (uint8_t*)agni_sim_host_ptr(GLOBAL_DRAM_BASE, 16 * part);
+    for (uint32_t i = 0; i < 16 * part; ++i) src[i] = (uint8_t)(i * 13 + 1);
+    NocCopyDescriptor chain[4];
+    for (uint32_t p = 0; p < 4; ++p) {
+        chain[p].source_addr = GLOBAL_DRAM_BASE + (3 - p) * part;
+        chain[p].dest_addr = KEY_L2_BASE + p * part;
+        chain[p].size_bytes = part;
+        chain[p].flags = 0;
+    }
+    agni_hal_register_noc_irq_handler(count_hal_irq);
+    g_hal_irqs = 0;
+    agni_hal_noc_irq_enable();
+    uint64_t seq = agni_hal_noc_submit(chain, 4);
+    assert(seq == 4);
+    assert(!agni_hal_noc_seq_done(seq));
+    assert(agni_hal_noc_wait_seq(seq, 1) == 0);
+    assert(agni_hal_noc_completed_seq() == 4);
+    assert(g_hal_irqs == 1);
+    const uint8_t* dst = (const uint8_t*)agni_sim_host_ptr(KEY_L2_BASE, 4 * part);
+    for (uint32_t p = 0; p < 4; ++p) assert(memcmp(dst + p * part, src + (3 - p) * part, part) == 0);
+
+    // Copies in flight keep their own descriptors; each waits on its sequence
+    uint64_t seqs[8];
+    for (uint32_t i = 0; i < 8; ++i) {
+        seqs[i] = agni_hal_noc_copy_async(GLOBAL_DRAM_BASE + i * 2 * part, WRENCH_L2_BASE + i * 2 * part, 2 * part);
+        assert(seqs[i] == 5 + i);
+    }
+    assert(!agni_hal_noc_seq_done(seqs[0]));
+    assert(agni_hal_noc_wait_seq(seqs[3], 1) == 0);
+    assert(agni_hal_noc_seq_done(seqs[3]) && !agni_hal_noc_seq_done(seqs[4]));
+    assert(agni_hal_noc_wait_seq(seqs[7], 0) == -1);
+    assert(agni_hal_noc_wait_seq(seqs[7], 1) == 0);
+    assert(g_hal_irqs == 9);
+    assert(memcmp(agni_sim_host_ptr(WRENCH_L2_BASE, 16 * part), src, 16 * part) == 0);
+    agni_hal_noc_irq_disable();
+    agni_hal_register_noc_irq_handler(NULL);
+
+    // Busy time counts data only; latency overlaps the previous transfer
+    AgniSimStats stats;
+    agni_sim_get_stats(&stats);
+    assert(stats.noc_transfers == 12);
+    assert(stats.noc_busy_cycles == 20 * part / 16);
+
+    // A full ring refuses a chain until entries complete
+    NocCopyDescriptor full[NOC_RING_ENTRIES];
+    for (uint32_t i = 0; i < NOC_RING_ENTRIES; ++i) {
+        NocCopyDescriptor d = { GLOBAL_DRAM_BASE, KEY_L2_BASE, 16 * part, 0 };
+        full[i] = d;
+    }
+    assert(agni_hal_noc_submit(full, NOC_RING_ENTRIES) == 12 + NOC_RING_ENTRIES);
+    assert(agni_hal_noc_ring_space(1) == 0);
+    assert(agni_hal_noc_submit(chain, 4) == 0);
+    agni_sim_drain();
+    assert(agni_hal_noc_ring_space(4) == NOC_RING_ENTRIES);
+    assert(agni_hal_noc_submit(chain, 4) == 12 + NOC_RING_ENTRIES + 4);
+    agni_sim_drain();
+    assert(agni_hal_noc_seq_done(12 + NOC_RING_ENTRIES + 4));
+
+    // With interrupts masked completions stay pending and are taken once,
+    // on restore
+    agni_hal_register_noc_irq_handler(count_hal_irq);
+    agni_hal_noc_irq_enable();
+    g_hal_irqs = 0;
+    AgniIrqFlags flags = agni_hal_irq_save();
+    seq = agni_hal_noc_copy_async(GLOBAL_DRAM_BASE, KEY_L2_BASE, part);
+    agni_hal_noc_copy_async(GLOBAL_DRAM_BASE, KEY_L2_BASE, part);
+    assert(agni_hal_noc_wait_seq(seq + 1, 1) == 0);
+    assert(g_hal_irqs == 0);
+    uint64_t now = agni_sim_now();
+    assert(agni_hal_wait_for_interrupt() && agni_sim_now() == now);   // Already pending
+    agni_hal_irq_restore(flags);
+    assert(g_hal_irqs == 1);
+
+    // A masked WFI sleeps until the completion; its handler runs on restore
+    flags = agni_hal_irq_save();
+    seq = agni_hal_noc_copy_async(GLOBAL_DRAM_BASE, KEY_L2_BASE, part);
+    assert(agni_hal_wait_for_interrupt());
+    assert(agni_hal_noc_seq_done(seq) && g_hal_irqs == 1);
+    agni_hal_irq_restore(flags);
+    assert(g_hal_irqs == 2);
+    agni_hal_noc_irq_disable();
+    agni_hal_register_noc_irq_handler(NULL);
+}
+
+void test_hal_sim_event_loop() {
+    assert(agni_sim_init() == AGNI_OK);
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+    agni_scheduler_reset_stats();
+
+    // Nothing can wake the core: WFI refuses without moving the clock
+    uint64_t before = agni_sim_now();
+    assert(!agni_hal_wait_for_interrupt());
+    assert(agni_sim_now() == before);
+
+    // Each copy's IRQ retires it and queues its Key job; the core sleeps
+    // instead of polling
+    const uint64_t tile = 8 * 8 * sizeof(float);
+    for (uint32_t t = 0; t < 6; ++t) {
+        Task task = { t, GLOBAL_DRAM_BASE, GLOBAL_DRAM_BASE + tile, WRENCH_L2_BASE + t * 4096 };
+        agni_scheduler_submit_task(&task);
+    }
+    agni_scheduler_init();
+    agni_scheduler_run_until_idle();
+    agni_hal_noc_irq_disable();
+    agni_hal_register_noc_irq_handler(NULL);
+
+    AgniSchedulerStats sched;
+    agni_scheduler_get_stats(&sched);
+    assert(sched.tasks == 6 && sched.retired == 6 && sched.irqs == 6);
+    assert(sched.polls == 0 && sched.sleeps > 0);
+    AgniSimStats stats;
+    agni_sim_get_stats(&stats);
+    assert(stats.key_jobs == 6);
+    assert(stats.wfi_sleeps == sched.sleeps);
+    assert(stats.foreman_idle_cycles > 0 && stats.foreman_idle_cycles < stats.cycles);
+    assert(agni_sim_polls_avoided(&stats) == stats.foreman_idle_cycles / config.mmio_cycles);
+    double power = agni_sim_foreman_power_w(&stats);
+    assert(power > config.foreman_wfi_mw / 1000.0 && power < config.foreman_active_mw / 1000.0);
+
+    // With the IRQ off the same queue drains by polling, never sleeping
+    agni_sim_reset();
+    agni_scheduler_reset_stats();
+    for (uint32_t t = 0; t < 6; ++t) {
+        Task task = { t, GLOBAL_DRAM_BASE, GLOBAL_DRAM_BASE + tile, WRENCH_L2_BASE + t * 4096 };
+        agni_scheduler_submit_task(&task);
+    }
+    agni_scheduler_run_until_idle();
+    agni_scheduler_get_stats(&sched);
+    agni_sim_get_stats(&stats);
+    assert(sched.retired == 6 && sched.polls > 0 && sched.sleeps == 0);
+    assert(stats.key_jobs == 6 && stats.foreman_idle_cycles == 0);
+}
+
+void test_hal_sim_pipeline() {
+    assert(agni_sim_init() == AGNI_OK);
+    AgniSimConfig config = agni_sim_default_config();
+    agni_sim_configure(&config);
+    agni_sim_reset();
+    agni_scheduler_reset_stats();
+    agni_sim_trace_enable(true);
+    agni_scheduler_set_pipeline(2);
+
+    // Every tile has its own A, so each Key input slot ends up holding the
+    // product of the last tile that used it
+    const uint32_t tiles = 6;
+    const uint64_t tile = 8 * 8 * sizeof(float);
+    float* dram = (float*)agni_sim_host_ptr(GLOBAL_DRAM_BASE, (tiles + 1) * tile);
+    for (uint32_t i = 0; i < (tiles + 1) * 64; ++i) dram[i] = (float)(i % 7) - 3.0f;
+    for (uint32_t t = 0; t < tiles; ++t) {
+        Task task = { t, GLOBAL_DRAM_BASE + t * tile, GLOBAL_DRAM_BASE + tiles * tile, 0 };
+        agni_scheduler_submit_task(&task);
+    }
+    agni_scheduler_init();
+    agni_scheduler_run_until_idle();
+    agni_hal_noc_irq_disable();
+    agni_hal_register_noc_irq_handler(NULL);
+    agni_sim_drain();
+    agni_sim_trace_enable(false);
+    agni_scheduler_set_pipeline(0);
+
+    for (uint32_t t = tiles - 2; t < tiles; ++t) {
+        const float* A = dram + t * 64;
+        const float* B = dram + tiles * 64;
+        const float* in = (const float*)agni_sim_host_ptr(KEY_L2_BASE + (t % 2) * (KEY_L2_SIZE / 4), tile);
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                float ref = 0.0f;
+                for (int k = 0; k < 8; ++k) ref += A[i * 8 + k] * B[k * 8 + j];
+                assert(in[i * 8 + j] == ref);
+            }
+        }
+    }
+    AgniSimStats stats;
+    agni_sim_get_stats(&stats);
+    assert(stats.key_jobs == tiles && stats.noc_transfers == tiles);
+
+    // Per engine the trace is in tile order: 3 Wrench operations per tile
+    const AgniSimTraceEvent* events;
+    size_t count = agni_sim_trace(&events);
+    std::vector<AgniSimTraceEvent> wrench, noc, key;
+    for (size_t i = 0; i < count; ++i) {
+        if (events[i].engine == AGNI_SIM_WRENCH) wrench.push_back(events[i]);
+        else if (events[i].engine == AGNI_SIM_NOC) noc.push_back(events[i]);
+        else key.push_back(events[i]);
+    }
+    assert(wrench.size() == 3 * tiles && noc.size() == tiles && key.size() == tiles);
+
+    // Tile 1 computes while tile 0 moves; a slot is reused only after the
+    // copy and the Key job of the tile before have finished with it
+    assert(wrench[3].start < noc[0].end);
+    for (uint32_t t = 2; t < tiles; ++t) {
+        assert(wrench[3 * t + 2].start >= noc[t - 2].end);
+        assert(noc[t].start >= key[t - 2].end);
+        assert(key[t].start >= noc[t].end);
+    }
+}
+
+// ============================================================================
+// TASK RING TESTS
+// ============================================================================
+static AgniTaskSlot g_test_slots[256];
+static AgniTaskRing g_test_ring;
+
+void test_task_ring_basics() {
+    AgniTaskRing& ring = g_test_ring;
+    assert(agni_task_ring_init(&ring, g_test_slots, 12, false) == AGNI_ERROR_INVALID_INPUT);
+    assert(agni_task_ring_init(&ring, NULL, 8, false) == AGNI_ERROR_NULL_POINTER);
+    assert(agni_task_ring_init(&ring, g_test_slots, 8, false) == AGNI_OK);
+    assert(agni_task_ring_capacity(&ring) == 8 && agni_task_ring_empty(&ring));
+
+    // Fills to capacity, then pushes back without queueing anything
+    Task tasks[8];
+    for (uint32_t i = 0; i < 8; ++i) {
+        Task t = { i, i, 0, 0 };
+        tasks[i] = t;
+    }
+    assert(agni_task_ring_push_batch(&ring, tasks, 5) == AGNI_OK);
+    assert(agni_task_ring_push_batch(&ring, tasks + 5, 4) == AGNI_ERROR_QUEUE_FULL);
+    assert(agni_task_ring_size(&ring) == 5);
+    assert(agni_task_ring_push_batch(&ring, tasks + 5, 3) == AGNI_OK);
+    assert(agni_task_ring_push(&ring, tasks) == AGNI_ERROR_QUEUE_FULL);
+    assert(agni_task_ring_push_batch(&ring, tasks, 9) == AGNI_ERROR_INVALID_INPUT);
+
+    // FIFO across the wrap, batch or single
+    Task out[8];
+    assert(agni_task_ring_pop_batch(&ring, out, 3) == 3);
+    assert(out[0].job_id == 0 && out[2].job_id == 2);
+    assert(agni_task_ring_push_batch(&ring, tasks, 3) == AGNI_OK);
+    assert(agni_task_ring_pop_batch(&ring, out, 8) == 8);
+    for (uint32_t i = 0; i < 5; ++i) assert(out[i].job_id == 3 + i);
+    for (uint32_t i = 0; i < 3; ++i) assert(out[5 + i].job_id == i);
+    assert(!agni_task_ring_pop(&ring, out) && agni_task_ring_empty(&ring));
+
+    // A constant-initialized ring over zeroed slots needs no init call
+    static AgniTaskSlot zeroed[4];
+    AgniTaskRing fixed = AGNI_TASK_RING_INITIALIZER(zeroed, 4, false);
+    assert(agni_task_ring_empty(&fixed) && agni_task_ring_capacity(&fixed) == 4);
+    assert(agni_task_ring_push_batch(&fixed, tasks, 4) == AGNI_OK);
+    assert(agni_task_ring_push(&fixed, tasks) == AGNI_ERROR_QUEUE_FULL);
+    assert(agni_task_ring_pop_batch(&fixed, out, 3) == 3 && out[2].job_id == 2);
+    assert(agni_task_ring_push_batch(&fixed, tasks + 4, 3) == AGNI_OK);
+    assert(agni_task_ring_pop_batch(&fixed, out, 8) == 4);
+    assert(out[0].job_id == 3 && out[1].job_id == 4 && out[3].job_id == 6);
+
+    // The scheduler queue reports backpressure instead of dropping tasks
+    Task task = { 0, 0, 0, 0 };
+    uint32_t queued = 0;
+    while (agni_scheduler_submit_task(&task) == AGNI_OK) queued++;
+    assert(queued == 256);
+    assert(agni_scheduler_submit_batch(tasks, 2) == AGNI_ERROR_QUEUE_FULL);
+    while (agni_scheduler_get_next_task(&task)) queued--;
+    assert(queued == 0);
+}
+
+// Producers tag tasks with their index and a running count; the consumer
+// checks nothing is lost, duplicated or reordered per producer
+static void stress_task_ring(uint32_t producers, uint32_t capacity) {
+    const uint32_t per_producer = 50000;
+    AgniTaskRing& ring = g_test_ring;
+    assert(capacity <= sizeof(g_test_slots) / sizeof(g_test_slots[0]));
+    assert(agni_task_ring_init(&ring, g_test_slots, capacity, producers > 1) == AGNI_OK);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&ring, p, per_producer] {
+            Task batch[4];
+            uint32_t i = 0;
+            while (i < per_producer) {
+                uint32_t n = MIN((uint32_t)(1 + i % 4), per_producer - i);
+                for (uint32_t b = 0; b < n; ++b) {
+                    Task t = { p, i + b, 0, 0 };
+                    batch[b] = t;
+                }
+                if (agni_task_ring_push_batch(&ring, batch, n) == AGNI_OK) i += n;
+                else std::this_thread::yield();
+            }
+        }));
+    }
+    std::vector<uint64_t> next(producers, 0);
+    uint64_t received = 0;
+    Task out[8];
+    while (received < (uint64_t)producers * per_producer) {
+        uint32_t n = agni_task_ring_pop_batch(&ring, out, 1 + received % 8);
+        if (n == 0) std::this_thread::yield();
+        for (uint32_t i = 0; i < n; ++i) {
+            assert(out[i].job_id < producers);
+            assert(out[i].wrench_a_addr == next[out[i].job_id]);
+            next[out[i].job_id]++;
+        }
+        received += n;
+    }
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    assert(agni_task_ring_empty(&ring) && agni_task_ring_size(&ring) == 0);
+}
+
+void test_task_ring_stress() {
+    stress_task_ring(1, 16);
+    stress_task_ring(4, 16);
+    stress_task_ring(4, 256);
+}
 
 // ============================================================================
 // SCHEDULER TESTS
@@ -133,37 +1345,633 @@ void test_scheduler_queue_size() {
     scheduler.stop();
 }
 
+void test_scheduler_priority_order() {
+    SchedulerConfig config;
+    config.policy = POLICY_PRIORITY;
+    config.aging_ms = 0;
+    config.simulated_work_us = 1000;
+    Scheduler scheduler(config);
+
+    // Queue everything before any worker runs so dispatch order is decided
+    // purely by the policy.
+    std::vector<uint32_t> low_ids, high_ids;
+    for (int i = 0; i < 6; ++i) low_ids.push_back(scheduler.submit_job("test", "bulk", 0));
+    for (int i = 0; i < 4; ++i) high_ids.push_back(scheduler.submit_job("test", "interactive", 3));
+    assert(scheduler.get_queue_depth(0) == 6);
+    assert(scheduler.get_queue_depth(3) == 4);
+    assert(scheduler.get_queue_size() == 10);
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    scheduler.stop();
+
+    Job::Clock::time_point last_high = scheduler.get_job_ref(high_ids[0])->start_time;
+    for (uint32_t id : high_ids) {
+        assert(scheduler.poll_job(id) == STATUS_COMPLETE);
+        last_high = std::max(last_high, scheduler.get_job_ref(id)->start_time);
+    }
+    for (uint32_t id : low_ids) {
+        assert(scheduler.poll_job(id) == STATUS_COMPLETE);
+        assert(scheduler.get_job_ref(id)->start_time >= last_high);
+    }
+
+    SchedulerMetrics metrics = scheduler.get_metrics();
+    assert(metrics.queue_depth[0] == 0 && metrics.queue_depth[3] == 0);
+    assert(metrics.dispatched[0] == 6 && metrics.dispatched[3] == 4);
+}
+
+void test_scheduler_priority_aging() {
+    SchedulerConfig config;
+    config.policy = POLICY_PRIORITY;
+    config.aging_ms = 1;
+    config.simulated_work_us = 1000;
+    Scheduler scheduler(config);
+
+    // A bulk job that has waited long enough outranks a fresh interactive one.
+    uint32_t low_id = scheduler.submit_job("test", "bulk", 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint32_t high_id = scheduler.submit_job("test", "interactive", 3);
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.stop();
+
+    assert(scheduler.poll_job(low_id) == STATUS_COMPLETE);
+    assert(scheduler.poll_job(high_id) == STATUS_COMPLETE);
+    assert(scheduler.get_job_ref(low_id)->start_time <= scheduler.get_job_ref(high_id)->start_time);
+    assert(scheduler.get_metrics().aged_dispatches >= 1);
+}
+
+void test_scheduler_history_retention() {
+    SchedulerConfig config;
+    config.simulated_work_us = 100;
+    config.history_retention = 2;
+    Scheduler scheduler(config);
+
+    std::vector<uint32_t> ids;
+    std::vector<JobRef> refs;
+    for (int i = 0; i < 5; ++i) ids.push_back(scheduler.submit_job("test", "prompt"));
+    for (uint32_t id : ids) refs.push_back(scheduler.get_job_ref(id));
+    assert(scheduler.get_history_size() == 5);
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.stop();
+
+    // Only the two most recently finished jobs remain pollable.
+    assert(scheduler.get_history_size() == 2);
+    size_t found = 0;
+    for (uint32_t id : ids) {
+        if (scheduler.get_job_ref(id)) {
+            assert(scheduler.poll_job(id) == STATUS_COMPLETE);
+            found++;
+        } else {
+            assert(scheduler.poll_job(id) == STATUS_ERROR);
+        }
+    }
+    assert(found == 2);
+
+    // Handles outlive eviction, and every job was COMPLETE before it went
+    for (size_t i = 0; i < refs.size(); ++i) {
+        std::lock_guard<std::mutex> lock(refs[i]->stream_mutex);
+        assert(refs[i]->status == STATUS_COMPLETE);
+    }
+}
+
+void test_scheduler_work_stealing() {
+    SchedulerConfig config;
+    config.policy = POLICY_WORK_STEALING;
+    config.num_workers = 3;
+    config.simulated_work_us = 200;
+    Scheduler scheduler(config);
+
+    // Submit from several threads before and after start; every job must
+    // run exactly once.
+    std::vector<uint32_t> ids[4];
+    for (int i = 0; i < 20; ++i) ids[0].push_back(scheduler.submit_job("test", "prompt"));
+    scheduler.start();
+
+    std::vector<std::thread> producers;
+    for (int t = 1; t < 4; ++t) {
+        producers.push_back(std::thread([&scheduler, &ids, t] {
+            for (int i = 0; i < 50; ++i) ids[t].push_back(scheduler.submit_job("test", "prompt"));
+        }));
+    }
+    for (auto& producer : producers) producer.join();
+
+    for (int spin = 0; spin < 500 && scheduler.get_metrics().completed < 170; ++spin) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    scheduler.stop();
+
+    SchedulerMetrics metrics = scheduler.get_metrics();
+    assert(metrics.completed == 170);
+    assert(metrics.dispatched[0] == 170);
+    assert(scheduler.get_queue_size() == 0);
+    for (int t = 0; t < 4; ++t) {
+        for (uint32_t id : ids[t]) assert(scheduler.poll_job(id) == STATUS_COMPLETE);
+    }
+}
+
+void test_scheduler_batching() {
+    SchedulerConfig config;
+    config.policy = POLICY_FIFO;
+    config.num_workers = 1;
+    config.simulated_work_us = 1000;
+    config.simulated_batch_item_us = 100;
+    config.batch_max_jobs = 4;
+    config.batch_wait_us = 0;
+    Scheduler scheduler(config);
+
+    const char* weapons[] = {"A", "A", "B", "A", "A", "A", "B", "A"};
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 8; ++i) ids.push_back(scheduler.submit_job(weapons[i], "prompt"));
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.stop();
+
+    // Jobs that shared a pass were published together with one end_time;
+    // a pass never mixes weapons.
+    for (int i = 0; i < 8; ++i) {
+        JobRef a = scheduler.get_job_ref(ids[i]);
+        assert(a->status == STATUS_COMPLETE);
+        for (int j = 0; j < 8; ++j) {
+            JobRef b = scheduler.get_job_ref(ids[j]);
+            if (a->end_time == b->end_time) assert(a->weapon_id == b->weapon_id);
+        }
+    }
+
+    SchedulerMetrics metrics = scheduler.get_metrics();
+    assert(metrics.completed == 8);
+    assert(metrics.batches == 3);          // [A A A A] [B B] [A A]
+    assert(metrics.batched_jobs == 8);
+    assert(metrics.max_batch_size == 4);
+    assert(metrics.batch_max_jobs == 4);
+
+    // With a wait window, a job arriving shortly after the lead joins it
+    config.batch_wait_us = 30000;
+    Scheduler waiting(config);
+    waiting.start();
+    uint32_t first = waiting.submit_job("A", "prompt");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    uint32_t second = waiting.submit_job("A", "prompt");
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    waiting.stop();
+    assert(waiting.get_job_ref(first)->end_time == waiting.get_job_ref(second)->end_time);
+    assert(waiting.get_metrics().batch_wait_us > 0);
+
+    // A job another weapon's collector cannot take is still dispatched to
+    // the idle worker well inside that collector's window
+    config.num_workers = 2;
+    config.batch_wait_us = 1000000;
+    Scheduler mixed(config);
+    mixed.start();
+    mixed.submit_job("A", "prompt");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    mixed.submit_job("B", "prompt");
+    for (int i = 0; i < 200 && mixed.get_queue_size() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(mixed.get_queue_size() == 0);
+    mixed.stop();
+}
+
+void test_scheduler_token_stream() {
+    SchedulerConfig config;
+    config.num_workers = 1;
+    config.simulated_work_us = 3000;
+    Scheduler scheduler(config);
+
+    std::mutex lock;
+    std::string streamed;
+    std::vector<JobStatus> statuses;
+    int one_shot_calls = 0;
+    uint32_t id = scheduler.submit_job("test", "prompt");
+    assert(scheduler.subscribe_job(id, [&](const Job& job, JobEventType type, const std::string& text) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (type == JOB_EVENT_TOKEN) streamed += text;
+        else statuses.push_back(job.status);
+        return true;
+    }));
+    // Unsubscribes on the first event after the replay
+    assert(scheduler.subscribe_job(id, [&](const Job&, JobEventType, const std::string&) {
+        return ++one_shot_calls < 2;
+    }));
+    assert(!scheduler.subscribe_job(9999, [](const Job&, JobEventType, const std::string&) {
+        return true;
+    }));
+
+    scheduler.start();
+    for (int spin = 0; spin < 500 && scheduler.get_metrics().completed < 1; ++spin) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.stop();
+
+    // Tokens arrive in order and add up to the final result
+    JobRef job = scheduler.get_job_ref(id);
+    assert(streamed == job->result);
+    assert(job->result == "Job " + std::to_string(id) + " completed.");
+    assert(statuses.size() == 3);
+    assert(statuses[0] == STATUS_QUEUED && statuses[1] == STATUS_RUNNING && statuses[2] == STATUS_COMPLETE);
+    assert(job->first_token_time > job->start_time && job->first_token_time < job->end_time);
+    assert(scheduler.get_metrics().first_token_us > 0);
+    assert(one_shot_calls == 2);
+
+    // A late subscriber gets the whole result and the final status at once
+    int events = 0;
+    assert(scheduler.subscribe_job(id, [&](const Job& j, JobEventType type, const std::string& text) {
+        if (type == JOB_EVENT_TOKEN) assert(text == j.result);
+        else assert(j.status == STATUS_COMPLETE);
+        events++;
+        return true;
+    }));
+    assert(events == 2);
+    assert(job->listeners.empty());
+}
+
 // ============================================================================
 // API GATEWAY TESTS
 // ============================================================================
+static APIRequest make_request(const char* method, const char* endpoint, const std::string& body = "") {
+    APIRequest req;
+    req.method = method;
+    req.endpoint = endpoint;
+    req.body = body;
+    return req;
+}
+
+// Contents of the file an upload response names; the file is removed
+static std::string read_upload_file(const std::string& response) {
+    size_t id_pos = response.find(": \"file_");
+    assert(id_pos != std::string::npos);
+    size_t id_end = response.find('"', id_pos + 8);
+    std::string path = std::string(API_UPLOAD_DIR) + "/agni_upload_" +
+                       response.substr(id_pos + 8, id_end - id_pos - 8) + ".bin";
+    FILE* f = fopen(path.c_str(), "rb");
+    assert(f);
+    std::string contents;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) contents.append(buffer, n);
+    fclose(f);
+    remove(path.c_str());
+    return contents;
+}
+
 void test_api_gateway_endpoints() {
     Scheduler scheduler;
     APIGateway gateway(&scheduler);
 
     // Test Health
-    APIRequest health_req = {"GET", "/v59/health"};
+    APIRequest health_req = make_request("GET", "/v59/health");
     APIResponse health_resp = gateway.handle_request(health_req);
     assert(health_resp.status_code == 200);
     assert(health_resp.body.find("\"status\": \"healthy\"") != std::string::npos);
 
     // Test Axiom (Submit)
-    APIRequest axiom_req = {"POST", "/v59/axiom", "{\"prompt\":\"test\"}"};
+    APIRequest axiom_req = make_request("POST", "/v59/axiom", "{\"prompt\":\"test\"}");
     APIResponse axiom_resp = gateway.handle_request(axiom_req);
     assert(axiom_resp.status_code == 200);
     assert(axiom_resp.body.find("\"job_uuid\"") != std::string::npos);
 
     // Test Upload
-    APIRequest upload_req = {"POST", "/v59/upload", "file content"};
+    APIRequest upload_req = make_request("POST", "/v59/upload", "file content");
     APIResponse upload_resp = gateway.handle_request(upload_req);
     assert(upload_resp.status_code == 200);
     assert(upload_resp.body.find("\"status\": \"UPLOADED\"") != std::string::npos);
+    assert(read_upload_file(upload_resp.body) == "file content");
 
     // Test 404
-    APIRequest notfound_req = {"GET", "/nonexistent"};
+    APIRequest notfound_req = make_request("GET", "/nonexistent");
     APIResponse notfound_resp = gateway.handle_request(notfound_req);
     assert(notfound_resp.status_code == 404);
 }
 
+void test_api_gateway_axiom_prompt() {
+    Scheduler scheduler;
+    APIGateway gateway(&scheduler);
+
+    // The prompt is decoded from the JSON body, escapes included
+    APIRequest req = make_request("POST", "/v59/axiom",
+                                  "{\"options\": {\"prompt\": 1}, \"prompt\": \"say \\\"hi\\\"\\n\\u00e9\"}");
+    APIResponse resp = gateway.handle_request(req);
+    assert(resp.status_code == 200);
+    assert(resp.body.find("\"endpoint\": \"/v59/status/1\"") != std::string::npos);
+    assert(scheduler.get_job_ref(1)->prompt == "say \"hi\"\n\xc3\xa9");
+
+    // Raw text, malformed JSON and a missing or non-string prompt are rejected
+    const char* bad[] = {"raw prompt", "{\"prompt\": \"x\"", "{\"text\": \"x\"}",
+                         "{\"prompt\": [\"x\"]}", "[\"prompt\", \"x\"]"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        APIRequest bad_req = make_request("POST", "/v59/axiom", bad[i]);
+        resp = gateway.handle_request(bad_req);
+        assert(resp.status_code == 400);
+        assert(resp.body.find("\"error\": ") == 1);
+    }
+    assert(scheduler.get_queue_size() == 1);
+}
+
+// ============================================================================
+// JSON CODEC TESTS
+// ============================================================================
+void test_json_writer() {
+    std::string out;
+    JsonWriter json(out);
+    json.begin_object()
+        .key("s").string_value("q\"\\\n\x01\xc3\xa9")
+        .key("u").uint_value(18446744073709551615ULL)
+        .key("i").int_value(-42)
+        .key("d").double_value(0.5)
+        .key("nan").double_value(NAN)
+        .key("list").begin_array().bool_value(true).null_value().begin_object().end_object().end_array()
+        .end_object();
+    assert(out == "{\"s\": \"q\\\"\\\\\\n\\u0001\xc3\xa9\", \"u\": 18446744073709551615, "
+                  "\"i\": -42, \"d\": 0.5, \"nan\": null, \"list\": [true, null, {}]}");
+}
+
+// Records events as compact text for comparison
+class JsonEventLog : public JsonHandler {
+public:
+    std::string log;
+    bool on_begin_object() { log += "{"; return true; }
+    bool on_end_object() { log += "}"; return true; }
+    bool on_begin_array() { log += "["; return true; }
+    bool on_end_array() { log += "]"; return true; }
+    bool on_key(const char* s, size_t len) { log += "K:" + std::string(s, len) + " "; return true; }
+    bool on_string(const char* s, size_t len) { log += "S:" + std::string(s, len) + " "; return true; }
+    bool on_number(double v) { log += "N:" + std::to_string(v) + " "; return true; }
+    bool on_bool(bool v) { log += v ? "T " : "F "; return true; }
+    bool on_null() { log += "null "; return true; }
+};
+
+void test_json_reader() {
+    JsonReader reader;
+    JsonEventLog events;
+    assert(reader.parse(" {\"a\": [1, -2.5e1, true, false, null], \"b\\u0041\": \"\\ud83d\\ude00\\t\"} ",
+                        events) == JSON_OK);
+    assert(events.log == "{K:a [N:1.000000 N:-25.000000 T F null ]K:bA S:\xf0\x9f\x98\x80\t }");
+
+    const char* malformed[] = {"", "{", "{\"a\" 1}", "[1,]", "01", "1.", "\"\\x\"", "\"a\nb\"",
+                               "\"\\udc00\"", "tru", "{} {}", "{\"a\": 1,}"};
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); ++i) {
+        JsonEventLog ignored;
+        assert(reader.parse(malformed[i], strlen(malformed[i]), ignored) == JSON_MALFORMED);
+    }
+
+    std::string deep(JSON_MAX_DEPTH + 1, '[');
+    deep += std::string(JSON_MAX_DEPTH + 1, ']');
+    JsonEventLog ignored;
+    assert(reader.parse(deep, ignored) == JSON_TOO_DEEP);
+
+    // Writer output reads back
+    std::string text;
+    JsonWriter(text).begin_object().key("k\"").string_value("v\n").end_object();
+    JsonEventLog round_trip;
+    assert(reader.parse(text, round_trip) == JSON_OK);
+    assert(round_trip.log == "{K:k\" S:v\n }");
+}
+
+// ============================================================================
+// HTTP SERVER TESTS
+// ============================================================================
+static int http_connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+// Send raw bytes, then read until `responses` complete responses arrived
+// (or the peer closes). Returns everything read.
+static std::string http_exchange(int fd, const std::string& raw, int responses) {
+    if (!raw.empty()) assert(write(fd, raw.data(), raw.size()) == (ssize_t)raw.size());
+
+    std::string in;
+    char buffer[4096];
+    while (true) {
+        int complete = 0;
+        size_t offset = 0;
+        while (true) {
+            size_t head_end = in.find("\r\n\r\n", offset);
+            if (head_end == std::string::npos) break;
+            size_t cl = in.find("Content-Length: ", offset);
+            size_t body = (cl < head_end) ? (size_t)atol(in.c_str() + cl + 16) : 0;
+            if (in.size() < head_end + 4 + body) break;
+            offset = head_end + 4 + body;
+            complete++;
+        }
+        if (complete >= responses) break;
+
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        in.append(buffer, (size_t)n);
+    }
+    return in;
+}
+
+void test_http_server_keepalive_pipelining() {
+    Scheduler scheduler;
+    APIGateway gateway(&scheduler);
+    gateway.start_server(0);
+    int port = gateway.get_server_port();
+    assert(port > 0);
+
+    int fd = http_connect(port);
+
+    // Two pipelined requests in one write are answered in order
+    std::string out = http_exchange(fd,
+        "GET /v59/health HTTP/1.1\r\nHost: x\r\n\r\n"
+        "POST /v59/axiom HTTP/1.1\r\nHost: x\r\nContent-Length: 17\r\n\r\n{\"prompt\":\"test\"}", 2);
+    size_t first = out.find("HTTP/1.1 200 OK");
+    size_t second = out.find("HTTP/1.1 200 OK", first + 1);
+    assert(first == 0 && second != std::string::npos);
+    assert(out.find("\"status\": \"healthy\"") < second);
+    assert(out.find("\"job_uuid\"") > second);
+    assert(out.find("Connection: keep-alive") != std::string::npos);
+
+    // Same connection is still usable; query string does not affect routing
+    out = http_exchange(fd, "GET /v59/status/1?x=1 HTTP/1.1\r\n\r\n", 1);
+    assert(out.find("\"job_id\": 1") != std::string::npos);
+
+    // A request split across writes is reassembled
+    http_exchange(fd, "GET /nonexistent HT", 0);
+    out = http_exchange(fd, "TP/1.1\r\nConnection: close\r\n\r\n", 1);
+    assert(out.find("HTTP/1.1 404 Not Found") == 0);
+    assert(out.find("Connection: close") != std::string::npos);
+    close(fd);
+
+    // Malformed request line
+    fd = http_connect(port);
+    out = http_exchange(fd, "NONSENSE\r\n\r\n", 1);
+    assert(out.find("HTTP/1.1 400 Bad Request") == 0);
+    close(fd);
+
+    gateway.stop_server();
+    assert(gateway.get_server_port() == 0);
+}
+
+void test_http_server_output_backpressure() {
+    HttpServerConfig config;
+    config.port = 0;
+    config.io_threads = 1;
+    HttpServer server(config, [](const APIRequest&) {
+        APIResponse resp;
+        resp.status_code = 200;
+        resp.body.assign(256 * 1024, 'x');
+        return resp;
+    });
+    assert(server.start());
+
+    // Responses to 16 pipelined requests far exceed the output high-water
+    // mark; the held requests are answered in order as the client reads
+    const int requests = 16;
+    std::string raw;
+    for (int i = 0; i < requests; ++i) raw += "GET /big HTTP/1.1\r\nHost: x\r\n\r\n";
+    int fd = http_connect(server.get_port());
+    std::string out = http_exchange(fd, raw, requests);
+    int answered = 0;
+    for (size_t pos = out.find("HTTP/1.1 200 OK"); pos != std::string::npos;
+         pos = out.find("HTTP/1.1 200 OK", pos + 1)) {
+        answered++;
+    }
+    assert(answered == requests);
+    assert(out.size() > (size_t)requests * 256 * 1024);
+    close(fd);
+
+    server.stop();
+    assert(server.get_stats().requests_served == (uint64_t)requests);
+}
+
+void test_http_server_streaming_upload() {
+    Scheduler scheduler;
+    APIGateway gateway(&scheduler);
+    gateway.start_server(0);
+    int fd = http_connect(gateway.get_server_port());
+
+    // Content-Length body, sent in two pieces
+    http_exchange(fd, "POST /v59/upload HTTP/1.1\r\nContent-Length: 11\r\n\r\nhello", 0);
+    std::string out = http_exchange(fd, " world", 1);
+    assert(out.find("HTTP/1.1 200 OK") == 0);
+    assert(read_upload_file(out) == "hello world");
+
+    // Chunked body with an extension and a trailer, split mid-chunk
+    http_exchange(fd, "POST /v59/upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                      "5;ext=1\r\nchunk\r\n7\r\ned body", 0);
+    out = http_exchange(fd, "\r\n0\r\nX-Trailer: 1\r\n\r\n", 1);
+    assert(out.find("HTTP/1.1 200 OK") == 0);
+    assert(read_upload_file(out) == "chunked body");
+
+    // Chunked bodies also work for buffered endpoints
+    out = http_exchange(fd, "POST /v59/axiom HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                            "6\r\n{\"prom\r\n9\r\npt\": \"x\"}\r\n0\r\n\r\n", 1);
+    assert(out.find("\"job_uuid\"") != std::string::npos);
+    close(fd);
+
+    // Oversized Content-Length is rejected from the head, before any body
+    fd = http_connect(gateway.get_server_port());
+    out = http_exchange(fd, "POST /v59/upload HTTP/1.1\r\nContent-Length: " +
+                            std::to_string((long long)API_MAX_UPLOAD_SIZE + 1) + "\r\n\r\n", 1);
+    assert(out.find("HTTP/1.1 413 Payload Too Large") == 0);
+    close(fd);
+
+    gateway.stop_server();
+}
+
+void test_http_server_event_stream() {
+    SchedulerConfig config;
+    config.num_workers = 1;
+    config.simulated_work_us = 3000;
+    Scheduler scheduler(config);
+    scheduler.start();
+    APIGateway gateway(&scheduler);
+    gateway.start_server(0);
+    int fd = http_connect(gateway.get_server_port());
+
+    // Tokens are pushed as chunked SSE events; a pipelined request behind
+    // the stream is answered once the stream ends
+    std::string request = "POST /v59/axiom?stream=1 HTTP/1.1\r\nContent-Length: 15\r\n\r\n{\"prompt\": \"x\"}"
+                          "GET /v59/health HTTP/1.1\r\n\r\n";
+    assert(write(fd, request.data(), request.size()) == (ssize_t)request.size());
+    std::string out;
+    char buffer[4096];
+    while (out.find("\"status\": \"healthy\"") == std::string::npos) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        assert(n > 0);
+        out.append(buffer, (size_t)n);
+    }
+    assert(out.find("HTTP/1.1 200 OK") == 0);
+    assert(out.find("Content-Type: text/event-stream") != std::string::npos);
+    assert(out.find("Transfer-Encoding: chunked") != std::string::npos);
+    assert(out.find("Content-Length", 0) > out.find("0\r\n\r\n"));
+
+    size_t queued = out.find("event: queued");
+    size_t first_token = out.find("event: token\ndata: Job\n");
+    size_t done = out.find("event: done\ndata: {\"job_id\": 1, \"status\": 2}");
+    size_t end = out.find("\r\n0\r\n\r\n");
+    assert(queued < first_token && first_token < done && done < end);
+    assert(out.find("event: token\ndata:  completed.") < done);
+    assert(out.find("HTTP/1.1 200 OK", end) == end + 7);
+
+    // Plain submissions are unchanged
+    out = http_exchange(fd, "POST /v59/axiom HTTP/1.1\r\nContent-Length: 15\r\n\r\n{\"prompt\": \"x\"}", 1);
+    assert(out.find("\"status\": \"QUEUED\"") != std::string::npos);
+    close(fd);
+
+    gateway.stop_server();
+    scheduler.stop();
+}
+
+void test_http_server_status_long_poll() {
+    SchedulerConfig config;
+    config.num_workers = 1;
+    config.simulated_work_us = 20000;
+    Scheduler scheduler(config);
+    APIGateway gateway(&scheduler);
+    gateway.start_server(0);
+    int fd = http_connect(gateway.get_server_port());
+
+    // No change within wait_ms: answered with the unchanged status on timeout
+    uint32_t id = scheduler.submit_job("test", "prompt");
+    std::string status_path = "GET /v59/status/" + std::to_string(id);
+    auto t0 = std::chrono::steady_clock::now();
+    std::string out = http_exchange(fd, status_path + "?wait_ms=50 HTTP/1.1\r\n\r\n", 1);
+    auto waited = std::chrono::steady_clock::now() - t0;
+    assert(out.find("HTTP/1.1 200 OK") == 0);
+    assert(out.find("Content-Length: ") != std::string::npos);
+    assert(out.find("\"status\": 0}") != std::string::npos);
+    assert(waited >= std::chrono::milliseconds(50) && waited < std::chrono::milliseconds(1000));
+
+    // A state change answers early; a pipelined request follows it in order
+    http_exchange(fd, status_path + "?x=1&wait_ms=5000 HTTP/1.1\r\n\r\n"
+                      "GET /v59/health HTTP/1.1\r\n\r\n", 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    scheduler.start();
+    out = http_exchange(fd, "", 2);
+    assert(out.find("\"status\": 1}") != std::string::npos);
+    assert(out.find("\"status\": 1}") < out.find("\"status\": \"healthy\""));
+    out = http_exchange(fd, status_path + "?wait_ms=5000 HTTP/1.1\r\n\r\n", 1);
+    assert(out.find("\"status\": 2}") != std::string::npos);
+    assert(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(2000));
+
+    // Finished jobs and plain polls return immediately
+    out = http_exchange(fd, status_path + "?wait_ms=5000 HTTP/1.1\r\n\r\n", 1);
+    assert(out.find("\"status\": 2}") != std::string::npos);
+    out = http_exchange(fd, status_path + " HTTP/1.1\r\n\r\n", 1);
+    assert(out.find("\"status\": 2}") != std::string::npos);
+    close(fd);
+
+    gateway.stop_server();
+    scheduler.stop();
+}
+
 // ============================================================================
 // MAIN
 // ============================================================================
@@ -179,11 +1987,45 @@ int main() {
     run_test(test_simd_relu_f64, "Vector ReLU f64");
     run_test(test_simd_gelu_f64, "Vector GELU f64");
     run_test(test_simd_tanh_f64, "Vector Tanh f64");
+    run_test(test_simd_dispatch_levels, "Vector SIMD Dispatch Levels");
+    run_test(test_simd_transcendental_accuracy, "Vector Exp/Tanh Accuracy");
+    run_test(test_simd_softmax_variants, "Vector Online/Log/Temperature Softmax");
+    run_test(test_simd_sample, "Vector Top-k/Top-p Sampling");
+    run_test(test_simd_fused, "Vector Fused Elementwise");
+    run_test(test_simd_parallel, "Vector Parallel Mode");
+    run_test(test_simd_variants, "Vector Restrict/In-Place/Unchecked Variants");
+    run_test(test_simd_reduced_precision, "Vector f32/bf16/int8 Kernels");
+    run_test(test_simd_dot_lanes16, "Vector 16-Lane Dot Order");
+    run_test(test_vec1024_backend, "Vec1024 Host Backend");
+    run_test(test_vec1024_matmul, "Vec1024 Matmul");
+    run_test(test_vec1024_matmul_reduced, "Vec1024 f32/bf16/int8 Matmul");
+    run_test(test_mamba_selective_scan, "Mamba Selective Scan");
+    run_test(test_hal_sim_noc, "HAL Simulator NOC");
+    run_test(test_hal_sim_wrench_tasks, "HAL Simulator Wrench & Tasks");
+    run_test(test_hal_sim_noc_ring, "HAL Simulator NOC Ring");
+    run_test(test_hal_sim_event_loop, "HAL Simulator Event Loop");
+    run_test(test_hal_sim_pipeline, "HAL Simulator Wrench/Key Pipeline");
+    run_test(test_task_ring_basics, "Task Ring Capacity & Backpressure");
+    run_test(test_task_ring_stress, "Task Ring SPSC/MPSC Stress");
 
     run_test(test_scheduler_submit_and_poll, "Scheduler Submit & Poll");
     run_test(test_scheduler_queue_size, "Scheduler Queue Size");
+    run_test(test_scheduler_priority_order, "Scheduler Priority Order");
+    run_test(test_scheduler_priority_aging, "Scheduler Priority Aging");
+    run_test(test_scheduler_history_retention, "Scheduler History Retention");
+    run_test(test_scheduler_work_stealing, "Scheduler Work Stealing");
+    run_test(test_scheduler_batching, "Scheduler Batching");
+    run_test(test_scheduler_token_stream, "Scheduler Token Stream");
 
     run_test(test_api_gateway_endpoints, "API Gateway Endpoints");
+    run_test(test_api_gateway_axiom_prompt, "API Gateway Axiom Prompt");
+    run_test(test_json_writer, "JSON Writer");
+    run_test(test_json_reader, "JSON Reader");
+    run_test(test_http_server_keepalive_pipelining, "HTTP Server Keep-Alive & Pipelining");
+    run_test(test_http_server_output_backpressure, "HTTP Server Output Backpressure");
+    run_test(test_http_server_streaming_upload, "HTTP Server Streaming Upload");
+    run_test(test_http_server_event_stream, "HTTP Server Event Stream");
+    run_test(test_http_server_status_long_poll, "HTTP Server Status Long-Poll");
 
     std::cout << "========================================================" << std::endl;
     std::cout << "Test Results: " << passed_tests << " / " << total_tests << " passed." << std::endl;
@@ -0,0 +1,89 @@
+#ifndef AGNI_VECTOR_KERNELS_H
+#define AGNI_VECTOR_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+#define VECTOR_SOFTMAX_BLOCK 32     // Elements sharing one running max in softmax_exp_blocks
+
+// ============================================================================
+// VECTOR KERNEL TABLE (internal to vector_utils)
+// One table per instruction-set level. Pointers are never null and the
+// public simd_* wrappers have already validated their arguments.
+// ============================================================================
+struct VectorKernels {
+    void (*add)(double* dst, const double* src1, const double* src2, size_t len);
+    void (*mul)(double* dst, const double* src1, const double* src2, size_t len);
+    // As add/mul, for dst that overlaps neither source
+    void (*add_noalias)(double* __restrict dst, const double* __restrict src1, const double* __restrict src2,
+                        size_t len);
+    void (*mul_noalias)(double* __restrict dst, const double* __restrict src1, const double* __restrict src2,
+                        size_t len);
+    double (*dot)(const double* src1, const double* src2, size_t len);
+    // Reduction order of a 16-lane vector unit; bit-identical at every level
+    double (*dot_lanes16)(const double* src1, const double* src2, size_t len);
+    void (*relu)(double* dst, const double* src, size_t len);
+    // dst[i] = fma(src[i], scale, shift)
+    void (*affine)(double* dst, const double* src, double scale, double shift, size_t len);
+    void (*exp)(double* dst, const double* src, size_t len);
+    void (*tanh)(double* dst, const double* src, size_t len);
+    void (*gelu)(double* dst, const double* src, size_t len);
+    // Online softmax statistics in one read: *max = max(src),
+    // *sum = sum(exp(scale * (src[i] - *max))). scale must be positive.
+    void (*softmax_stats)(const double* src, size_t len, double scale, double* max, double* sum);
+    // In place, in one pass: vec[i] = exp(scale * (vec[i] - block_max[b]))
+    // for block b = i / VECTOR_SOFTMAX_BLOCK, where block_max[b] is the
+    // running max after that block. *sum is relative to the final *max.
+    void (*softmax_exp_blocks)(double* vec, size_t len, double scale, double* block_max,
+                               double* max, double* sum);
+
+    // GEMM micro-kernel on packed panels: a holds kc columns of gemm_mr
+    // rows (a[k * mr + r]), b holds kc rows of gemm_nr columns
+    // (b[k * nr + j]). Each element of the mr x nr tile c (row stride ldc)
+    // is advanced by ascending-k fused multiply-add, starting from its
+    // current value when accumulate is set and from zero otherwise.
+    void (*gemm_micro)(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate);
+    size_t gemm_mr;
+    size_t gemm_nr;
+
+    // Reduced precision: f32 and bf16 accumulate in f32, int8 in int32.
+    // bf16 values are the upper 16 bits of an f32.
+    void (*add_f32)(float* dst, const float* src1, const float* src2, size_t len);
+    void (*mul_f32)(float* dst, const float* src1, const float* src2, size_t len);
+    float (*dot_f32)(const float* src1, const float* src2, size_t len);
+    void (*relu_f32)(float* dst, const float* src, size_t len);
+    float (*dot_bf16)(const uint16_t* src1, const uint16_t* src2, size_t len);
+    int32_t (*dot_i8)(const int8_t* src1, const int8_t* src2, size_t len);
+    // Same contract as gemm_micro, in f32 with fmaf ordering
+    void (*gemm_micro_f32)(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate);
+    size_t gemm_mr_f32;
+    size_t gemm_nr_f32;
+
+    // One state row of a selective scan across len channels:
+    // h[i] = decay[i] * h[i] + b * x[i], then y[i] += c * h[i]
+    void (*ssm_update)(double* h, const double* decay, const double* x, double b, double c,
+                       double* y, size_t len);
+};
+
+#define VECTOR_GEMM_MAX_MR 12
+#define VECTOR_GEMM_MAX_NR 16
+#define VECTOR_GEMM_MAX_NR_F32 32
+
+// Table for the level currently selected by simd_set_level()/CPUID
+const VectorKernels* vector_kernels_active();
+
+// Tables for the x86 levels; nullptr when the build cannot target them.
+// Whether the running CPU supports them is checked by the caller.
+const VectorKernels* vector_kernels_avx2();
+const VectorKernels* vector_kernels_avx512();
+
+// Parallel mode (vector_parallel.cpp): number of SIMD_PARALLEL_CHUNK-element
+// chunks to split len into, or 0 when the call should stay serial
+size_t vector_parallel_chunks(size_t len);
+
+// Runs task(c) for every c in [0, count) on the shared pool, the caller
+// included; returns once all have finished
+void vector_parallel_run(size_t count, const std::function<void(size_t)>& task);
+
+#endif // AGNI_VECTOR_KERNELS_H
@@ -0,0 +1,1122 @@
+#include "vector_kernels.h"
+
+// ============================================================================
+// x86 KERNELS
+// Each function carries its own target attribute, so this file needs no
+// special compiler flags and nothing here runs unless CPUID allowed it.
+// Loops are unrolled over four independent accumulators/registers to hide
+// FMA and load latency.
+// ============================================================================
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#define AGNI_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define AGNI_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+// GCC 12 false positive (PR 105593): the undefined passthrough __Y inside
+// avx512fintrin.h is reported as uninitialized once inlined here
+#if defined(__clang__)
+#define AGNI_AVX512_DIAGNOSTICS_BEGIN
+#define AGNI_AVX512_DIAGNOSTICS_END
+#else
+#define AGNI_AVX512_DIAGNOSTICS_BEGIN                              \
+    _Pragma("GCC diagnostic push")                                 \
+    _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")         \
+    _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define AGNI_AVX512_DIAGNOSTICS_END _Pragma("GCC diagnostic pop")
+#endif
+
+// ============================================================================
+// AVX2 + FMA (4 doubles per register)
+// ============================================================================
+AGNI_TARGET_AVX2
+static void add_avx2(double* dst, const double* src1, const double* src2, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256d a0 = _mm256_add_pd(_mm256_loadu_pd(src1 + i),      _mm256_loadu_pd(src2 + i));
+        __m256d a1 = _mm256_add_pd(_mm256_loadu_pd(src1 + i + 4),  _mm256_loadu_pd(src2 + i + 4));
+        __m256d a2 = _mm256_add_pd(_mm256_loadu_pd(src1 + i + 8),  _mm256_loadu_pd(src2 + i + 8));
+        __m256d a3 = _mm256_add_pd(_mm256_loadu_pd(src1 + i + 12), _mm256_loadu_pd(src2 + i + 12));
+        _mm256_storeu_pd(dst + i, a0);
+        _mm256_storeu_pd(dst + i + 4, a1);
+        _mm256_storeu_pd(dst + i + 8, a2);
+        _mm256_storeu_pd(dst + i + 12, a3);
+    }
+    for (; i + 4 <= len; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(src1 + i), _mm256_loadu_pd(src2 + i)));
+    }
+    for (; i < len; ++i) dst[i] = src1[i] + src2[i];
+}
+
+AGNI_TARGET_AVX2
+static void mul_avx2(double* dst, const double* src1, const double* src2, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256d m0 = _mm256_mul_pd(_mm256_loadu_pd(src1 + i),      _mm256_loadu_pd(src2 + i));
+        __m256d m1 = _mm256_mul_pd(_mm256_loadu_pd(src1 + i + 4),  _mm256_loadu_pd(src2 + i + 4));
+        __m256d m2 = _mm256_mul_pd(_mm256_loadu_pd(src1 + i + 8),  _mm256_loadu_pd(src2 + i + 8));
+        __m256d m3 = _mm256_mul_pd(_mm256_loadu_pd(src1 + i + 12), _mm256_loadu_pd(src2 + i + 12));
+        _mm256_storeu_pd(dst + i, m0);
+        _mm256_storeu_pd(dst + i + 4, m1);
+        _mm256_storeu_pd(dst + i + 8, m2);
+        _mm256_storeu_pd(dst + i + 12, m3);
+    }
+    for (; i + 4 <= len; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(src1 + i), _mm256_loadu_pd(src2 + i)));
+    }
+    for (; i < len; ++i) dst[i] = src1[i] * src2[i];
+}
+
+AGNI_TARGET_AVX2
+static double dot_avx2(const double* src1, const double* src2, size_t len) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(src1 + i),      _mm256_loadu_pd(src2 + i),      acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(src1 + i + 4),  _mm256_loadu_pd(src2 + i + 4),  acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(src1 + i + 8),  _mm256_loadu_pd(src2 + i + 8),  acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(src1 + i + 12), _mm256_loadu_pd(src2 + i + 12), acc3);
+    }
+    for (; i + 4 <= len; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(src1 + i), _mm256_loadu_pd(src2 + i), acc0);
+    }
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double result = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < len; ++i) result += src1[i] * src2[i];
+    return result;
+}
+
+// Lanes 0-15 live in acc[0..3]; the fold order matches dot_lanes16_scalar.
+// Padding a partial strip with zeros leaves its idle lanes unchanged.
+AGNI_TARGET_AVX2
+static double dot_lanes16_avx2(const double* src1, const double* src2, size_t len) {
+    __m256d acc[4] = { _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd() };
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        for (int j = 0; j < 4; ++j) {
+            acc[j] = _mm256_fmadd_pd(_mm256_loadu_pd(src1 + i + 4 * j), _mm256_loadu_pd(src2 + i + 4 * j), acc[j]);
+        }
+    }
+    if (i < len) {
+        double a[16] = {0.0}, b[16] = {0.0};
+        memcpy(a, src1 + i, (len - i) * sizeof(double));
+        memcpy(b, src2 + i, (len - i) * sizeof(double));
+        for (int j = 0; j < 4; ++j) {
+            acc[j] = _mm256_fmadd_pd(_mm256_loadu_pd(a + 4 * j), _mm256_loadu_pd(b + 4 * j), acc[j]);
+        }
+    }
+    __m256d folded = _mm256_add_pd(_mm256_add_pd(acc[0], acc[2]), _mm256_add_pd(acc[1], acc[3]));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(folded), _mm256_extractf128_pd(folded, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+// max(x, +0) returns +0 for NaN and -0 inputs, matching the scalar code
+AGNI_TARGET_AVX2
+static void relu_avx2(double* dst, const double* src, size_t len) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256d r0 = _mm256_max_pd(_mm256_loadu_pd(src + i),      zero);
+        __m256d r1 = _mm256_max_pd(_mm256_loadu_pd(src + i + 4),  zero);
+        __m256d r2 = _mm256_max_pd(_mm256_loadu_pd(src + i + 8),  zero);
+        __m256d r3 = _mm256_max_pd(_mm256_loadu_pd(src + i + 12), zero);
+        _mm256_storeu_pd(dst + i, r0);
+        _mm256_storeu_pd(dst + i + 4, r1);
+        _mm256_storeu_pd(dst + i + 8, r2);
+        _mm256_storeu_pd(dst + i + 12, r3);
+    }
+    for (; i + 4 <= len; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_max_pd(_mm256_loadu_pd(src + i), zero));
+    }
+    for (; i < len; ++i) dst[i] = (src[i] > 0.0) ? src[i] : 0.0;
+}
+
+AGNI_TARGET_AVX2
+static void affine_avx2(double* dst, const double* src, double scale, double shift, size_t len) {
+    const __m256d vs = _mm256_set1_pd(scale);
+    const __m256d vt = _mm256_set1_pd(shift);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256d r0 = _mm256_fmadd_pd(_mm256_loadu_pd(src + i),      vs, vt);
+        __m256d r1 = _mm256_fmadd_pd(_mm256_loadu_pd(src + i + 4),  vs, vt);
+        __m256d r2 = _mm256_fmadd_pd(_mm256_loadu_pd(src + i + 8),  vs, vt);
+        __m256d r3 = _mm256_fmadd_pd(_mm256_loadu_pd(src + i + 12), vs, vt);
+        _mm256_storeu_pd(dst + i, r0);
+        _mm256_storeu_pd(dst + i + 4, r1);
+        _mm256_storeu_pd(dst + i + 8, r2);
+        _mm256_storeu_pd(dst + i + 12, r3);
+    }
+    for (; i + 4 <= len; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_fmadd_pd(_mm256_loadu_pd(src + i), vs, vt));
+    }
+    for (; i < len; ++i) dst[i] = fma(src[i], scale, shift);
+}
+
+// ============================================================================
+// AVX-512F (8 doubles per register, masked tails)
+// ============================================================================
+AGNI_AVX512_DIAGNOSTICS_BEGIN
+
+AGNI_TARGET_AVX512
+static inline __mmask8 tail_mask(size_t remaining) {
+    return (__mmask8)((1u << remaining) - 1u);
+}
+
+AGNI_TARGET_AVX512
+static void add_avx512(double* dst, const double* src1, const double* src2, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m512d a0 = _mm512_add_pd(_mm512_loadu_pd(src1 + i),      _mm512_loadu_pd(src2 + i));
+        __m512d a1 = _mm512_add_pd(_mm512_loadu_pd(src1 + i + 8),  _mm512_loadu_pd(src2 + i + 8));
+        __m512d a2 = _mm512_add_pd(_mm512_loadu_pd(src1 + i + 16), _mm512_loadu_pd(src2 + i + 16));
+        __m512d a3 = _mm512_add_pd(_mm512_loadu_pd(src1 + i + 24), _mm512_loadu_pd(src2 + i + 24));
+        _mm512_storeu_pd(dst + i, a0);
+        _mm512_storeu_pd(dst + i + 8, a1);
+        _mm512_storeu_pd(dst + i + 16, a2);
+        _mm512_storeu_pd(dst + i + 24, a3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(src1 + i), _mm512_loadu_pd(src2 + i)));
+    }
+    if (i < len) {
+        __mmask8 m = tail_mask(len - i);
+        _mm512_mask_storeu_pd(dst + i, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, src1 + i),
+                                                        _mm512_maskz_loadu_pd(m, src2 + i)));
+    }
+}
+
+AGNI_TARGET_AVX512
+static void mul_avx512(double* dst, const double* src1, const double* src2, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m512d m0 = _mm512_mul_pd(_mm512_loadu_pd(src1 + i),      _mm512_loadu_pd(src2 + i));
+        __m512d m1 = _mm512_mul_pd(_mm512_loadu_pd(src1 + i + 8),  _mm512_loadu_pd(src2 + i + 8));
+        __m512d m2 = _mm512_mul_pd(_mm512_loadu_pd(src1 + i + 16), _mm512_loadu_pd(src2 + i + 16));
+        __m512d m3 = _mm512_mul_pd(_mm512_loadu_pd(src1 + i + 24), _mm512_loadu_pd(src2 + i + 24));
+        _mm512_storeu_pd(dst + i, m0);
+        _mm512_storeu_pd(dst + i + 8, m1);
+        _mm512_storeu_pd(dst + i + 16, m2);
+        _mm512_storeu_pd(dst + i + 24, m3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_loadu_pd(src1 + i), _mm512_loadu_pd(src2 + i)));
+    }
+    if (i < len) {
+        __mmask8 m = tail_mask(len - i);
+        _mm512_mask_storeu_pd(dst + i, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, src1 + i),
+                                                        _mm512_maskz_loadu_pd(m, src2 + i)));
+    }
+}
+
+AGNI_TARGET_AVX512
+static double dot_avx512(const double* src1, const double* src2, size_t len) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i),      _mm512_loadu_pd(src2 + i),      acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i + 8),  _mm512_loadu_pd(src2 + i + 8),  acc1);
+        acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i + 16), _mm512_loadu_pd(src2 + i + 16), acc2);
+        acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i + 24), _mm512_loadu_pd(src2 + i + 24), acc3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i), _mm512_loadu_pd(src2 + i), acc0);
+    }
+    if (i < len) {
+        __mmask8 m = tail_mask(len - i);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, src1 + i), _mm512_maskz_loadu_pd(m, src2 + i), acc1);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+}
+
+AGNI_TARGET_AVX512
+static double dot_lanes16_avx512(const double* src1, const double* src2, size_t len) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i),     _mm512_loadu_pd(src2 + i),     acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(src1 + i + 8), _mm512_loadu_pd(src2 + i + 8), acc1);
+    }
+    if (i < len) {
+        size_t rem = len - i;
+        __mmask8 m0 = (rem >= 8) ? (__mmask8)0xFF : tail_mask(rem);
+        __mmask8 m1 = (rem > 8) ? tail_mask(rem - 8) : (__mmask8)0;
+        acc0 = _mm512_mask3_fmadd_pd(_mm512_maskz_loadu_pd(m0, src1 + i), _mm512_maskz_loadu_pd(m0, src2 + i), acc0, m0);
+        acc1 = _mm512_mask3_fmadd_pd(_mm512_maskz_loadu_pd(m1, src1 + i + 8), _mm512_maskz_loadu_pd(m1, src2 + i + 8), acc1, m1);
+    }
+    __m512d folded = _mm512_add_pd(acc0, acc1);
+    __m256d quarter = _mm256_add_pd(_mm512_castpd512_pd256(folded), _mm512_extractf64x4_pd(folded, 1));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(quarter), _mm256_extractf128_pd(quarter, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+AGNI_TARGET_AVX512
+static void relu_avx512(double* dst, const double* src, size_t len) {
+    const __m512d zero = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m512d r0 = _mm512_max_pd(_mm512_loadu_pd(src + i),      zero);
+        __m512d r1 = _mm512_max_pd(_mm512_loadu_pd(src + i + 8),  zero);
+        __m512d r2 = _mm512_max_pd(_mm512_loadu_pd(src + i + 16), zero);
+        __m512d r3 = _mm512_max_pd(_mm512_loadu_pd(src + i + 24), zero);
+        _mm512_storeu_pd(dst + i, r0);
+        _mm512_storeu_pd(dst + i + 8, r1);
+        _mm512_storeu_pd(dst + i + 16, r2);
+        _mm512_storeu_pd(dst + i + 24, r3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        _mm512_storeu_pd(dst + i, _mm512_max_pd(_mm512_loadu_pd(src + i), zero));
+    }
+    if (i < len) {
+        __mmask8 m = tail_mask(len - i);
+        _mm512_mask_storeu_pd(dst + i, m, _mm512_max_pd(_mm512_maskz_loadu_pd(m, src + i), zero));
+    }
+}
+
+AGNI_TARGET_AVX512
+static void affine_avx512(double* dst, const double* src, double scale, double shift, size_t len) {
+    const __m512d vs = _mm512_set1_pd(scale);
+    const __m512d vt = _mm512_set1_pd(shift);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m512d r0 = _mm512_fmadd_pd(_mm512_loadu_pd(src + i),      vs, vt);
+        __m512d r1 = _mm512_fmadd_pd(_mm512_loadu_pd(src + i + 8),  vs, vt);
+        __m512d r2 = _mm512_fmadd_pd(_mm512_loadu_pd(src + i + 16), vs, vt);
+        __m512d r3 = _mm512_fmadd_pd(_mm512_loadu_pd(src + i + 24), vs, vt);
+        _mm512_storeu_pd(dst + i, r0);
+        _mm512_storeu_pd(dst + i + 8, r1);
+        _mm512_storeu_pd(dst + i + 16, r2);
+        _mm512_storeu_pd(dst + i + 24, r3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        _mm512_storeu_pd(dst + i, _mm512_fmadd_pd(_mm512_loadu_pd(src + i), vs, vt));
+    }
+    if (i < len) {
+        __mmask8 m = tail_mask(len - i);
+        _mm512_mask_storeu_pd(dst + i, m, _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, src + i), vs, vt));
+    }
+}
+
+AGNI_AVX512_DIAGNOSTICS_END
+
+// ============================================================================
+// TRANSCENDENTALS
+// exp(x) = 2^n * exp(r) with n = round(x / ln2) and |r| <= ln2/2 after a
+// two-constant (Cody-Waite) reduction. exp(r) - 1 = r + r^2 * Q(r), where
+// Q is the Taylor series through r^11/13!; its truncation error is below
+// 1e-17 on the reduced range. tanh(|x|) = e / (e + 2) with
+// e = expm1(2|x|), which has no cancellation near zero. GELU uses
+// 0.5x(1 + tanh(u)) = x / (1 + exp(-2u)), which has none for negative x.
+// NaN inputs are passed through by a final blend.
+// ============================================================================
+static const double EXP_CLAMP_LO = -746.0;      // exp() rounds to +0 below
+static const double EXP_CLAMP_HI = 710.0;       // exp() overflows above
+static const double TANH_CLAMP   = 20.0;        // tanh() rounds to 1 above
+static const double LOG2E        = 1.4426950408889634074;
+static const double LN2_HI       = 6.93147180369123816490e-01;   // 32 significant bits
+static const double LN2_LO       = 1.90821492927058770002e-10;
+static const double GELU_SQRT_2_PI = 0.7978845608028654;
+static const double GELU_COEFF     = 0.044715;
+
+// 1/2!, 1/3!, ..., 1/13!
+static const double EXPM1_Q[12] = {
+    5.00000000000000000000e-01, 1.66666666666666666667e-01,
+    4.16666666666666666667e-02, 8.33333333333333333333e-03,
+    1.38888888888888888889e-03, 1.98412698412698412698e-04,
+    2.48015873015873015873e-05, 2.75573192239858906526e-06,
+    2.75573192239858906526e-07, 2.50521083854417187751e-08,
+    2.08767569878680989792e-09, 1.60590438368216145994e-10
+};
+
+AGNI_TARGET_AVX2
+static inline __m256d expm1_reduced_avx2(__m256d r) {
+    __m256d q = _mm256_set1_pd(EXPM1_Q[11]);
+    for (int k = 10; k >= 0; --k) q = _mm256_fmadd_pd(q, r, _mm256_set1_pd(EXPM1_Q[k]));
+    return _mm256_fmadd_pd(_mm256_mul_pd(r, r), q, r);
+}
+
+// Splits x into n and r; n is integer-valued
+AGNI_TARGET_AVX2
+static inline __m256d reduce_ln2_avx2(__m256d x, __m256d* n) {
+    *n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(*n, _mm256_set1_pd(LN2_HI), x);
+    return _mm256_fnmadd_pd(*n, _mm256_set1_pd(LN2_LO), r);
+}
+
+// 2^n for integer n in [-1022, 1023]
+AGNI_TARGET_AVX2
+static inline __m256d pow2_avx2(__m128i n) {
+    __m256i bits = _mm256_cvtepi32_epi64(_mm_add_epi32(n, _mm_set1_epi32(1023)));
+    return _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+}
+
+AGNI_TARGET_AVX2
+static inline __m256d exp_avx2_pd(__m256d x) {
+    __m256d xc = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_CLAMP_LO)), _mm256_set1_pd(EXP_CLAMP_HI));
+    __m256d n;
+    __m256d r = reduce_ln2_avx2(xc, &n);
+    __m256d p = _mm256_add_pd(expm1_reduced_avx2(r), _mm256_set1_pd(1.0));
+
+    // Scale in two halves so n in [-1076, 1024] reaches subnormals and +inf
+    __m128i ni = _mm256_cvtpd_epi32(n);
+    __m128i n1 = _mm_srai_epi32(ni, 1);
+    __m128i n2 = _mm_sub_epi32(ni, n1);
+    __m256d y = _mm256_mul_pd(_mm256_mul_pd(p, pow2_avx2(n1)), pow2_avx2(n2));
+    return _mm256_blendv_pd(y, x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+}
+
+AGNI_TARGET_AVX2
+static inline __m256d tanh_avx2_pd(__m256d x) {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    __m256d ax = _mm256_min_pd(_mm256_andnot_pd(sign_mask, x), _mm256_set1_pd(TANH_CLAMP));
+    __m256d n;
+    __m256d r = reduce_ln2_avx2(_mm256_add_pd(ax, ax), &n);
+    __m256d s = pow2_avx2(_mm256_cvtpd_epi32(n));       // n in [0, 58]
+    __m256d e = _mm256_fmadd_pd(s, expm1_reduced_avx2(r), _mm256_sub_pd(s, _mm256_set1_pd(1.0)));
+    __m256d t = _mm256_div_pd(e, _mm256_add_pd(e, _mm256_set1_pd(2.0)));
+    t = _mm256_or_pd(t, _mm256_and_pd(sign_mask, x));
+    return _mm256_blendv_pd(t, x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+}
+
+AGNI_TARGET_AVX2
+static inline __m256d gelu_avx2_pd(__m256d x) {
+    __m256d x3 = _mm256_mul_pd(_mm256_mul_pd(x, x), x);
+    __m256d u = _mm256_mul_pd(_mm256_set1_pd(GELU_SQRT_2_PI), _mm256_fmadd_pd(_mm256_set1_pd(GELU_COEFF), x3, x));
+    __m256d z = exp_avx2_pd(_mm256_mul_pd(u, _mm256_set1_pd(-2.0)));
+    return _mm256_div_pd(x, _mm256_add_pd(z, _mm256_set1_pd(1.0)));
+}
+
+// Tails run through a padded stack buffer so every element takes the same
+// vector path regardless of its position
+#define AGNI_AVX2_UNARY(name, op)                                               \
+AGNI_TARGET_AVX2                                                                \
+static void name(double* dst, const double* src, size_t len) {                  \
+    size_t i = 0;                                                               \
+    for (; i + 8 <= len; i += 8) {                                              \
+        __m256d v0 = op(_mm256_loadu_pd(src + i));                              \
+        __m256d v1 = op(_mm256_loadu_pd(src + i + 4));                          \
+        _mm256_storeu_pd(dst + i, v0);                                          \
+        _mm256_storeu_pd(dst + i + 4, v1);                                      \
+    }                                                                           \
+    for (; i + 4 <= len; i += 4) {                                              \
+        _mm256_storeu_pd(dst + i, op(_mm256_loadu_pd(src + i)));                \
+    }                                                                           \
+    if (i < len) {                                                              \
+        double buf[4] = {0.0, 0.0, 0.0, 0.0};                                   \
+        memcpy(buf, src + i, (len - i) * sizeof(double));                       \
+        _mm256_storeu_pd(buf, op(_mm256_loadu_pd(buf)));                        \
+        memcpy(dst + i, buf, (len - i) * sizeof(double));                       \
+    }                                                                           \
+}
+
+AGNI_AVX2_UNARY(exp_avx2, exp_avx2_pd)
+AGNI_AVX2_UNARY(tanh_avx2, tanh_avx2_pd)
+AGNI_AVX2_UNARY(gelu_avx2, gelu_avx2_pd)
+
+// Per-lane running max and sum, updated once per 16-element block; lanes
+// are merged at the end. The sum is only rescaled when a lane's max moves.
+AGNI_TARGET_AVX2
+static void softmax_stats_avx2(const double* src, size_t len, double scale, double* max, double* sum) {
+    const __m256d vscale = _mm256_set1_pd(scale);
+    __m256d m = _mm256_set1_pd(-DBL_MAX);
+    __m256d s = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256d x0 = _mm256_loadu_pd(src + i);
+        __m256d x1 = _mm256_loadu_pd(src + i + 4);
+        __m256d x2 = _mm256_loadu_pd(src + i + 8);
+        __m256d x3 = _mm256_loadu_pd(src + i + 12);
+        __m256d bm = _mm256_max_pd(_mm256_max_pd(x0, x1), _mm256_max_pd(x2, x3));
+        if (_mm256_movemask_pd(_mm256_cmp_pd(bm, m, _CMP_GT_OQ))) {
+            __m256d m_new = _mm256_max_pd(bm, m);
+            s = _mm256_mul_pd(s, exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(m, m_new))));
+            m = m_new;
+        }
+        __m256d e0 = exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(x0, m)));
+        __m256d e1 = exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(x1, m)));
+        __m256d e2 = exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(x2, m)));
+        __m256d e3 = exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(x3, m)));
+        s = _mm256_add_pd(s, _mm256_add_pd(_mm256_add_pd(e0, e1), _mm256_add_pd(e2, e3)));
+    }
+    for (; i < len; i += 4) {
+        // Padding with -inf contributes exp(-inf) = 0 to the sum
+        double buf[4] = {-INFINITY, -INFINITY, -INFINITY, -INFINITY};
+        memcpy(buf, src + i, ((len - i < 4) ? len - i : 4) * sizeof(double));
+        __m256d x = _mm256_loadu_pd(buf);
+        __m256d m_new = _mm256_max_pd(x, m);
+        s = _mm256_mul_pd(s, exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(m, m_new))));
+        m = m_new;
+        s = _mm256_add_pd(s, exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(x, m))));
+    }
+
+    double lane_m[4], lane_s[4];
+    _mm256_storeu_pd(lane_m, m);
+    _mm256_storeu_pd(lane_s, s);
+    double total_m = lane_m[0];
+    for (int k = 1; k < 4; ++k) total_m = (lane_m[k] > total_m) ? lane_m[k] : total_m;
+    double total_s = 0.0;
+    for (int k = 0; k < 4; ++k) total_s += lane_s[k] * exp(scale * (lane_m[k] - total_m));
+    *max = total_m;
+    *sum = total_s;
+}
+
+// The block max is reduced across lanes so one running max covers the
+// whole block; the partial last block runs through a -inf padded buffer
+AGNI_TARGET_AVX2
+static void softmax_exp_blocks_avx2(double* vec, size_t len, double scale, double* block_max,
+                                    double* max, double* sum) {
+    const __m256d vscale = _mm256_set1_pd(scale);
+    double m = -DBL_MAX;
+    __m256d vm = _mm256_set1_pd(m);
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    double buf[VECTOR_SOFTMAX_BLOCK];
+    for (size_t base = 0, b = 0; base < len; base += VECTOR_SOFTMAX_BLOCK, ++b) {
+        size_t n = (len - base < VECTOR_SOFTMAX_BLOCK) ? len - base : VECTOR_SOFTMAX_BLOCK;
+        double* block = vec + base;
+        if (n < VECTOR_SOFTMAX_BLOCK) {
+            for (size_t j = 0; j < VECTOR_SOFTMAX_BLOCK; ++j) buf[j] = -INFINITY;
+            memcpy(buf, block, n * sizeof(double));
+            block = buf;
+        }
+
+        __m256d bm = _mm256_loadu_pd(block);
+        for (size_t j = 4; j < VECTOR_SOFTMAX_BLOCK; j += 4) bm = _mm256_max_pd(bm, _mm256_loadu_pd(block + j));
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(bm), _mm256_extractf128_pd(bm, 1));
+        double block_top = _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+        if (block_top > m) {
+            __m256d rescale = _mm256_set1_pd(exp(scale * (m - block_top)));
+            s0 = _mm256_mul_pd(s0, rescale);
+            s1 = _mm256_mul_pd(s1, rescale);
+            m = block_top;
+            vm = _mm256_set1_pd(m);
+        }
+        block_max[b] = m;
+
+        for (size_t j = 0; j < VECTOR_SOFTMAX_BLOCK; j += 8) {
+            __m256d e0 = exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(_mm256_loadu_pd(block + j), vm)));
+            __m256d e1 = exp_avx2_pd(_mm256_mul_pd(vscale, _mm256_sub_pd(_mm256_loadu_pd(block + j + 4), vm)));
+            _mm256_storeu_pd(block + j, e0);
+            _mm256_storeu_pd(block + j + 4, e1);
+            s0 = _mm256_add_pd(s0, e0);
+            s1 = _mm256_add_pd(s1, e1);
+        }
+        if (block == buf) memcpy(vec + base, buf, n * sizeof(double));
+    }
+    __m256d acc = _mm256_add_pd(s0, s1);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    *max = m;
+    *sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+AGNI_AVX512_DIAGNOSTICS_BEGIN
+
+AGNI_TARGET_AVX512
+static inline __m512d expm1_reduced_avx512(__m512d r) {
+    __m512d q = _mm512_set1_pd(EXPM1_Q[11]);
+    for (int k = 10; k >= 0; --k) q = _mm512_fmadd_pd(q, r, _mm512_set1_pd(EXPM1_Q[k]));
+    return _mm512_fmadd_pd(_mm512_mul_pd(r, r), q, r);
+}
+
+AGNI_TARGET_AVX512
+static inline __m512d reduce_ln2_avx512(__m512d x, __m512d* n) {
+    *n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(*n, _mm512_set1_pd(LN2_HI), x);
+    return _mm512_fnmadd_pd(*n, _mm512_set1_pd(LN2_LO), r);
+}
+
+// scalef handles subnormal results and overflow in one step
+AGNI_TARGET_AVX512
+static inline __m512d exp_avx512_pd(__m512d x) {
+    __m512d xc = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(EXP_CLAMP_LO)), _mm512_set1_pd(EXP_CLAMP_HI));
+    __m512d n;
+    __m512d r = reduce_ln2_avx512(xc, &n);
+    __m512d y = _mm512_scalef_pd(_mm512_add_pd(expm1_reduced_avx512(r), _mm512_set1_pd(1.0)), n);
+    return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q), y, x);
+}
+
+AGNI_TARGET_AVX512
+static inline __m512d tanh_avx512_pd(__m512d x) {
+    const __m512i sign_mask = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+    __m512i xi = _mm512_castpd_si512(x);
+    __m512d ax = _mm512_min_pd(_mm512_castsi512_pd(_mm512_andnot_si512(sign_mask, xi)), _mm512_set1_pd(TANH_CLAMP));
+    __m512d n;
+    __m512d r = reduce_ln2_avx512(_mm512_add_pd(ax, ax), &n);
+    __m512d s = _mm512_scalef_pd(_mm512_set1_pd(1.0), n);
+    __m512d e = _mm512_fmadd_pd(s, expm1_reduced_avx512(r), _mm512_sub_pd(s, _mm512_set1_pd(1.0)));
+    __m512d t = _mm512_div_pd(e, _mm512_add_pd(e, _mm512_set1_pd(2.0)));
+    t = _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(t), _mm512_and_si512(sign_mask, xi)));
+    return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q), t, x);
+}
+
+AGNI_TARGET_AVX512
+static inline __m512d gelu_avx512_pd(__m512d x) {
+    __m512d x3 = _mm512_mul_pd(_mm512_mul_pd(x, x), x);
+    __m512d u = _mm512_mul_pd(_mm512_set1_pd(GELU_SQRT_2_PI), _mm512_fmadd_pd(_mm512_set1_pd(GELU_COEFF), x3, x));
+    __m512d z = exp_avx512_pd(_mm512_mul_pd(u, _mm512_set1_pd(-2.0)));
+    return _mm512_div_pd(x, _mm512_add_pd(z, _mm512_set1_pd(1.0)));
+}
+
+#define AGNI_AVX512_UNARY(name, op)                                             \
+AGNI_TARGET_AVX512                                                              \
+static void name(double* dst, const double* src, size_t len) {                  \
+    size_t i = 0;                                                               \
+    for (; i + 16 <= len; i += 16) {                                            \
+        __m512d v0 = op(_mm512_loadu_pd(src + i));                              \
+        __m512d v1 = op(_mm512_loadu_pd(src + i + 8));                          \
+        _mm512_storeu_pd(dst + i, v0);                                          \
+        _mm512_storeu_pd(dst + i + 8, v1);                                      \
+    }                                                                           \
+    for (; i + 8 <= len; i += 8) {                                              \
+        _mm512_storeu_pd(dst + i, op(_mm512_loadu_pd(src + i)));                \
+    }                                                                           \
+    if (i < len) {                                                              \
+        __mmask8 m = tail_mask(len - i);                                        \
+        _mm512_mask_storeu_pd(dst + i, m, op(_mm512_maskz_loadu_pd(m, src + i))); \
+    }                                                                           \
+}
+
+AGNI_AVX512_UNARY(exp_avx512, exp_avx512_pd)
+AGNI_AVX512_UNARY(tanh_avx512, tanh_avx512_pd)
+AGNI_AVX512_UNARY(gelu_avx512, gelu_avx512_pd)
+
+AGNI_TARGET_AVX512
+static void softmax_stats_avx512(const double* src, size_t len, double scale, double* max, double* sum) {
+    const __m512d vscale = _mm512_set1_pd(scale);
+    const __m512d neg_inf = _mm512_set1_pd(-INFINITY);
+    __m512d m = _mm512_set1_pd(-DBL_MAX);
+    __m512d s = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m512d x0 = _mm512_loadu_pd(src + i);
+        __m512d x1 = _mm512_loadu_pd(src + i + 8);
+        __m512d x2 = _mm512_loadu_pd(src + i + 16);
+        __m512d x3 = _mm512_loadu_pd(src + i + 24);
+        __m512d bm = _mm512_max_pd(_mm512_max_pd(x0, x1), _mm512_max_pd(x2, x3));
+        if (_mm512_cmp_pd_mask(bm, m, _CMP_GT_OQ)) {
+            __m512d m_new = _mm512_max_pd(bm, m);
+            s = _mm512_mul_pd(s, exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(m, m_new))));
+            m = m_new;
+        }
+        __m512d e0 = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x0, m)));
+        __m512d e1 = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x1, m)));
+        __m512d e2 = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x2, m)));
+        __m512d e3 = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x3, m)));
+        s = _mm512_add_pd(s, _mm512_add_pd(_mm512_add_pd(e0, e1), _mm512_add_pd(e2, e3)));
+    }
+    for (; i < len; i += 8) {
+        __mmask8 k = (len - i < 8) ? tail_mask(len - i) : (__mmask8)0xFF;
+        __m512d x = _mm512_mask_loadu_pd(neg_inf, k, src + i);
+        __m512d m_new = _mm512_max_pd(x, m);
+        s = _mm512_mul_pd(s, exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(m, m_new))));
+        m = m_new;
+        s = _mm512_add_pd(s, exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x, m))));
+    }
+
+    double total_m = _mm512_reduce_max_pd(m);
+    __m512d w = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(m, _mm512_set1_pd(total_m))));
+    *max = total_m;
+    *sum = _mm512_reduce_add_pd(_mm512_mul_pd(s, w));
+}
+
+AGNI_TARGET_AVX512
+static void softmax_exp_blocks_avx512(double* vec, size_t len, double scale, double* block_max,
+                                      double* max, double* sum) {
+    const __m512d vscale = _mm512_set1_pd(scale);
+    const __m512d neg_inf = _mm512_set1_pd(-INFINITY);
+    const int lanes = VECTOR_SOFTMAX_BLOCK / 8;
+    double m = -DBL_MAX;
+    __m512d vm = _mm512_set1_pd(m);
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    for (size_t base = 0, b = 0; base < len; base += VECTOR_SOFTMAX_BLOCK, ++b) {
+        size_t n = (len - base < VECTOR_SOFTMAX_BLOCK) ? len - base : VECTOR_SOFTMAX_BLOCK;
+        __m512d x[lanes];
+        __mmask8 k[lanes];
+        for (int j = 0; j < lanes; ++j) {
+            size_t off = (size_t)j * 8;
+            k[j] = (off >= n) ? (__mmask8)0 : (n - off >= 8) ? (__mmask8)0xFF : tail_mask(n - off);
+            x[j] = _mm512_mask_loadu_pd(neg_inf, k[j], vec + base + off);
+        }
+        __m512d bm = x[0];
+        for (int j = 1; j < lanes; ++j) bm = _mm512_max_pd(bm, x[j]);
+        double block_top = _mm512_reduce_max_pd(bm);
+        if (block_top > m) {
+            __m512d rescale = _mm512_set1_pd(exp(scale * (m - block_top)));
+            s0 = _mm512_mul_pd(s0, rescale);
+            s1 = _mm512_mul_pd(s1, rescale);
+            m = block_top;
+            vm = _mm512_set1_pd(m);
+        }
+        block_max[b] = m;
+
+        for (int j = 0; j < lanes; j += 2) {
+            __m512d e0 = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x[j], vm)));
+            __m512d e1 = exp_avx512_pd(_mm512_mul_pd(vscale, _mm512_sub_pd(x[j + 1], vm)));
+            _mm512_mask_storeu_pd(vec + base + (size_t)j * 8, k[j], e0);
+            _mm512_mask_storeu_pd(vec + base + (size_t)j * 8 + 8, k[j + 1], e1);
+            s0 = _mm512_add_pd(s0, e0);
+            s1 = _mm512_add_pd(s1, e1);
+        }
+    }
+    *max = m;
+    *sum = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+AGNI_AVX512_DIAGNOSTICS_END
+
+// ============================================================================
+// GEMM MICRO-KERNELS
+// The accumulator tile stays in registers for the whole kc loop: one
+// broadcast of A per row and one load of B per register column per k.
+// ============================================================================
+static const size_t GEMM_AVX2_MR = 6;       // 12 ymm accumulators
+static const size_t GEMM_AVX2_NR = 8;
+static const size_t GEMM_AVX512_MR = 12;    // 24 zmm accumulators
+static const size_t GEMM_AVX512_NR = 16;    // One 16 x f64 strip
+
+AGNI_TARGET_AVX2
+static void gemm_micro_avx2(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate) {
+    __m256d c0[GEMM_AVX2_MR], c1[GEMM_AVX2_MR];
+    for (size_t r = 0; r < GEMM_AVX2_MR; ++r) {
+        c0[r] = accumulate ? _mm256_loadu_pd(c + r * ldc) : _mm256_setzero_pd();
+        c1[r] = accumulate ? _mm256_loadu_pd(c + r * ldc + 4) : _mm256_setzero_pd();
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        __m256d b0 = _mm256_loadu_pd(b + k * GEMM_AVX2_NR);
+        __m256d b1 = _mm256_loadu_pd(b + k * GEMM_AVX2_NR + 4);
+        const double* ak = a + k * GEMM_AVX2_MR;
+        for (size_t r = 0; r < GEMM_AVX2_MR; ++r) {
+            __m256d ar = _mm256_broadcast_sd(ak + r);
+            c0[r] = _mm256_fmadd_pd(ar, b0, c0[r]);
+            c1[r] = _mm256_fmadd_pd(ar, b1, c1[r]);
+        }
+    }
+    for (size_t r = 0; r < GEMM_AVX2_MR; ++r) {
+        _mm256_storeu_pd(c + r * ldc, c0[r]);
+        _mm256_storeu_pd(c + r * ldc + 4, c1[r]);
+    }
+}
+
+AGNI_TARGET_AVX512
+static void gemm_micro_avx512(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate) {
+    __m512d c0[GEMM_AVX512_MR], c1[GEMM_AVX512_MR];
+    for (size_t r = 0; r < GEMM_AVX512_MR; ++r) {
+        c0[r] = accumulate ? _mm512_loadu_pd(c + r * ldc) : _mm512_setzero_pd();
+        c1[r] = accumulate ? _mm512_loadu_pd(c + r * ldc + 8) : _mm512_setzero_pd();
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        __m512d b0 = _mm512_loadu_pd(b + k * GEMM_AVX512_NR);
+        __m512d b1 = _mm512_loadu_pd(b + k * GEMM_AVX512_NR + 8);
+        const double* ak = a + k * GEMM_AVX512_MR;
+        for (size_t r = 0; r < GEMM_AVX512_MR; ++r) {
+            __m512d ar = _mm512_set1_pd(ak[r]);
+            c0[r] = _mm512_fmadd_pd(ar, b0, c0[r]);
+            c1[r] = _mm512_fmadd_pd(ar, b1, c1[r]);
+        }
+    }
+    for (size_t r = 0; r < GEMM_AVX512_MR; ++r) {
+        _mm512_storeu_pd(c + r * ldc, c0[r]);
+        _mm512_storeu_pd(c + r * ldc + 8, c1[r]);
+    }
+}
+
+// ============================================================================
+// REDUCED PRECISION
+// f32 kernels mirror the f64 ones at twice the lanes. bf16 widens to f32 by
+// a 16-bit shift. int8 sign-extends to int16 and uses madd_epi16 (pairwise
+// products summed into int32); AVX-512F alone has no 16-bit multiply, so
+// the AVX-512 table reuses the AVX2 int8 dot.
+// ============================================================================
+static const size_t GEMM_F32_AVX2_MR = 6;       // 12 ymm accumulators
+static const size_t GEMM_F32_AVX2_NR = 16;
+static const size_t GEMM_F32_AVX512_MR = 12;    // 24 zmm accumulators
+static const size_t GEMM_F32_AVX512_NR = 32;    // One 32 x f32 strip
+
+#define AGNI_AVX2_BINARY_F32(name, vop, sop)                                    \
+AGNI_TARGET_AVX2                                                                \
+static void name(float* dst, const float* src1, const float* src2, size_t len) { \
+    size_t i = 0;                                                               \
+    for (; i + 32 <= len; i += 32) {                                            \
+        __m256 v0 = vop(_mm256_loadu_ps(src1 + i),      _mm256_loadu_ps(src2 + i));      \
+        __m256 v1 = vop(_mm256_loadu_ps(src1 + i + 8),  _mm256_loadu_ps(src2 + i + 8));  \
+        __m256 v2 = vop(_mm256_loadu_ps(src1 + i + 16), _mm256_loadu_ps(src2 + i + 16)); \
+        __m256 v3 = vop(_mm256_loadu_ps(src1 + i + 24), _mm256_loadu_ps(src2 + i + 24)); \
+        _mm256_storeu_ps(dst + i, v0);                                          \
+        _mm256_storeu_ps(dst + i + 8, v1);                                      \
+        _mm256_storeu_ps(dst + i + 16, v2);                                     \
+        _mm256_storeu_ps(dst + i + 24, v3);                                     \
+    }                                                                           \
+    for (; i + 8 <= len; i += 8) {                                              \
+        _mm256_storeu_ps(dst + i, vop(_mm256_loadu_ps(src1 + i), _mm256_loadu_ps(src2 + i))); \
+    }                                                                           \
+    for (; i < len; ++i) dst[i] = src1[i] sop src2[i];                          \
+}
+
+AGNI_AVX2_BINARY_F32(add_f32_avx2, _mm256_add_ps, +)
+AGNI_AVX2_BINARY_F32(mul_f32_avx2, _mm256_mul_ps, *)
+
+AGNI_TARGET_AVX2
+static inline float hsum_avx2_ps(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehdup_ps(s)));
+}
+
+AGNI_TARGET_AVX2
+static float dot_f32_avx2(const float* src1, const float* src2, size_t len) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(src1 + i),      _mm256_loadu_ps(src2 + i),      acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(src1 + i + 8),  _mm256_loadu_ps(src2 + i + 8),  acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(src1 + i + 16), _mm256_loadu_ps(src2 + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(src1 + i + 24), _mm256_loadu_ps(src2 + i + 24), acc3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(src1 + i), _mm256_loadu_ps(src2 + i), acc0);
+    }
+    float result = hsum_avx2_ps(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    for (; i < len; ++i) result += src1[i] * src2[i];
+    return result;
+}
+
+AGNI_TARGET_AVX2
+static void relu_f32_avx2(float* dst, const float* src, size_t len) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256 r0 = _mm256_max_ps(_mm256_loadu_ps(src + i),      zero);
+        __m256 r1 = _mm256_max_ps(_mm256_loadu_ps(src + i + 8),  zero);
+        __m256 r2 = _mm256_max_ps(_mm256_loadu_ps(src + i + 16), zero);
+        __m256 r3 = _mm256_max_ps(_mm256_loadu_ps(src + i + 24), zero);
+        _mm256_storeu_ps(dst + i, r0);
+        _mm256_storeu_ps(dst + i + 8, r1);
+        _mm256_storeu_ps(dst + i + 16, r2);
+        _mm256_storeu_ps(dst + i + 24, r3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_max_ps(_mm256_loadu_ps(src + i), zero));
+    }
+    for (; i < len; ++i) dst[i] = (src[i] > 0.0f) ? src[i] : 0.0f;
+}
+
+AGNI_TARGET_AVX2
+static inline __m256 bf16x8_avx2(const uint16_t* p) {
+    __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(w, 16));
+}
+
+static inline float bf16_scalar(uint16_t v) {
+    uint32_t bits = (uint32_t)v << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+AGNI_TARGET_AVX2
+static float dot_bf16_avx2(const uint16_t* src1, const uint16_t* src2, size_t len) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        acc0 = _mm256_fmadd_ps(bf16x8_avx2(src1 + i),      bf16x8_avx2(src2 + i),      acc0);
+        acc1 = _mm256_fmadd_ps(bf16x8_avx2(src1 + i + 8),  bf16x8_avx2(src2 + i + 8),  acc1);
+        acc2 = _mm256_fmadd_ps(bf16x8_avx2(src1 + i + 16), bf16x8_avx2(src2 + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(bf16x8_avx2(src1 + i + 24), bf16x8_avx2(src2 + i + 24), acc3);
+    }
+    for (; i + 8 <= len; i += 8) {
+        acc0 = _mm256_fmadd_ps(bf16x8_avx2(src1 + i), bf16x8_avx2(src2 + i), acc0);
+    }
+    float result = hsum_avx2_ps(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    for (; i < len; ++i) result += bf16_scalar(src1[i]) * bf16_scalar(src2[i]);
+    return result;
+}
+
+AGNI_TARGET_AVX2
+static inline __m256i madd_i8x16_avx2(const int8_t* a, const int8_t* b) {
+    __m256i wa = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)a));
+    __m256i wb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)b));
+    return _mm256_madd_epi16(wa, wb);
+}
+
+AGNI_TARGET_AVX2
+static int32_t dot_i8_avx2(const int8_t* src1, const int8_t* src2, size_t len) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        acc0 = _mm256_add_epi32(acc0, madd_i8x16_avx2(src1 + i, src2 + i));
+        acc1 = _mm256_add_epi32(acc1, madd_i8x16_avx2(src1 + i + 16, src2 + i + 16));
+    }
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm256_add_epi32(acc0, madd_i8x16_avx2(src1 + i, src2 + i));
+    }
+    __m256i acc = _mm256_add_epi32(acc0, acc1);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    int32_t result = _mm_cvtsi128_si32(s);
+    for (; i < len; ++i) result += (int32_t)src1[i] * (int32_t)src2[i];
+    return result;
+}
+
+AGNI_TARGET_AVX2
+static void gemm_micro_f32_avx2(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) {
+    __m256 c0[GEMM_F32_AVX2_MR], c1[GEMM_F32_AVX2_MR];
+    for (size_t r = 0; r < GEMM_F32_AVX2_MR; ++r) {
+        c0[r] = accumulate ? _mm256_loadu_ps(c + r * ldc) : _mm256_setzero_ps();
+        c1[r] = accumulate ? _mm256_loadu_ps(c + r * ldc + 8) : _mm256_setzero_ps();
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        __m256 b0 = _mm256_loadu_ps(b + k * GEMM_F32_AVX2_NR);
+        __m256 b1 = _mm256_loadu_ps(b + k * GEMM_F32_AVX2_NR + 8);
+        const float* ak = a + k * GEMM_F32_AVX2_MR;
+        for (size_t r = 0; r < GEMM_F32_AVX2_MR; ++r) {
+            __m256 ar = _mm256_broadcast_ss(ak + r);
+            c0[r] = _mm256_fmadd_ps(ar, b0, c0[r]);
+            c1[r] = _mm256_fmadd_ps(ar, b1, c1[r]);
+        }
+    }
+    for (size_t r = 0; r < GEMM_F32_AVX2_MR; ++r) {
+        _mm256_storeu_ps(c + r * ldc, c0[r]);
+        _mm256_storeu_ps(c + r * ldc + 8, c1[r]);
+    }
+}
+
+AGNI_AVX512_DIAGNOSTICS_BEGIN
+
+AGNI_TARGET_AVX512
+static inline __mmask16 tail_mask16(size_t remaining) {
+    return (__mmask16)((1u << remaining) - 1u);
+}
+
+#define AGNI_AVX512_BINARY_F32(name, vop)                                       \
+AGNI_TARGET_AVX512                                                              \
+static void name(float* dst, const float* src1, const float* src2, size_t len) { \
+    size_t i = 0;                                                               \
+    for (; i + 64 <= len; i += 64) {                                            \
+        __m512 v0 = vop(_mm512_loadu_ps(src1 + i),      _mm512_loadu_ps(src2 + i));      \
+        __m512 v1 = vop(_mm512_loadu_ps(src1 + i + 16), _mm512_loadu_ps(src2 + i + 16)); \
+        __m512 v2 = vop(_mm512_loadu_ps(src1 + i + 32), _mm512_loadu_ps(src2 + i + 32)); \
+        __m512 v3 = vop(_mm512_loadu_ps(src1 + i + 48), _mm512_loadu_ps(src2 + i + 48)); \
+        _mm512_storeu_ps(dst + i, v0);                                          \
+        _mm512_storeu_ps(dst + i + 16, v1);                                     \
+        _mm512_storeu_ps(dst + i + 32, v2);                                     \
+        _mm512_storeu_ps(dst + i + 48, v3);                                     \
+    }                                                                           \
+    for (; i + 16 <= len; i += 16) {                                            \
+        _mm512_storeu_ps(dst + i, vop(_mm512_loadu_ps(src1 + i), _mm512_loadu_ps(src2 + i))); \
+    }                                                                           \
+    if (i < len) {                                                              \
+        __mmask16 m = tail_mask16(len - i);                                     \
+        _mm512_mask_storeu_ps(dst + i, m, vop(_mm512_maskz_loadu_ps(m, src1 + i), \
+                                              _mm512_maskz_loadu_ps(m, src2 + i))); \
+    }                                                                           \
+}
+
+AGNI_AVX512_BINARY_F32(add_f32_avx512, _mm512_add_ps)
+AGNI_AVX512_BINARY_F32(mul_f32_avx512, _mm512_mul_ps)
+
+AGNI_TARGET_AVX512
+static float dot_f32_avx512(const float* src1, const float* src2, size_t len) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(src1 + i),      _mm512_loadu_ps(src2 + i),      acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(src1 + i + 16), _mm512_loadu_ps(src2 + i + 16), acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(src1 + i + 32), _mm512_loadu_ps(src2 + i + 32), acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(src1 + i + 48), _mm512_loadu_ps(src2 + i + 48), acc3);
+    }
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(src1 + i), _mm512_loadu_ps(src2 + i), acc0);
+    }
+    if (i < len) {
+        __mmask16 m = tail_mask16(len - i);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, src1 + i), _mm512_maskz_loadu_ps(m, src2 + i), acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+}
+
+AGNI_TARGET_AVX512
+static void relu_f32_avx512(float* dst, const float* src, size_t len) {
+    const __m512 zero = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512 r0 = _mm512_max_ps(_mm512_loadu_ps(src + i),      zero);
+        __m512 r1 = _mm512_max_ps(_mm512_loadu_ps(src + i + 16), zero);
+        __m512 r2 = _mm512_max_ps(_mm512_loadu_ps(src + i + 32), zero);
+        __m512 r3 = _mm512_max_ps(_mm512_loadu_ps(src + i + 48), zero);
+        _mm512_storeu_ps(dst + i, r0);
+        _mm512_storeu_ps(dst + i + 16, r1);
+        _mm512_storeu_ps(dst + i + 32, r2);
+        _mm512_storeu_ps(dst + i + 48, r3);
+    }
+    for (; i + 16 <= len; i += 16) {
+        _mm512_storeu_ps(dst + i, _mm512_max_ps(_mm512_loadu_ps(src + i), zero));
+    }
+    if (i < len) {
+        __mmask16 m = tail_mask16(len - i);
+        _mm512_mask_storeu_ps(dst + i, m, _mm512_max_ps(_mm512_maskz_loadu_ps(m, src + i), zero));
+    }
+}
+
+AGNI_TARGET_AVX512
+static inline __m512 bf16x16_avx512(const uint16_t* p) {
+    __m512i w = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)p));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(w, 16));
+}
+
+// The tail is zero-padded on the stack: 16-bit masked loads need AVX-512BW
+AGNI_TARGET_AVX512
+static float dot_bf16_avx512(const uint16_t* src1, const uint16_t* src2, size_t len) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        acc0 = _mm512_fmadd_ps(bf16x16_avx512(src1 + i),      bf16x16_avx512(src2 + i),      acc0);
+        acc1 = _mm512_fmadd_ps(bf16x16_avx512(src1 + i + 16), bf16x16_avx512(src2 + i + 16), acc1);
+        acc2 = _mm512_fmadd_ps(bf16x16_avx512(src1 + i + 32), bf16x16_avx512(src2 + i + 32), acc2);
+        acc3 = _mm512_fmadd_ps(bf16x16_avx512(src1 + i + 48), bf16x16_avx512(src2 + i + 48), acc3);
+    }
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm512_fmadd_ps(bf16x16_avx512(src1 + i), bf16x16_avx512(src2 + i), acc0);
+    }
+    if (i < len) {
+        uint16_t a[16] = {0}, b[16] = {0};
+        memcpy(a, src1 + i, (len - i) * sizeof(uint16_t));
+        memcpy(b, src2 + i, (len - i) * sizeof(uint16_t));
+        acc1 = _mm512_fmadd_ps(bf16x16_avx512(a), bf16x16_avx512(b), acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+}
+
+AGNI_AVX512_DIAGNOSTICS_END
+
+AGNI_TARGET_AVX512
+static void gemm_micro_f32_avx512(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) {
+    __m512 c0[GEMM_F32_AVX512_MR], c1[GEMM_F32_AVX512_MR];
+    for (size_t r = 0; r < GEMM_F32_AVX512_MR; ++r) {
+        c0[r] = accumulate ? _mm512_loadu_ps(c + r * ldc) : _mm512_setzero_ps();
+        c1[r] = accumulate ? _mm512_loadu_ps(c + r * ldc + 16) : _mm512_setzero_ps();
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        __m512 b0 = _mm512_loadu_ps(b + k * GEMM_F32_AVX512_NR);
+        __m512 b1 = _mm512_loadu_ps(b + k * GEMM_F32_AVX512_NR + 16);
+        const float* ak = a + k * GEMM_F32_AVX512_MR;
+        for (size_t r = 0; r < GEMM_F32_AVX512_MR; ++r) {
+            __m512 ar = _mm512_set1_ps(ak[r]);
+            c0[r] = _mm512_fmadd_ps(ar, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(ar, b1, c1[r]);
+        }
+    }
+    for (size_t r = 0; r < GEMM_F32_AVX512_MR; ++r) {
+        _mm512_storeu_ps(c + r * ldc, c0[r]);
+        _mm512_storeu_ps(c + r * ldc + 16, c1[r]);
+    }
+}
+
+// ============================================================================
+// SELECTIVE SCAN
+// Same fma order as ssm_update_scalar. The channel loop is unrolled only
+// two vectors deep: a row is one hidden dimension and already in L1.
+// ============================================================================
+AGNI_TARGET_AVX2
+static void ssm_update_avx2(double* h, const double* decay, const double* x, double b, double c,
+                            double* y, size_t len) {
+    const __m256d vb = _mm256_set1_pd(b);
+    const __m256d vc = _mm256_set1_pd(c);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256d h0 = _mm256_fmadd_pd(_mm256_loadu_pd(decay + i), _mm256_loadu_pd(h + i),
+                                     _mm256_mul_pd(vb, _mm256_loadu_pd(x + i)));
+        __m256d h1 = _mm256_fmadd_pd(_mm256_loadu_pd(decay + i + 4), _mm256_loadu_pd(h + i + 4),
+                                     _mm256_mul_pd(vb, _mm256_loadu_pd(x + i + 4)));
+        _mm256_storeu_pd(h + i, h0);
+        _mm256_storeu_pd(h + i + 4, h1);
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(vc, h0, _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(vc, h1, _mm256_loadu_pd(y + i + 4)));
+    }
+    for (; i < len; ++i) {
+        h[i] = fma(decay[i], h[i], b * x[i]);
+        y[i] = fma(c, h[i], y[i]);
+    }
+}
+
+AGNI_TARGET_AVX512
+static void ssm_update_avx512(double* h, const double* decay, const double* x, double b, double c,
+                              double* y, size_t len) {
+    const __m512d vb = _mm512_set1_pd(b);
+    const __m512d vc = _mm512_set1_pd(c);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m512d h0 = _mm512_fmadd_pd(_mm512_loadu_pd(decay + i), _mm512_loadu_pd(h + i),
+                                     _mm512_mul_pd(vb, _mm512_loadu_pd(x + i)));
+        __m512d h1 = _mm512_fmadd_pd(_mm512_loadu_pd(decay + i + 8), _mm512_loadu_pd(h + i + 8),
+                                     _mm512_mul_pd(vb, _mm512_loadu_pd(x + i + 8)));
+        _mm512_storeu_pd(h + i, h0);
+        _mm512_storeu_pd(h + i + 8, h1);
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(vc, h0, _mm512_loadu_pd(y + i)));
+        _mm512_storeu_pd(y + i + 8, _mm512_fmadd_pd(vc, h1, _mm512_loadu_pd(y + i + 8)));
+    }
+    for (; i < len; i += 8) {
+        __mmask8 m = (len - i >= 8) ? (__mmask8)0xff : tail_mask(len - i);
+        __m512d hv = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, decay + i), _mm512_maskz_loadu_pd(m, h + i),
+                                     _mm512_mul_pd(vb, _mm512_maskz_loadu_pd(m, x + i)));
+        _mm512_mask_storeu_pd(h + i, m, hv);
+        _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(vc, hv, _mm512_maskz_loadu_pd(m, y + i)));
+    }
+}
+
+// ============================================================================
+// TABLES
+// ============================================================================
+static const VectorKernels AVX2_KERNELS = {
+    add_avx2, mul_avx2, add_avx2, mul_avx2, dot_avx2, dot_lanes16_avx2, relu_avx2, affine_avx2,
+    exp_avx2, tanh_avx2, gelu_avx2,
+    softmax_stats_avx2, softmax_exp_blocks_avx2,
+    gemm_micro_avx2, GEMM_AVX2_MR, GEMM_AVX2_NR,
+    add_f32_avx2, mul_f32_avx2, dot_f32_avx2, relu_f32_avx2, dot_bf16_avx2, dot_i8_avx2,
+    gemm_micro_f32_avx2, GEMM_F32_AVX2_MR, GEMM_F32_AVX2_NR,
+    ssm_update_avx2
+};
+static const VectorKernels AVX512_KERNELS = {
+    add_avx512, mul_avx512, add_avx512, mul_avx512, dot_avx512, dot_lanes16_avx512, relu_avx512, affine_avx512,
+    exp_avx512, tanh_avx512, gelu_avx512,
+    softmax_stats_avx512, softmax_exp_blocks_avx512,
+    gemm_micro_avx512, GEMM_AVX512_MR, GEMM_AVX512_NR,
+    add_f32_avx512, mul_f32_avx512, dot_f32_avx512, relu_f32_avx512, dot_bf16_avx512, dot_i8_avx2,
+    gemm_micro_f32_avx512, GEMM_F32_AVX512_MR, GEMM_F32_AVX512_NR,
+    ssm_update_avx512
+};
+
+const VectorKernels* vector_kernels_avx2() { return &AVX2_KERNELS; }
+const VectorKernels* vector_kernels_avx512() { return &AVX512_KERNELS; }
+
+#else
+
+const VectorKernels* vector_kernels_avx2() { return nullptr; }
+const VectorKernels* vector_kernels_avx512() { return nullptr; }
+
+#endif
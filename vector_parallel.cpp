@@ -0,0 +1,145 @@
+#include "vector_utils.h"
+#include "vector_kernels.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// SHARED VECTOR THREAD POOL
+// Workers sleep on a condition variable between calls. A call publishes one
+// job; workers and the caller claim chunk indices from an atomic counter
+// until none are left. Only one job runs at a time: a caller that finds
+// the pool busy runs its chunks itself, which gives the same result.
+// ============================================================================
+namespace {
+
+struct PoolJob {
+    const std::function<void(size_t)>* task;
+    size_t count;
+    std::atomic<size_t> next;
+    std::atomic<size_t> done;
+};
+
+class VectorPool {
+public:
+    VectorPool() : job_(NULL), generation_(0), active_(0), stop_(false) {}
+    ~VectorPool() { resize(0); }
+
+    // Worker count, excluding the calling thread
+    void resize(size_t workers) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (size_t i = 0; i < threads_.size(); i++) threads_[i].join();
+        threads_.clear();
+        stop_ = false;
+        for (size_t i = 0; i < workers; i++) threads_.push_back(std::thread(&VectorPool::worker_loop, this));
+    }
+
+    void run(size_t count, const std::function<void(size_t)>& task) {
+        std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+        if (!run_lock.owns_lock() || threads_.empty()) {
+            for (size_t c = 0; c < count; c++) task(c);
+            return;
+        }
+
+        PoolJob job;
+        job.task = &task;
+        job.count = count;
+        job.next.store(0, std::memory_order_relaxed);
+        job.done.store(0, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            generation_++;
+        }
+        wake_.notify_all();
+        work_on(&job);
+
+        // The job lives on this stack: wait for the last chunk and for every
+        // worker that picked it up to let go, then retract it
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [&]() { return job.done.load(std::memory_order_acquire) == count && active_ == 0; });
+        job_ = NULL;
+    }
+
+private:
+    void work_on(PoolJob* job) {
+        size_t c;
+        while ((c = job->next.fetch_add(1, std::memory_order_relaxed)) < job->count) {
+            (*job->task)(c);
+            if (job->done.fetch_add(1, std::memory_order_acq_rel) + 1 == job->count) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                finished_.notify_all();
+            }
+        }
+    }
+
+    void worker_loop() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&]() { return stop_ || (generation_ != seen && job_); });
+            if (stop_) return;
+            seen = generation_;
+            PoolJob* job = job_;
+            active_++;
+            lock.unlock();
+            work_on(job);
+            lock.lock();
+            if (--active_ == 0) finished_.notify_all();
+        }
+    }
+
+    std::mutex run_mutex_;          // One job at a time; held across resize
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable finished_;
+    std::vector<std::thread> threads_;
+    PoolJob* job_;
+    uint64_t generation_;
+    size_t active_;
+    bool stop_;
+};
+
+VectorPool& vector_pool() {
+    static VectorPool pool;
+    return pool;
+}
+
+} // namespace
+
+// ============================================================================
+// SIMD PARALLEL MODE
+// ============================================================================
+static std::atomic<size_t> g_parallel_threads(1);
+static std::atomic<size_t> g_parallel_min_len(SIMD_PARALLEL_MIN_LEN);
+static std::mutex g_parallel_mutex;
+
+void simd_set_parallel(size_t threads, size_t min_len) {
+    if (threads == 0) threads = MAX((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    std::lock_guard<std::mutex> lock(g_parallel_mutex);
+    vector_pool().resize(threads - 1);
+    g_parallel_min_len.store(min_len ? min_len : SIMD_PARALLEL_MIN_LEN, std::memory_order_relaxed);
+    g_parallel_threads.store(threads, std::memory_order_release);
+}
+
+size_t simd_get_parallel_threads() {
+    return g_parallel_threads.load(std::memory_order_acquire);
+}
+
+size_t vector_parallel_chunks(size_t len) {
+    if (g_parallel_threads.load(std::memory_order_acquire) <= 1) return 0;
+    if (len < g_parallel_min_len.load(std::memory_order_relaxed)) return 0;
+    return (len + SIMD_PARALLEL_CHUNK - 1) / SIMD_PARALLEL_CHUNK;
+}
+
+void vector_parallel_run(size_t count, const std::function<void(size_t)>& task) {
+    vector_pool().run(count, task);
+}
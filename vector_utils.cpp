@@ -1,27 +1,399 @@
 #include "vector_utils.h"
+#include "vector_kernels.h"
+#include <float.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 // ============================================================================
-// SIMD VECTOR ADDITION
+// SCALAR KERNELS (portable fallback)
 // ============================================================================
-void simd_add_f64(double* dst, const double* src1, const double* src2, size_t len) {
-    if (!dst || !src1 || !src2) return;
+static void add_scalar(double* dst, const double* src1, const double* src2, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src1[i] + src2[i];
+    }
+}
+
+static void mul_scalar(double* dst, const double* src1, const double* src2, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src1[i] * src2[i];
+    }
+}
 
+// Without the overlap check the compiler emits when dst may alias a source
+static void add_noalias_scalar(double* __restrict dst, const double* __restrict src1,
+                               const double* __restrict src2, size_t len) {
     for (size_t i = 0; i < len; i++) {
         dst[i] = src1[i] + src2[i];
     }
 }
 
+static void mul_noalias_scalar(double* __restrict dst, const double* __restrict src1,
+                               const double* __restrict src2, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src1[i] * src2[i];
+    }
+}
+
+// Four partial sums break the serial dependency on a single accumulator
+static double dot_scalar(const double* src1, const double* src2, size_t len) {
+    double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        acc0 += src1[i] * src2[i];
+        acc1 += src1[i + 1] * src2[i + 1];
+        acc2 += src1[i + 2] * src2[i + 2];
+        acc3 += src1[i + 3] * src2[i + 3];
+    }
+    for (; i < len; i++) {
+        acc0 += src1[i] * src2[i];
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+// Lane l accumulates elements l, l + 16, ... with fused multiply-add, then
+// lanes are folded pairwise: l + 8, l + 4, l + 2, l + 1
+static double dot_lanes16_scalar(const double* src1, const double* src2, size_t len) {
+    double acc[16] = {0.0};
+    for (size_t i = 0; i < len; i++) {
+        acc[i % 16] = fma(src1[i], src2[i], acc[i % 16]);
+    }
+    for (size_t width = 8; width >= 1; width /= 2) {
+        for (size_t l = 0; l < width; l++) {
+            acc[l] += acc[l + width];
+        }
+    }
+    return acc[0];
+}
+
+static void relu_scalar(double* dst, const double* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (src[i] > 0.0) ? src[i] : 0.0;
+    }
+}
+
+static void affine_scalar(double* dst, const double* src, double scale, double shift, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = fma(src[i], scale, shift);
+    }
+}
+
+static void exp_scalar(double* dst, const double* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = exp(src[i]);
+    }
+}
+
+static void tanh_scalar(double* dst, const double* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = tanh(src[i]);
+    }
+}
+
+// 0.5 * x * (1 + tanh(u)) == x / (1 + exp(-2u)); the second form does not
+// cancel for negative x and needs no clamp, since exp() saturates cleanly
+static void gelu_scalar(double* dst, const double* src, size_t len) {
+    const double sqrt_2_pi = 0.7978845608028654;  // sqrt(2/pi)
+    const double coeff = 0.044715;
+
+    for (size_t i = 0; i < len; i++) {
+        double x = src[i];
+        double u = sqrt_2_pi * (x + coeff * (x * x * x));
+        dst[i] = x / (1.0 + exp(-2.0 * u));
+    }
+}
+
+// Running max with the sum rescaled whenever the max moves; one exp per
+// element except on a new maximum
+static void softmax_stats_scalar(const double* src, size_t len, double scale, double* max, double* sum) {
+    double m = -DBL_MAX;
+    double s = 0.0;
+    for (size_t i = 0; i < len; i++) {
+        double x = src[i];
+        if (x > m) {
+            s = s * exp(scale * (m - x)) + 1.0;
+            m = x;
+        } else {
+            s += exp(scale * (x - m));
+        }
+    }
+    *max = m;
+    *sum = s;
+}
+
+static void softmax_exp_blocks_scalar(double* vec, size_t len, double scale, double* block_max,
+                                      double* max, double* sum) {
+    double m = -DBL_MAX;
+    double s = 0.0;
+    for (size_t base = 0, b = 0; base < len; base += VECTOR_SOFTMAX_BLOCK, b++) {
+        size_t end = std::min(base + VECTOR_SOFTMAX_BLOCK, len);
+        double bm = vec[base];
+        for (size_t i = base + 1; i < end; i++) {
+            if (vec[i] > bm) bm = vec[i];
+        }
+        if (bm > m) {
+            s *= exp(scale * (m - bm));
+            m = bm;
+        }
+        block_max[b] = m;
+        for (size_t i = base; i < end; i++) {
+            vec[i] = exp(scale * (vec[i] - m));
+            s += vec[i];
+        }
+    }
+    *max = m;
+    *sum = s;
+}
+
+static const size_t GEMM_SCALAR_MR = 4;
+static const size_t GEMM_SCALAR_NR = 4;
+
+static void gemm_micro_scalar(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate) {
+    double acc[GEMM_SCALAR_MR][GEMM_SCALAR_NR];
+    for (size_t r = 0; r < GEMM_SCALAR_MR; r++) {
+        for (size_t j = 0; j < GEMM_SCALAR_NR; j++) {
+            acc[r][j] = accumulate ? c[r * ldc + j] : 0.0;
+        }
+    }
+    for (size_t k = 0; k < kc; k++) {
+        const double* ak = a + k * GEMM_SCALAR_MR;
+        const double* bk = b + k * GEMM_SCALAR_NR;
+        for (size_t r = 0; r < GEMM_SCALAR_MR; r++) {
+            for (size_t j = 0; j < GEMM_SCALAR_NR; j++) {
+                acc[r][j] = fma(ak[r], bk[j], acc[r][j]);
+            }
+        }
+    }
+    for (size_t r = 0; r < GEMM_SCALAR_MR; r++) {
+        for (size_t j = 0; j < GEMM_SCALAR_NR; j++) {
+            c[r * ldc + j] = acc[r][j];
+        }
+    }
+}
+
+static void add_f32_scalar(float* dst, const float* src1, const float* src2, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src1[i] + src2[i];
+    }
+}
+
+static void mul_f32_scalar(float* dst, const float* src1, const float* src2, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src1[i] * src2[i];
+    }
+}
+
+static float dot_f32_scalar(const float* src1, const float* src2, size_t len) {
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        acc0 += src1[i] * src2[i];
+        acc1 += src1[i + 1] * src2[i + 1];
+        acc2 += src1[i + 2] * src2[i + 2];
+        acc3 += src1[i + 3] * src2[i + 3];
+    }
+    for (; i < len; i++) {
+        acc0 += src1[i] * src2[i];
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+static void relu_f32_scalar(float* dst, const float* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (src[i] > 0.0f) ? src[i] : 0.0f;
+    }
+}
+
+static float dot_bf16_scalar(const uint16_t* src1, const uint16_t* src2, size_t len) {
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        acc0 += bf16_to_f32(src1[i]) * bf16_to_f32(src2[i]);
+        acc1 += bf16_to_f32(src1[i + 1]) * bf16_to_f32(src2[i + 1]);
+        acc2 += bf16_to_f32(src1[i + 2]) * bf16_to_f32(src2[i + 2]);
+        acc3 += bf16_to_f32(src1[i + 3]) * bf16_to_f32(src2[i + 3]);
+    }
+    for (; i < len; i++) {
+        acc0 += bf16_to_f32(src1[i]) * bf16_to_f32(src2[i]);
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+static int32_t dot_i8_scalar(const int8_t* src1, const int8_t* src2, size_t len) {
+    int32_t acc = 0;
+    for (size_t i = 0; i < len; i++) {
+        acc += (int32_t)src1[i] * (int32_t)src2[i];
+    }
+    return acc;
+}
+
+static void gemm_micro_f32_scalar(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) {
+    float acc[GEMM_SCALAR_MR][GEMM_SCALAR_NR];
+    for (size_t r = 0; r < GEMM_SCALAR_MR; r++) {
+        for (size_t j = 0; j < GEMM_SCALAR_NR; j++) {
+            acc[r][j] = accumulate ? c[r * ldc + j] : 0.0f;
+        }
+    }
+    for (size_t k = 0; k < kc; k++) {
+        const float* ak = a + k * GEMM_SCALAR_MR;
+        const float* bk = b + k * GEMM_SCALAR_NR;
+        for (size_t r = 0; r < GEMM_SCALAR_MR; r++) {
+            for (size_t j = 0; j < GEMM_SCALAR_NR; j++) {
+                acc[r][j] = fmaf(ak[r], bk[j], acc[r][j]);
+            }
+        }
+    }
+    for (size_t r = 0; r < GEMM_SCALAR_MR; r++) {
+        for (size_t j = 0; j < GEMM_SCALAR_NR; j++) {
+            c[r * ldc + j] = acc[r][j];
+        }
+    }
+}
+
+static void ssm_update_scalar(double* h, const double* decay, const double* x, double b, double c,
+                              double* y, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h[i] = fma(decay[i], h[i], b * x[i]);
+        y[i] = fma(c, h[i], y[i]);
+    }
+}
+
+static const VectorKernels SCALAR_KERNELS = {
+    add_scalar, mul_scalar, add_noalias_scalar, mul_noalias_scalar, dot_scalar, dot_lanes16_scalar, relu_scalar, affine_scalar,
+    exp_scalar, tanh_scalar, gelu_scalar,
+    softmax_stats_scalar, softmax_exp_blocks_scalar,
+    gemm_micro_scalar, GEMM_SCALAR_MR, GEMM_SCALAR_NR,
+    add_f32_scalar, mul_f32_scalar, dot_f32_scalar, relu_f32_scalar, dot_bf16_scalar, dot_i8_scalar,
+    gemm_micro_f32_scalar, GEMM_SCALAR_MR, GEMM_SCALAR_NR,
+    ssm_update_scalar
+};
+
+// ============================================================================
+// SIMD DISPATCH
+// ============================================================================
+static std::atomic<const VectorKernels*> g_kernels(nullptr);
+static std::atomic<int> g_level(SIMD_LEVEL_SCALAR);
+
+static const VectorKernels* kernels_for(SimdLevel level) {
+    const VectorKernels* k = nullptr;
+    if (level == SIMD_LEVEL_AVX512) k = vector_kernels_avx512();
+    else if (level == SIMD_LEVEL_AVX2) k = vector_kernels_avx2();
+    return k ? k : &SCALAR_KERNELS;
+}
+
+SimdLevel simd_detect_level() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (vector_kernels_avx512() && __builtin_cpu_supports("avx512f")) return SIMD_LEVEL_AVX512;
+    if (vector_kernels_avx2() && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SIMD_LEVEL_AVX2;
+    }
+#endif
+    return SIMD_LEVEL_SCALAR;
+}
+
+SimdLevel simd_set_level(SimdLevel level) {
+    SimdLevel best = simd_detect_level();
+    if (level > best) level = best;
+    if (level < SIMD_LEVEL_SCALAR) level = SIMD_LEVEL_SCALAR;
+    g_level.store(level, std::memory_order_relaxed);
+    g_kernels.store(kernels_for(level), std::memory_order_release);
+    return level;
+}
+
+static inline const VectorKernels* active_kernels() {
+    const VectorKernels* k = g_kernels.load(std::memory_order_acquire);
+    if (!k) {
+        // First call: racing initializers all store the same table
+        simd_set_level(simd_detect_level());
+        k = g_kernels.load(std::memory_order_acquire);
+    }
+    return k;
+}
+
+const VectorKernels* vector_kernels_active() {
+    return active_kernels();
+}
+
+SimdLevel simd_get_level() {
+    active_kernels();
+    return (SimdLevel)g_level.load(std::memory_order_relaxed);
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SIMD_LEVEL_AVX512: return "avx512";
+        case SIMD_LEVEL_AVX2:   return "avx2";
+        default:                return "scalar";
+    }
+}
+
+// ============================================================================
+// PARALLEL MODE HELPERS
+// Chunk c always covers [c * SIMD_PARALLEL_CHUNK, (c + 1) * SIMD_PARALLEL_CHUNK),
+// whatever the thread count, and partials are merged in chunk order.
+// ============================================================================
+// map(begin, n) over the whole range: once when serial, per chunk otherwise
+template <typename Map>
+static void map_chunks(size_t len, Map map) {
+    size_t chunks = vector_parallel_chunks(len);
+    if (chunks == 0) {
+        map((size_t)0, len);
+        return;
+    }
+    vector_parallel_run(chunks, [&](size_t c) {
+        size_t begin = c * SIMD_PARALLEL_CHUNK;
+        map(begin, std::min((size_t)SIMD_PARALLEL_CHUNK, len - begin));
+    });
+}
+
+// Folds per-chunk (max, sum) softmax statistics into the totals
+static void merge_softmax_stats(const std::vector<double>& chunk_max, const std::vector<double>& chunk_sum,
+                                double scale, double* max, double* sum) {
+    double m = -DBL_MAX;
+    for (size_t c = 0; c < chunk_max.size(); c++) m = std::max(m, chunk_max[c]);
+    double s = 0.0;
+    for (size_t c = 0; c < chunk_max.size(); c++) s += chunk_sum[c] * exp(scale * (chunk_max[c] - m));
+    *max = m;
+    *sum = s;
+}
+
+static void softmax_stats_chunked(const VectorKernels* kern, const double* src, size_t len, double scale,
+                                  double* max, double* sum) {
+    size_t chunks = vector_parallel_chunks(len);
+    if (chunks == 0) {
+        kern->softmax_stats(src, len, scale, max, sum);
+        return;
+    }
+    std::vector<double> chunk_max(chunks), chunk_sum(chunks);
+    vector_parallel_run(chunks, [&](size_t c) {
+        size_t begin = c * SIMD_PARALLEL_CHUNK;
+        kern->softmax_stats(src + begin, std::min((size_t)SIMD_PARALLEL_CHUNK, len - begin), scale,
+                            &chunk_max[c], &chunk_sum[c]);
+    });
+    merge_softmax_stats(chunk_max, chunk_sum, scale, max, sum);
+}
+
+// ============================================================================
+// SIMD VECTOR ADDITION
+// ============================================================================
+void simd_add_f64(double* dst, const double* src1, const double* src2, size_t len) {
+    if (!dst || !src1 || !src2) return;
+
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->add(dst + begin, src1 + begin, src2 + begin, n); });
+}
+
 // ============================================================================
 // SIMD VECTOR MULTIPLICATION
 // ============================================================================
 void simd_mul_f64(double* dst, const double* src1, const double* src2, size_t len) {
     if (!dst || !src1 || !src2) return;
 
-    for (size_t i = 0; i < len; i++) {
-        dst[i] = src1[i] * src2[i];
-    }
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->mul(dst + begin, src1 + begin, src2 + begin, n); });
 }
 
 // ============================================================================
@@ -30,42 +402,386 @@ void simd_mul_f64(double* dst, const double* src1, const double* src2, size_t le
 double simd_dot_f64(const double* src1, const double* src2, size_t len) {
     if (!src1 || !src2) return 0.0;
 
-    double result = 0.0;
-    for (size_t i = 0; i < len; i++) {
-        result += src1[i] * src2[i];
-    }
-    return result;
+    const VectorKernels* kern = active_kernels();
+    size_t chunks = vector_parallel_chunks(len);
+    if (chunks == 0) return kern->dot(src1, src2, len);
+
+    std::vector<double> partial(chunks);
+    vector_parallel_run(chunks, [&](size_t c) {
+        size_t begin = c * SIMD_PARALLEL_CHUNK;
+        partial[c] = kern->dot(src1 + begin, src2 + begin, std::min((size_t)SIMD_PARALLEL_CHUNK, len - begin));
+    });
+    double sum = 0.0;
+    for (size_t c = 0; c < chunks; c++) sum += partial[c];
+    return sum;
 }
 
 // ============================================================================
-// SIMD SOFTMAX (Numerically stable via log-sum-exp trick)
+// NO-ALIAS, IN-PLACE AND UNCHECKED VARIANTS
 // ============================================================================
+void simd_add_f64_restrict(double* __restrict dst, const double* __restrict src1,
+                           const double* __restrict src2, size_t len) {
+    active_kernels()->add_noalias(dst, src1, src2, len);
+}
+
+void simd_mul_f64_restrict(double* __restrict dst, const double* __restrict src1,
+                           const double* __restrict src2, size_t len) {
+    active_kernels()->mul_noalias(dst, src1, src2, len);
+}
+
+void simd_add_inplace_f64(double* dst, const double* src, size_t len) {
+    if (!dst || !src) return;
+
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->add(dst + begin, dst + begin, src + begin, n); });
+}
+
+void simd_mul_inplace_f64(double* dst, const double* src, size_t len) {
+    if (!dst || !src) return;
+
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->mul(dst + begin, dst + begin, src + begin, n); });
+}
+
+void simd_add_f64_unchecked(double* dst, const double* src1, const double* src2, size_t len) {
+    active_kernels()->add(dst, src1, src2, len);
+}
+
+void simd_mul_f64_unchecked(double* dst, const double* src1, const double* src2, size_t len) {
+    active_kernels()->mul(dst, src1, src2, len);
+}
+
+double simd_dot_f64_unchecked(const double* src1, const double* src2, size_t len) {
+    return active_kernels()->dot(src1, src2, len);
+}
+
+// ============================================================================
+// SIMD DOT PRODUCT (16-lane reduction order)
+// ============================================================================
+double simd_dot_lanes16_f64(const double* src1, const double* src2, size_t len) {
+    if (!src1 || !src2) return 0.0;
+
+    return active_kernels()->dot_lanes16(src1, src2, len);
+}
+
+// ============================================================================
+// SIMD SOFTMAX (Online: one exp pass with a running max, one rescale pass)
+// ============================================================================
+// Shared by the plain and temperature variants; scale = 1 / temperature
+static void softmax_scaled(double* vec, size_t len, double scale) {
+    // Step 1: exp relative to each block's running max, and the total sum
+    // relative to the final max, in a single read of the input
+    const size_t stack_blocks = 64;
+    double stack_max[stack_blocks];
+    std::vector<double> heap_max;
+    size_t blocks = (len + VECTOR_SOFTMAX_BLOCK - 1) / VECTOR_SOFTMAX_BLOCK;
+    double* block_max = stack_max;
+    if (blocks > stack_blocks) {
+        heap_max.resize(blocks);
+        block_max = heap_max.data();
+    }
+
+    // In parallel mode each chunk keeps its own running max. Chunks are
+    // whole blocks, so their block_max entries stay aligned and step 2 is
+    // unchanged.
+    const VectorKernels* kern = active_kernels();
+    double max_val, sum;
+    size_t chunks = vector_parallel_chunks(len);
+    if (chunks == 0) {
+        kern->softmax_exp_blocks(vec, len, scale, block_max, &max_val, &sum);
+    } else {
+        std::vector<double> chunk_max(chunks), chunk_sum(chunks);
+        vector_parallel_run(chunks, [&](size_t c) {
+            size_t begin = c * SIMD_PARALLEL_CHUNK;
+            kern->softmax_exp_blocks(vec + begin, std::min((size_t)SIMD_PARALLEL_CHUNK, len - begin), scale,
+                                     block_max + begin / VECTOR_SOFTMAX_BLOCK, &chunk_max[c], &chunk_sum[c]);
+        });
+        merge_softmax_stats(chunk_max, chunk_sum, scale, &max_val, &sum);
+    }
+
+    // Step 2: Normalize, folding in each block's max correction. The running
+    // max only ever rises, so the factor is recomputed only when it changes.
+    // BUG FIX: Check for division by zero
+    if (!(sum > 1e-10)) return;
+    double inv_sum = 1.0 / sum;
+    map_chunks(len, [&](size_t begin, size_t n) {
+        double factor_max = max_val;
+        double factor = inv_sum;
+        for (size_t b = begin / VECTOR_SOFTMAX_BLOCK; b * VECTOR_SOFTMAX_BLOCK < begin + n; b++) {
+            if (block_max[b] != factor_max) {
+                factor_max = block_max[b];
+                factor = exp(scale * (factor_max - max_val)) * inv_sum;
+            }
+            size_t end = std::min((b + 1) * VECTOR_SOFTMAX_BLOCK, len);
+            for (size_t i = b * VECTOR_SOFTMAX_BLOCK; i < end; i++) {
+                vec[i] *= factor;
+            }
+        }
+    });
+}
+
 void simd_softmax_f64(double* vec, size_t len) {
     if (!vec || len == 0) return;
 
-    // BUG FIX: Check for length > 0 before accessing vec[0]
-    // Step 1: Find maximum for numerical stability
-    double max_val = vec[0];
+    softmax_scaled(vec, len, 1.0);
+}
+
+// ============================================================================
+// SIMD LOG-SOFTMAX
+// ============================================================================
+void simd_log_softmax_f64(double* vec, size_t len) {
+    if (!vec || len == 0) return;
+
+    double max_val, sum;
+    softmax_stats_chunked(active_kernels(), vec, len, 1.0, &max_val, &sum);
+
+    double log_norm = max_val + log(sum);
+    map_chunks(len, [=](size_t begin, size_t n) {
+        for (size_t i = begin; i < begin + n; i++) {
+            vec[i] -= log_norm;
+        }
+    });
+}
+
+// ============================================================================
+// SIMD TEMPERATURE SOFTMAX
+// ============================================================================
+// Index of the largest value; the first one wins ties
+static size_t argmax_f64(const double* vec, size_t len) {
+    size_t best = 0;
     for (size_t i = 1; i < len; i++) {
-        if (vec[i] > max_val) {
-            max_val = vec[i];
+        if (vec[i] > vec[best]) best = i;
+    }
+    return best;
+}
+
+// 1 / temperature, or 0 when sampling should be greedy
+static double inverse_temperature(double temperature) {
+    if (!(temperature > 0.0)) return 0.0;
+    double scale = 1.0 / temperature;
+    return isfinite(scale) ? scale : 0.0;
+}
+
+void simd_softmax_temperature_f64(double* vec, size_t len, double temperature) {
+    if (!vec || len == 0) return;
+
+    double scale = inverse_temperature(temperature);
+    if (scale == 0.0) {
+        size_t best = argmax_f64(vec, len);
+        memset(vec, 0, len * sizeof(double));
+        vec[best] = 1.0;
+        return;
+    }
+
+    softmax_scaled(vec, len, scale);
+}
+
+// ============================================================================
+// SIMD TOP-K / TOP-P SAMPLING
+// Weights are w[i] = exp(scale * (x[i] - max)), so sum(w) comes from
+// softmax_stats and no probability vector is ever written.
+// ============================================================================
+static const size_t SAMPLE_PROBE_K = 64;        // Candidates tried first for top-p only
+static const size_t SAMPLE_CHUNK = 256;         // Weights evaluated per exp kernel call
+static const int NUCLEUS_BUCKETS = 256;
+static const double NUCLEUS_BUCKET_WIDTH = 0.25;    // In scaled logits below the max
+
+// Heap order: "less" means a better candidate, so the heap top is the worst
+// kept logit. Higher logit wins; ties go to the lower index.
+struct SampleCandidate {
+    double logit;
+    size_t index;
+    bool operator<(const SampleCandidate& other) const {
+        return logit > other.logit || (logit == other.logit && index < other.index);
+    }
+};
+
+// The k largest logits, best first. NaN logits are never selected.
+static void select_top_k(const double* logits, size_t len, size_t k, std::vector<SampleCandidate>& out) {
+    out.clear();
+    out.reserve(k);
+    for (size_t i = 0; i < len; i++) {
+        double x = logits[i];
+        if (out.size() < k) {
+            if (x != x) continue;
+            SampleCandidate c = { x, i };
+            out.push_back(c);
+            std::push_heap(out.begin(), out.end());
+        } else if (x > out.front().logit) {
+            std::pop_heap(out.begin(), out.end());
+            out.back().logit = x;
+            out.back().index = i;
+            std::push_heap(out.begin(), out.end());
         }
     }
+    std::sort_heap(out.begin(), out.end());
+}
 
-    // Step 2: Compute exp(x - max) and sum
-    double sum = 0.0;
+// Calls visit(i, w[i]) for every element, evaluating the weights a chunk at
+// a time with the vector exp kernel; stops when visit returns false
+template <typename Visit>
+static void for_each_weight(const double* logits, size_t len, double scale, double max_val, Visit visit) {
+    double w[SAMPLE_CHUNK];
+    for (size_t base = 0; base < len; base += SAMPLE_CHUNK) {
+        size_t n = std::min(SAMPLE_CHUNK, len - base);
+        for (size_t j = 0; j < n; j++) {
+            double x = logits[base + j];
+            w[j] = (x == x) ? scale * (x - max_val) : -INFINITY;    // NaN weighs 0
+        }
+        active_kernels()->exp(w, w, n);
+        for (size_t j = 0; j < n; j++) {
+            if (!visit(base + j, w[j])) return;
+        }
+    }
+}
+
+// Picks from the best-first candidates: the smallest prefix whose weight
+// reaches top_p of their total, then the one covering uniform of that prefix
+static size_t sample_prefix(const std::vector<SampleCandidate>& candidates, double scale, double max_val,
+                            double top_p, double uniform) {
+    std::vector<double> w(candidates.size());
+    double total = 0.0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        w[i] = exp(scale * (candidates[i].logit - max_val));
+        total += w[i];
+    }
+    double target = std::min(top_p, 1.0) * total;
+    size_t keep = 0;
+    double kept = 0.0;
+    while (keep < candidates.size() && (keep == 0 || kept < target)) {
+        kept += w[keep++];
+    }
+
+    double point = uniform * kept;
+    double acc = 0.0;
+    for (size_t i = 0; i < keep; i++) {
+        acc += w[i];
+        if (point < acc) return candidates[i].index;
+    }
+    return candidates[keep - 1].index;
+}
+
+static int nucleus_bucket(double z) {
+    double b = z * (1.0 / NUCLEUS_BUCKET_WIDTH);
+    return (b < NUCLEUS_BUCKETS - 1) ? (int)b : NUCLEUS_BUCKETS - 1;
+}
+
+// Top-p over the whole vocabulary in O(n): a histogram of weight by distance
+// below the max finds the bucket where the nucleus ends. Buckets above it are
+// wholly inside, so only the boundary bucket is sorted.
+static size_t sample_nucleus(const double* logits, size_t len, double scale, double max_val,
+                             double top_p, double uniform) {
+    double mass[NUCLEUS_BUCKETS] = {0.0};
+    size_t count[NUCLEUS_BUCKETS] = {0};
+    double total = 0.0;
+    for_each_weight(logits, len, scale, max_val, [&](size_t i, double w) {
+        if (w > 0.0) {
+            int b = nucleus_bucket(scale * (max_val - logits[i]));
+            mass[b] += w;
+            count[b]++;
+            total += w;
+        }
+        return true;
+    });
+
+    double target = top_p * total;
+    double above = 0.0;
+    int boundary = 0;
+    while (boundary < NUCLEUS_BUCKETS - 1 && above + mass[boundary] < target) {
+        above += mass[boundary++];
+    }
+
+    std::vector<SampleCandidate> edge;
+    edge.reserve(count[boundary]);
     for (size_t i = 0; i < len; i++) {
-        vec[i] = exp(vec[i] - max_val);
-        sum += vec[i];
+        double x = logits[i];
+        if (x == x && nucleus_bucket(scale * (max_val - x)) == boundary) {
+            SampleCandidate c = { x, i };
+            edge.push_back(c);
+        }
     }
+    if (edge.empty()) return argmax_f64(logits, len);
+    std::sort(edge.begin(), edge.end());
 
-    // Step 3: Normalize
-    // BUG FIX: Check for division by zero
-    if (sum > 1e-10) {
-        for (size_t i = 0; i < len; i++) {
-            vec[i] /= sum;
+    size_t keep = 0;
+    double kept = above;
+    std::vector<double> edge_w(edge.size());
+    while (keep < edge.size() && (keep == 0 || kept < target)) {
+        edge_w[keep] = exp(scale * (edge[keep].logit - max_val));
+        kept += edge_w[keep++];
+    }
+
+    double point = uniform * kept;
+    if (point >= above) {
+        double acc = above;
+        for (size_t i = 0; i < keep; i++) {
+            acc += edge_w[i];
+            if (point < acc) return edge[i].index;
         }
+        return edge[keep - 1].index;
+    }
+
+    // Inside the buckets above the boundary: find the bucket, then the token
+    int b = 0;
+    while (b < boundary - 1 && point >= mass[b]) point -= mass[b++];
+    size_t chosen = edge[0].index;
+    double acc = 0.0;
+    for (size_t i = 0; i < len; i++) {
+        double x = logits[i];
+        if (x == x && nucleus_bucket(scale * (max_val - x)) == b) {
+            chosen = i;
+            acc += exp(scale * (x - max_val));
+            if (point < acc) break;
+        }
+    }
+    return chosen;
+}
+
+size_t simd_sample_f64(const double* logits, size_t len, size_t top_k, double top_p,
+                       double temperature, double uniform) {
+    if (!logits || len == 0) return 0;
+
+    double scale = inverse_temperature(temperature);
+    if (scale == 0.0) return argmax_f64(logits, len);
+
+    double max_val, sum;
+    active_kernels()->softmax_stats(logits, len, scale, &max_val, &sum);
+    if (!(sum > 0.0) || !isfinite(sum)) return argmax_f64(logits, len);
+
+    std::vector<SampleCandidate> candidates;
+    if (top_k > 0 && top_k < len) {
+        select_top_k(logits, len, top_k, candidates);
+        if (candidates.empty()) return argmax_f64(logits, len);
+        return sample_prefix(candidates, scale, max_val, top_p, uniform);
+    }
+
+    if (top_p >= 1.0) {
+        // Plain temperature sampling: one scan to the token covering the point
+        double point = uniform * sum;
+        double acc = 0.0;
+        size_t chosen = argmax_f64(logits, len);
+        for_each_weight(logits, len, scale, max_val, [&](size_t i, double w) {
+            acc += w;
+            if (point < acc) {
+                chosen = i;
+                return false;
+            }
+            return true;
+        });
+        return chosen;
     }
+
+    // Peaked distributions keep their nucleus within a few dozen tokens
+    select_top_k(logits, len, std::min(SAMPLE_PROBE_K, len), candidates);
+    if (candidates.empty()) return argmax_f64(logits, len);
+    double head = 0.0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        head += exp(scale * (candidates[i].logit - max_val));
+    }
+    if (head >= top_p * sum || candidates.size() == len) {
+        return sample_prefix(candidates, scale, max_val, top_p * sum / head, uniform);
+    }
+    return sample_nucleus(logits, len, scale, max_val, top_p, uniform);
 }
 
 // ============================================================================
@@ -74,9 +790,8 @@ void simd_softmax_f64(double* vec, size_t len) {
 void simd_relu_f64(double* dst, const double* src, size_t len) {
     if (!dst || !src) return;
 
-    for (size_t i = 0; i < len; i++) {
-        dst[i] = (src[i] > 0.0) ? src[i] : 0.0;
-    }
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->relu(dst + begin, src + begin, n); });
 }
 
 // ============================================================================
@@ -85,33 +800,262 @@ void simd_relu_f64(double* dst, const double* src, size_t len) {
 void simd_gelu_f64(double* dst, const double* src, size_t len) {
     if (!dst || !src) return;
 
-    // Approximation: GELU(x) â‰ˆ 0.5 * x * (1 + tanh(sqrt(2/Ï€) * (x + 0.044715 * x^3)))
-    const double sqrt_2_pi = 0.7978845608028654;  // sqrt(2/Ï€)
-    const double coeff = 0.044715;
+    // Approximation: GELU(x) = 0.5 * x * (1 + tanh(sqrt(2/pi) * (x + 0.044715 * x^3)))
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->gelu(dst + begin, src + begin, n); });
+}
 
-    for (size_t i = 0; i < len; i++) {
-        double x = src[i];
-        double x3 = x * x * x;
-        double tanh_arg = sqrt_2_pi * (x + coeff * x3);
-        double tanh_val;
-        if (tanh_arg > 100.0) {
-            tanh_val = 1.0;
-        } else if (tanh_arg < -100.0) {
-            tanh_val = -1.0;
+// ============================================================================
+// SIMD TANH ACTIVATION
+// ============================================================================
+void simd_tanh_f64(double* dst, const double* src, size_t len) {
+    if (!dst || !src) return;
+
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->tanh(dst + begin, src + begin, n); });
+}
+
+// ============================================================================
+// SIMD EXPONENTIAL
+// ============================================================================
+void simd_exp_f64(double* dst, const double* src, size_t len) {
+    if (!dst || !src) return;
+
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t n) { kern->exp(dst + begin, src + begin, n); });
+}
+
+// ============================================================================
+// SIMD FUSED ELEMENTWISE
+// ============================================================================
+static const size_t FUSED_TILE = 1024;    // 8 KB of dst plus one operand tile in L1
+
+void simd_fused_f64(double* dst, const double* src, size_t len, const SimdFusedOp* ops, size_t num_ops) {
+    if (!dst || !src || (num_ops > 0 && !ops)) return;
+    for (size_t k = 0; k < num_ops; k++) {
+        if (ops[k].code > SIMD_OP_EXP) return;
+        if ((ops[k].code == SIMD_OP_ADD || ops[k].code == SIMD_OP_MUL) && !ops[k].operand) return;
+    }
+    if (num_ops == 0) {
+        if (dst != src) memmove(dst, src, len * sizeof(double));
+        return;
+    }
+
+    // One kernel table for the whole call, even if the level changes meanwhile
+    const VectorKernels* kern = active_kernels();
+    map_chunks(len, [=](size_t begin, size_t count) {
+        for (size_t base = begin; base < begin + count; base += FUSED_TILE) {
+            size_t n = std::min(FUSED_TILE, begin + count - base);
+            double* d = dst + base;
+            const double* x = src + base;     // First op reads src, the rest dst
+            for (size_t k = 0; k < num_ops; k++, x = d) {
+                const SimdFusedOp& op = ops[k];
+                switch (op.code) {
+                    case SIMD_OP_ADD:    kern->add(d, x, op.operand + base, n); break;
+                    case SIMD_OP_MUL:    kern->mul(d, x, op.operand + base, n); break;
+                    case SIMD_OP_AFFINE: kern->affine(d, x, op.scale, op.shift, n); break;
+                    case SIMD_OP_RELU:   kern->relu(d, x, n); break;
+                    case SIMD_OP_GELU:   kern->gelu(d, x, n); break;
+                    case SIMD_OP_TANH:   kern->tanh(d, x, n); break;
+                    case SIMD_OP_EXP:    kern->exp(d, x, n); break;
+                }
+            }
+        }
+    });
+}
+
+// ============================================================================
+// REDUCED PRECISION: F32
+// ============================================================================
+void simd_add_f32(float* dst, const float* src1, const float* src2, size_t len) {
+    if (!dst || !src1 || !src2) return;
+
+    active_kernels()->add_f32(dst, src1, src2, len);
+}
+
+void simd_mul_f32(float* dst, const float* src1, const float* src2, size_t len) {
+    if (!dst || !src1 || !src2) return;
+
+    active_kernels()->mul_f32(dst, src1, src2, len);
+}
+
+float simd_dot_f32(const float* src1, const float* src2, size_t len) {
+    if (!src1 || !src2) return 0.0f;
+
+    return active_kernels()->dot_f32(src1, src2, len);
+}
+
+void simd_relu_f32(float* dst, const float* src, size_t len) {
+    if (!dst || !src) return;
+
+    active_kernels()->relu_f32(dst, src, len);
+}
+
+// Transcendentals and softmax run the f64 kernels on L1-sized widened
+// chunks, so there is a single rounding per result and no f32 polynomial
+static const size_t WIDEN_CHUNK = 256;
+
+static inline double widen(float v) { return v; }
+static inline double widen(bf16 v) { return bf16_to_f32(v); }
+static inline void narrow(float* dst, double v) { *dst = (float)v; }
+static inline void narrow(bf16* dst, double v) { *dst = f32_to_bf16((float)v); }
+
+template <typename T>
+static void unary_widened(T* dst, const T* src, size_t len, void (*kernel)(double*, const double*, size_t)) {
+    double buf[WIDEN_CHUNK];
+    for (size_t base = 0; base < len; base += WIDEN_CHUNK) {
+        size_t n = std::min(WIDEN_CHUNK, len - base);
+        for (size_t i = 0; i < n; i++) buf[i] = widen(src[base + i]);
+        kernel(buf, buf, n);
+        for (size_t i = 0; i < n; i++) narrow(dst + base + i, buf[i]);
+    }
+}
+
+// Pass 1 merges per-chunk (max, sum) statistics online; pass 2 writes
+// exp(x - max) / sum. Each element's exp is evaluated twice, which costs
+// less than keeping an f64 copy of the whole vector.
+template <typename T>
+static void softmax_widened(T* vec, size_t len) {
+    const VectorKernels* kern = active_kernels();
+    double buf[WIDEN_CHUNK];
+    double max_val = -DBL_MAX;
+    double sum = 0.0;
+    for (size_t base = 0; base < len; base += WIDEN_CHUNK) {
+        size_t n = std::min(WIDEN_CHUNK, len - base);
+        for (size_t i = 0; i < n; i++) buf[i] = widen(vec[base + i]);
+        double m, s;
+        kern->softmax_stats(buf, n, 1.0, &m, &s);
+        if (m > max_val) {
+            sum = sum * exp(max_val - m) + s;
+            max_val = m;
         } else {
-            tanh_val = tanh(tanh_arg);
+            sum += s * exp(m - max_val);
         }
-        dst[i] = 0.5 * x * (1.0 + tanh_val);
     }
+    if (!(sum > 1e-10)) return;
+
+    double inv_sum = 1.0 / sum;
+    for (size_t base = 0; base < len; base += WIDEN_CHUNK) {
+        size_t n = std::min(WIDEN_CHUNK, len - base);
+        for (size_t i = 0; i < n; i++) buf[i] = widen(vec[base + i]) - max_val;
+        kern->exp(buf, buf, n);
+        for (size_t i = 0; i < n; i++) narrow(vec + base + i, buf[i] * inv_sum);
+    }
+}
+
+void simd_gelu_f32(float* dst, const float* src, size_t len) {
+    if (!dst || !src) return;
+
+    unary_widened(dst, src, len, active_kernels()->gelu);
+}
+
+void simd_tanh_f32(float* dst, const float* src, size_t len) {
+    if (!dst || !src) return;
+
+    unary_widened(dst, src, len, active_kernels()->tanh);
+}
+
+void simd_exp_f32(float* dst, const float* src, size_t len) {
+    if (!dst || !src) return;
+
+    unary_widened(dst, src, len, active_kernels()->exp);
+}
+
+void simd_softmax_f32(float* vec, size_t len) {
+    if (!vec || len == 0) return;
+
+    softmax_widened(vec, len);
 }
 
 // ============================================================================
-// SIMD TANH ACTIVATION
+// REDUCED PRECISION: BF16
+// Elementwise ops are plain loops the compiler vectorizes; they are bound
+// by memory traffic, which bf16 halves relative to f32.
 // ============================================================================
-void simd_tanh_f64(double* dst, const double* src, size_t len) {
+void simd_f32_to_bf16(bf16* dst, const float* src, size_t len) {
     if (!dst || !src) return;
 
-    for (size_t i = 0; i < len; i++) {
-        dst[i] = tanh(src[i]);
+    for (size_t i = 0; i < len; i++) dst[i] = f32_to_bf16(src[i]);
+}
+
+void simd_bf16_to_f32(float* dst, const bf16* src, size_t len) {
+    if (!dst || !src) return;
+
+    for (size_t i = 0; i < len; i++) dst[i] = bf16_to_f32(src[i]);
+}
+
+void simd_add_bf16(bf16* dst, const bf16* src1, const bf16* src2, size_t len) {
+    if (!dst || !src1 || !src2) return;
+
+    for (size_t i = 0; i < len; i++) dst[i] = f32_to_bf16(bf16_to_f32(src1[i]) + bf16_to_f32(src2[i]));
+}
+
+void simd_mul_bf16(bf16* dst, const bf16* src1, const bf16* src2, size_t len) {
+    if (!dst || !src1 || !src2) return;
+
+    for (size_t i = 0; i < len; i++) dst[i] = f32_to_bf16(bf16_to_f32(src1[i]) * bf16_to_f32(src2[i]));
+}
+
+float simd_dot_bf16(const bf16* src1, const bf16* src2, size_t len) {
+    if (!src1 || !src2) return 0.0f;
+
+    return active_kernels()->dot_bf16(src1, src2, len);
+}
+
+// NaN and -0 map to +0, like relu_scalar
+void simd_relu_bf16(bf16* dst, const bf16* src, size_t len) {
+    if (!dst || !src) return;
+
+    for (size_t i = 0; i < len; i++) dst[i] = (bf16_to_f32(src[i]) > 0.0f) ? src[i] : 0;
+}
+
+void simd_gelu_bf16(bf16* dst, const bf16* src, size_t len) {
+    if (!dst || !src) return;
+
+    unary_widened(dst, src, len, active_kernels()->gelu);
+}
+
+void simd_tanh_bf16(bf16* dst, const bf16* src, size_t len) {
+    if (!dst || !src) return;
+
+    unary_widened(dst, src, len, active_kernels()->tanh);
+}
+
+void simd_softmax_bf16(bf16* vec, size_t len) {
+    if (!vec || len == 0) return;
+
+    softmax_widened(vec, len);
+}
+
+// ============================================================================
+// REDUCED PRECISION: INT8
+// ============================================================================
+void simd_quantize_i8(int8_t* dst, float* scales, const float* src, size_t rows, size_t cols) {
+    if (!dst || !scales || !src) return;
+
+    for (size_t r = 0; r < rows; r++) {
+        const float* row = src + r * cols;
+        float max_abs = 0.0f;
+        for (size_t c = 0; c < cols; c++) max_abs = std::max(max_abs, fabsf(row[c]));
+        scales[r] = max_abs / 127.0f;
+        float inv = (max_abs > 0.0f) ? 127.0f / max_abs : 0.0f;
+        for (size_t c = 0; c < cols; c++) {
+            float q = nearbyintf(row[c] * inv);
+            dst[r * cols + c] = (int8_t)std::max(-127.0f, std::min(127.0f, q));
+        }
     }
-}
\ No newline at end of file
+}
+
+void simd_dequantize_i8(float* dst, const int8_t* src, const float* scales, size_t rows, size_t cols) {
+    if (!dst || !src || !scales) return;
+
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < cols; c++) dst[r * cols + c] = (float)src[r * cols + c] * scales[r];
+    }
+}
+
+int32_t simd_dot_i8(const int8_t* src1, const int8_t* src2, size_t len) {
+    if (!src1 || !src2) return 0;
+
+    return active_kernels()->dot_i8(src1, src2, len);
+}
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "common.h"
 
 // ============================================================================
@@ -20,11 +21,39 @@ void simd_mul_f64(double* dst, const double* src1, const double* src2, size_t le
 // ============================================================================
 double simd_dot_f64(const double* src1, const double* src2, size_t len);
 
+// Dot product in the order of a 16-lane (1024-bit) vector unit: lane l
+// accumulates elements l, l + 16, ... by fused multiply-add, then lanes are
+// folded pairwise (l + 8, l + 4, l + 2, l + 1). Bit-identical at every SIMD
+// level, so host results match the device's.
+double simd_dot_lanes16_f64(const double* src1, const double* src2, size_t len);
+
 // ============================================================================
 // SIMD SOFTMAX (Numerically stable)
+// Online: one pass writes exp(x - running max) and accumulates the rescaled
+// sum, a second multiplies in the normalizer and max correction. No exp is
+// evaluated twice and no separate max pass is needed.
 // ============================================================================
 void simd_softmax_f64(double* vec, size_t len);
 
+// vec[i] = x[i] - max - log(sum(exp(x - max)))
+void simd_log_softmax_f64(double* vec, size_t len);
+
+// softmax(x / temperature); temperature <= 0 gives a one-hot vector at the
+// first maximum (greedy decoding)
+void simd_softmax_temperature_f64(double* vec, size_t len, double temperature);
+
+// ============================================================================
+// SIMD SAMPLING
+// Draws a token from softmax(logits / temperature) restricted to the top_k
+// largest logits (0 = no limit) and then to the smallest prefix of those
+// holding top_p of their probability mass (>= 1 = no limit). uniform is the
+// caller's random number in [0, 1). Only the candidates are materialized:
+// with top-p alone the candidate count grows from 64 until it covers top_p.
+// temperature <= 0 returns the first argmax.
+// ============================================================================
+size_t simd_sample_f64(const double* logits, size_t len, size_t top_k, double top_p,
+                       double temperature, double uniform);
+
 // ============================================================================
 // SIMD ACTIVATION FUNCTIONS
 // ============================================================================
@@ -32,4 +61,172 @@ void simd_relu_f64(double* dst, const double* src, size_t len);
 void simd_gelu_f64(double* dst, const double* src, size_t len);
 void simd_tanh_f64(double* dst, const double* src, size_t len);
 
+// ============================================================================
+// SIMD EXPONENTIAL
+// ============================================================================
+void simd_exp_f64(double* dst, const double* src, size_t len);
+
+// Error bounds of the vectorized exp and tanh (AVX2/AVX-512 levels) against
+// libm over the whole double range, in units in the last place. The worst
+// cases seen in 4M-point sweeps were 1 ULP (exp, subnormal results) and
+// 3 ULP (tanh, near |x| = 0.4). GELU and softmax are built on these; the
+// scalar level calls libm.
+#define SIMD_EXP_MAX_ULP  2
+#define SIMD_TANH_MAX_ULP 4
+
+// ============================================================================
+// SIMD FUSED ELEMENTWISE
+// Evaluates a chain of elementwise ops in one pass over memory:
+//   dst = op[n-1](... op[1](op[0](src)) ...)
+// The chain runs tile by tile, each tile of dst staying in L1 from the
+// first op to the last, so no full-length temporaries are written. Results
+// are bit-identical to the same sequence of simd_* calls. dst may alias
+// src but not an operand of a later op. E.g. gelu(a * b + c):
+//   SimdFusedOp ops[] = { {SIMD_OP_MUL, b, 0, 0}, {SIMD_OP_ADD, c, 0, 0},
+//                         {SIMD_OP_GELU, NULL, 0, 0} };
+//   simd_fused_f64(dst, a, len, ops, 3);
+// ============================================================================
+enum SimdOpCode {
+    SIMD_OP_ADD,        // x + operand[i]
+    SIMD_OP_MUL,        // x * operand[i]
+    SIMD_OP_AFFINE,     // fma(x, scale, shift)
+    SIMD_OP_RELU,
+    SIMD_OP_GELU,
+    SIMD_OP_TANH,
+    SIMD_OP_EXP
+};
+
+typedef struct {
+    SimdOpCode code;
+    const double* operand;  // len elements, for ADD and MUL
+    double scale;           // For AFFINE
+    double shift;
+} SimdFusedOp;
+
+void simd_fused_f64(double* dst, const double* src, size_t len, const SimdFusedOp* ops, size_t num_ops);
+
+// ============================================================================
+// NO-ALIAS, IN-PLACE AND UNCHECKED VARIANTS
+// The checked calls above accept dst equal to a source, test every pointer
+// for NULL and consult the parallel mode. For callers issuing many short
+// calls (per row, per head) the variants below drop what they do not need.
+// Results are bit-identical to the checked calls.
+// ============================================================================
+// No-alias contract: dst overlaps neither source, all pointers are valid.
+// No checks, never split across the parallel pool. The scalar level gets
+// loops without a runtime overlap test; the AVX2/AVX-512 kernels are the
+// same as the checked calls'.
+void simd_add_f64_restrict(double* __restrict dst, const double* __restrict src1,
+                           const double* __restrict src2, size_t len);
+void simd_mul_f64_restrict(double* __restrict dst, const double* __restrict src1,
+                           const double* __restrict src2, size_t len);
+
+// dst[i] += src[i] and dst[i] *= src[i]. src may equal dst but must not
+// partially overlap it. Checked and parallel like simd_add_f64.
+void simd_add_inplace_f64(double* dst, const double* src, size_t len);
+void simd_mul_inplace_f64(double* dst, const double* src, size_t len);
+
+// Same aliasing rules as the checked calls, but no NULL checks and never
+// split across the parallel pool: one kernel-table load and the kernel.
+void simd_add_f64_unchecked(double* dst, const double* src1, const double* src2, size_t len);
+void simd_mul_f64_unchecked(double* dst, const double* src1, const double* src2, size_t len);
+double simd_dot_f64_unchecked(const double* src1, const double* src2, size_t len);
+
+// ============================================================================
+// REDUCED PRECISION (f32, bf16, int8)
+// Dispatched with the f64 kernels above. f32 and bf16 accumulate in f32.
+// exp, tanh, GELU and softmax widen to f64, run the f64 kernels and round
+// once on the way out, so an f32 result is within 1 ULP of the correctly
+// rounded value. bf16 is storage only: the upper half of an f32, computed
+// in f32 and rounded to nearest even on store.
+// ============================================================================
+typedef uint16_t bf16;
+
+static inline float bf16_to_f32(bf16 v) {
+    uint32_t bits = (uint32_t)v << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static inline bf16 f32_to_bf16(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u) return (bf16)((bits >> 16) | 0x0040u);   // Quiet NaN
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return (bf16)(bits >> 16);
+}
+
+void simd_add_f32(float* dst, const float* src1, const float* src2, size_t len);
+void simd_mul_f32(float* dst, const float* src1, const float* src2, size_t len);
+float simd_dot_f32(const float* src1, const float* src2, size_t len);
+void simd_relu_f32(float* dst, const float* src, size_t len);
+void simd_gelu_f32(float* dst, const float* src, size_t len);
+void simd_tanh_f32(float* dst, const float* src, size_t len);
+void simd_exp_f32(float* dst, const float* src, size_t len);
+void simd_softmax_f32(float* vec, size_t len);
+
+void simd_f32_to_bf16(bf16* dst, const float* src, size_t len);
+void simd_bf16_to_f32(float* dst, const bf16* src, size_t len);
+void simd_add_bf16(bf16* dst, const bf16* src1, const bf16* src2, size_t len);
+void simd_mul_bf16(bf16* dst, const bf16* src1, const bf16* src2, size_t len);
+float simd_dot_bf16(const bf16* src1, const bf16* src2, size_t len);
+void simd_relu_bf16(bf16* dst, const bf16* src, size_t len);
+void simd_gelu_bf16(bf16* dst, const bf16* src, size_t len);
+void simd_tanh_bf16(bf16* dst, const bf16* src, size_t len);
+void simd_softmax_bf16(bf16* vec, size_t len);
+
+// int8: symmetric per-row (per-channel) quantization, q = round(x / scale)
+// with scale = max|row| / 127; an all-zero row gets scale 0. Elementwise
+// work on int8 tensors goes through simd_dequantize_i8 and the f32 kernels.
+void simd_quantize_i8(int8_t* dst, float* scales, const float* src, size_t rows, size_t cols);
+void simd_dequantize_i8(float* dst, const int8_t* src, const float* scales, size_t rows, size_t cols);
+
+// Exact int32 sum of products. Cannot overflow for len <= SIMD_DOT_I8_MAX_LEN
+// with values in [-127, 127], as simd_quantize_i8 produces.
+#define SIMD_DOT_I8_MAX_LEN 131072
+int32_t simd_dot_i8(const int8_t* src1, const int8_t* src2, size_t len);
+
+// ============================================================================
+// SIMD DISPATCH
+// Kernels are picked once from CPUID: AVX-512F, else AVX2+FMA, else the
+// portable scalar code. Reductions accumulate in a different order at each
+// level, so their results can differ in the last bits between levels.
+// ============================================================================
+enum SimdLevel {
+    SIMD_LEVEL_SCALAR = 0,
+    SIMD_LEVEL_AVX2   = 1,
+    SIMD_LEVEL_AVX512 = 2
+};
+
+// Best level this CPU (and build) supports
+SimdLevel simd_detect_level();
+
+// Level currently in use
+SimdLevel simd_get_level();
+
+// Force a level, clamped to what is supported; returns the level now in
+// use. For tests and benchmarks comparing code paths.
+SimdLevel simd_set_level(SimdLevel level);
+
+const char* simd_level_name(SimdLevel level);
+
+// ============================================================================
+// SIMD PARALLEL MODE (opt-in)
+// add/mul/dot, the activations, exp, simd_fused_f64 and the softmax variants
+// split inputs of at least min_len elements into SIMD_PARALLEL_CHUNK-element
+// chunks run on a shared pool of threads (the caller is one of them). Reductions
+// combine per-chunk partials in chunk order, so a result depends only on
+// the length and SIMD level, never on the thread count or scheduling; it
+// can differ in the last bits from the serial result. Elementwise maps
+// are bit-identical either way. threads == 1 (default) turns the mode off,
+// 0 uses the hardware concurrency; min_len == 0 selects the default
+// SIMD_PARALLEL_MIN_LEN. bench_vector reports the measured crossover.
+// ============================================================================
+#define SIMD_PARALLEL_CHUNK   8192
+#define SIMD_PARALLEL_MIN_LEN 32768
+
+void simd_set_parallel(size_t threads, size_t min_len);
+size_t simd_get_parallel_threads();
+
 #endif // AGNI_VECTOR_UTILS_H
\ No newline at end of file